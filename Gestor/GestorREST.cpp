@@ -1,3 +1,5 @@
+#include "ClientKeys.h"
+#include "EngineRouter.h"
 #include "ProblemRepository.h"
 
 #include <crow.h>
@@ -6,16 +8,42 @@
 #include <mongocxx/uri.hpp>
 
 #include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
 #include <optional>
 #include <random>
+#include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <cpr/cpr.h>
+#include <nlohmann/json.hpp>
 
 
 // =================== Helpers JSON ===================
 
+// Checkers que entiende el motor.
+static bool is_known_checker_type(const std::string& type) {
+    return type == "exact" || type == "tokens" || type == "float" ||
+           type == "unordered_lines" || type == "custom";
+}
+
+// Convierte un Checker al JSON que usan la UI y el motor.
+static crow::json::wvalue checker_to_json(const Checker& c) {
+    crow::json::wvalue json;
+    json["type"] = c.type;
+    if (c.type == "float") {
+        json["abs_epsilon"] = c.abs_epsilon;
+        json["rel_epsilon"] = c.rel_epsilon;
+    }
+    if (c.type == "custom") {
+        json["source"] = c.source;
+    }
+    return json;
+}
+
 // Convierte un Problem a JSON (Crow). Si summary = true, omite description, code_stub y test_cases.
 static crow::json::wvalue problem_to_json(const Problem& p, bool summary = false) {
     crow::json::wvalue json;
@@ -32,6 +60,7 @@ static crow::json::wvalue problem_to_json(const Problem& p, bool summary = false
     if (!summary) {
         json["description"] = p.description;
         json["code_stub"]   = p.code_stub;
+        json["checker"]     = checker_to_json(p.checker);
 
         // test_cases completos
         for (std::size_t i = 0; i < p.test_cases.size(); ++i) {
@@ -120,6 +149,48 @@ static std::optional<Problem> json_to_problem(const crow::json::rvalue& body,
         p.test_cases.push_back(std::move(tc));
     }
 
+    // checker (opcional, objeto { type, abs_epsilon, rel_epsilon, source })
+    if (body.has("checker")) {
+        const auto& ck_json = body["checker"];
+        if (ck_json.t() != type::Object ||
+            !ck_json.has("type") || ck_json["type"].t() != type::String) {
+            error_out = "El campo 'checker' debe ser un objeto con 'type' string";
+            return std::nullopt;
+        }
+        p.checker.type = std::string(ck_json["type"].s());
+        if (!is_known_checker_type(p.checker.type)) {
+            error_out = "Tipo de checker desconocido: " + p.checker.type;
+            return std::nullopt;
+        }
+
+        // Tolerancias del checker "float" (opcionales)
+        auto get_epsilon = [&](const char* name, double& dst) -> bool {
+            if (!ck_json.has(name)) {
+                return true;
+            }
+            if (ck_json[name].t() != type::Number || ck_json[name].d() < 0) {
+                error_out = std::string("'checker.") + name + "' debe ser un número no negativo";
+                return false;
+            }
+            dst = ck_json[name].d();
+            return true;
+        };
+        if (!get_epsilon("abs_epsilon", p.checker.abs_epsilon)) return std::nullopt;
+        if (!get_epsilon("rel_epsilon", p.checker.rel_epsilon)) return std::nullopt;
+
+        if (ck_json.has("source")) {
+            if (ck_json["source"].t() != type::String) {
+                error_out = "'checker.source' debe ser string";
+                return std::nullopt;
+            }
+            p.checker.source = std::string(ck_json["source"].s());
+        }
+        if (p.checker.type == "custom" && p.checker.source.empty()) {
+            error_out = "El checker 'custom' necesita 'source'";
+            return std::nullopt;
+        }
+    }
+
     return p;
 }
 
@@ -139,6 +210,157 @@ static crow::response make_error_response(int status, const std::string& message
     return make_json_response(status, body);
 }
 
+// Id único por submission: <prefijo>-<ms desde epoch>-<aleatorio>.
+// Dos submissions simultáneas al mismo problema nunca comparten id.
+static std::string make_submission_id(const std::string& prefix) {
+    static thread_local std::mt19937_64 gen{std::random_device{}()};
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    std::ostringstream oss;
+    oss << prefix << "-" << ms << "-" << std::hex << (gen() & 0xffffffffULL);
+    return oss.str();
+}
+
+// =================== Requests al motor ===================
+
+// Body de un request al motor. Con CODECOACH_ENGINE_WIRE=msgpack va en
+// MessagePack (application/msgpack): los mismos campos, pero los inputs y
+// expected viajan con prefijo de longitud, sin escapar ni desescapar. El
+// motor lo reconoce por el Content-Type; las respuestas siguen en JSON
+// porque se reenvían tal cual a la UI.
+struct EngineBody {
+    std::string content_type;
+    std::string data;
+};
+
+static EngineBody encode_for_engine(const nlohmann::json& body) {
+    static const bool msgpack = [] {
+        const char* wire = std::getenv("CODECOACH_ENGINE_WIRE");
+        return wire && std::string(wire) == "msgpack";
+    }();
+
+    EngineBody out;
+    if (msgpack) {
+        out.content_type = "application/msgpack";
+        nlohmann::json::to_msgpack(body, out.data);
+    } else {
+        out.content_type = "application/json";
+        out.data = body.dump();
+    }
+    return out;
+}
+
+// El checker en el request al motor (mismos campos que checker_to_json).
+static nlohmann::json checker_to_engine_json(const Checker& c) {
+    nlohmann::json json;
+    json["type"] = c.type;
+    if (c.type == "float") {
+        json["abs_epsilon"] = c.abs_epsilon;
+        json["rel_epsilon"] = c.rel_epsilon;
+    }
+    if (c.type == "custom") {
+        json["source"] = c.source;
+    }
+    return json;
+}
+
+// test_cases en el request al motor: id ("1", "2"...), input, expected_output.
+static nlohmann::json test_cases_to_engine_json(const std::vector<TestCase>& test_cases) {
+    nlohmann::json list = nlohmann::json::array();
+    for (std::size_t i = 0; i < test_cases.size(); ++i) {
+        list.push_back({
+            {"id", std::to_string(i + 1)},
+            {"input", test_cases[i].input},
+            {"expected_output", test_cases[i].expected_output},
+        });
+    }
+    return list;
+}
+
+// =================== Cache de tests en el motor ===================
+
+// Lo que el Gestor recuerda de un problema ya subido al motor: la clave
+// del set de tests y el checker (así una submission no necesita leer Mongo).
+struct EngineProblemData {
+    std::string test_data_key;
+    Checker checker;
+};
+
+// problem_id → datos del set que el motor ya tiene guardado.
+// Se invalida al actualizar o borrar el problema; si el motor lo perdió
+// (reinicio, expulsión) responde 409 y se vuelve a subir.
+class TestDataKeys {
+public:
+    std::optional<EngineProblemData> get(const std::string& problem_id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = keys_.find(problem_id);
+        if (it == keys_.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+    void set(const std::string& problem_id, EngineProblemData data) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        keys_[problem_id] = std::move(data);
+    }
+    void erase(const std::string& problem_id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        keys_.erase(problem_id);
+    }
+private:
+    std::mutex mutex_;
+    std::unordered_map<std::string, EngineProblemData> keys_;
+};
+
+// Sube los tests del problema a un motor (PUT <engine_url>/testdata/<id>).
+// Devuelve la clave del set, o "" si el motor no la aceptó. La clave
+// depende solo del contenido: es la misma en todos los motores.
+static std::string upload_test_data(const Problem& p, const std::string& engine_url) {
+    nlohmann::json body;
+    body["test_cases"] = test_cases_to_engine_json(p.test_cases);
+    EngineBody encoded = encode_for_engine(body);
+
+    cpr::Response resp = cpr::Put(
+        cpr::Url{engine_url + "/testdata/" + p.problem_id},
+        cpr::Header{{"Content-Type", encoded.content_type}},
+        cpr::Body{std::move(encoded.data)}
+    );
+    if (resp.error || resp.status_code != 200) {
+        return {};
+    }
+
+    auto res_json = crow::json::load(resp.text);
+    if (!res_json || !res_json.has("test_data_key")) {
+        return {};
+    }
+    return std::string(res_json["test_data_key"].s());
+}
+
+// =================== Sesiones de /run ===================
+
+// Las sesiones de /run viven en el motor que las creó. El session_id que ve
+// la UI lleva ese motor delante ("<índice>.<id del motor>") para volver a
+// él; si el motor fue expulsado, otro crea una sesión nueva.
+static std::string to_ui_session_id(std::size_t engine, const std::string& engine_session_id) {
+    return std::to_string(engine) + "." + engine_session_id;
+}
+
+// Inversa de to_ui_session_id. std::nullopt si no tiene el formato.
+static std::optional<std::pair<std::size_t, std::string>>
+from_ui_session_id(const std::string& ui_session_id) {
+    auto dot = ui_session_id.find('.');
+    if (dot == std::string::npos || dot == 0 || dot + 1 == ui_session_id.size()) {
+        return std::nullopt;
+    }
+    try {
+        std::size_t engine = std::stoul(ui_session_id.substr(0, dot));
+        return std::make_pair(engine, ui_session_id.substr(dot + 1));
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
 // =================== main ===================
 
 int main() {
@@ -153,8 +375,26 @@ int main() {
         // 3. Crear el repositorio de problemas
         ProblemRepository repo{db};
 
-        // 4. Inicializar la app Crow
-        crow::SimpleApp app;
+        // Sets de tests ya subidos al motor
+        TestDataKeys test_data_keys;
+
+        // Motores de evaluación (CODECOACH_ENGINES, separados por coma):
+        // menos requests en curso, health checks y un reintento en otro motor
+        EngineRouter engines{EngineRouter::urls_from_env("CODECOACH_ENGINES",
+                                                         "http://localhost:8090")};
+        std::cout << "[GestorREST] Motores de evaluación: " << engines.size() << std::endl;
+
+        // 4. Inicializar la app Crow. ClientKeys da a cada request su clave
+        //    de reparto en la cola del motor (ver ClientKeys.h):
+        //      CODECOACH_CLIENT_IDS_PER_MIN   ids nuevos por IP y minuto
+        crow::App<ClientKeys> app;
+        {
+            ClientKeysConfig client_keys;
+            if (const char* v = std::getenv("CODECOACH_CLIENT_IDS_PER_MIN"); v && *v) {
+                client_keys.new_ids_per_ip_per_min = std::max(0, std::atoi(v));
+            }
+            app.get_middleware<ClientKeys>().configure(client_keys);
+        }
 
         // --------- Endpoint de salud ---------
         CROW_ROUTE(app, "/health")
@@ -272,7 +512,7 @@ int main() {
 
         // --------- PUT /problems/<id> (actualizar) ---------
         CROW_ROUTE(app, "/problems/<string>").methods(crow::HTTPMethod::Put)
-        ([&repo](const crow::request& req, const std::string& problem_id) {
+        ([&repo, &test_data_keys](const crow::request& req, const std::string& problem_id) {
             auto body_json = crow::json::load(req.body);
             if (!body_json) {
                 return make_error_response(400, "JSON malformado");
@@ -288,8 +528,9 @@ int main() {
             Problem p = *maybe_problem;
             p.problem_id = problem_id; // clave lógica desde la URL
 
-            // Intentamos actualizar
+            // Intentamos actualizar (los tests pueden haber cambiado)
             bool updated = repo.update_problem(p);
+            test_data_keys.erase(problem_id);
             if (!updated) {
                 return make_error_response(404, "No se encontró un problema con ese problem_id para actualizar");
             }
@@ -302,7 +543,8 @@ int main() {
 
         // --------- DELETE /problems/<id> (eliminar) ---------
         CROW_ROUTE(app, "/problems/<string>").methods(crow::HTTPMethod::Delete)
-        ([&repo](const crow::request&, const std::string& problem_id) {
+        ([&repo, &test_data_keys](const crow::request&, const std::string& problem_id) {
+            test_data_keys.erase(problem_id);
             bool deleted = repo.delete_problem(problem_id);
             if (!deleted) {
                 return make_error_response(404, "No se encontró un problema con ese problem_id para eliminar");
@@ -316,7 +558,7 @@ int main() {
 
                 // --------- POST /submissions (evaluar código de un problema) ---------
         CROW_ROUTE(app, "/submissions").methods(crow::HTTPMethod::Post)
-        ([&repo](const crow::request& req) {
+        ([&repo, &test_data_keys, &engines, &app](const crow::request& req) {
             // 1. Parsear JSON de la UI
             auto body_json = crow::json::load(req.body);
             if (!body_json) {
@@ -345,47 +587,122 @@ int main() {
                 time_limit_ms = static_cast<int>(body_json["time_limit_ms"].i());
             }
 
-            // 2. Buscar el problema en Mongo
-            auto maybe_problem = repo.get_by_id(problem_id);
-            if (!maybe_problem) {
-                return make_error_response(404, "Problema no encontrado");
+            // Opcional: "run_all" | "stop_on_failure" | "stop_on_timeout"
+            std::string failure_policy;
+            if (body_json.has("failure_policy") && body_json["failure_policy"].t() == type::String) {
+                failure_policy = std::string(body_json["failure_policy"].s());
             }
-            Problem p = *maybe_problem;
 
-            if (p.test_cases.empty()) {
-                return make_error_response(400, "El problema no tiene casos de prueba configurados");
+            // Opcional: "rejudge": true evalúa de nuevo aunque el motor tenga
+            // guardado el veredicto de una submission idéntica
+            bool rejudge = body_json.has("rejudge") && body_json["rejudge"].t() == type::True;
+
+            // 2. Tests del problema: si los motores ya tienen el set guardado
+            //    solo se manda su clave; si no, se lee el problema de Mongo y
+            //    se sube al motor elegido.
+            std::optional<Problem> problem;
+            std::string test_data_key;
+            Checker checker;
+            if (auto known = test_data_keys.get(problem_id)) {
+                test_data_key = known->test_data_key;
+                checker       = known->checker;
             }
 
-            // 3. Construir el JSON para el motor de evaluación
-            crow::json::wvalue eval_json;
+            auto load_problem = [&]() -> std::optional<crow::response> {
+                if (!problem) {
+                    problem = repo.get_by_id(problem_id);
+                }
+                if (!problem) {
+                    return make_error_response(404, "Problema no encontrado");
+                }
+                if (problem->test_cases.empty()) {
+                    return make_error_response(400, "El problema no tiene casos de prueba configurados");
+                }
+                checker = problem->checker;
+                return std::nullopt;
+            };
+
+            // Si la subida falla se mandan los tests completos
+            auto upload_to = [&](const std::string& engine_url) {
+                test_data_key = upload_test_data(*problem, engine_url);
+                if (!test_data_key.empty()) {
+                    test_data_keys.set(problem_id, {test_data_key, checker});
+                }
+            };
 
-            // Generar un "submission_id" simple (puedes mejorarlo luego)
-            eval_json["submission_id"] = "sub-" + problem_id;
+            if (test_data_key.empty()) {
+                if (auto error = load_problem()) {
+                    return std::move(*error);
+                }
+            }
 
-            eval_json["problem_id"]    = problem_id;
-            eval_json["language"]      = language;
-            eval_json["source_code"]   = source_code;
-            eval_json["time_limit_ms"] = time_limit_ms;
+            // 3. Construir el JSON para el motor de evaluación
+            const std::string submission_id = make_submission_id("sub-" + problem_id);
+            const std::string client_key = app.get_context<ClientKeys>(req).key;
+            auto build_eval_json = [&]() {
+                nlohmann::json eval_json;
+
+                eval_json["submission_id"] = submission_id;
+                eval_json["client_key"]    = client_key;
+
+                eval_json["problem_id"]    = problem_id;
+                eval_json["language"]      = language;
+                eval_json["source_code"]   = source_code;
+                eval_json["time_limit_ms"] = time_limit_ms;
+                if (!failure_policy.empty()) {
+                    eval_json["failure_policy"] = failure_policy;
+                }
+                if (rejudge) {
+                    eval_json["rejudge"] = true; // el motor lo pone en el carril de rejudges
+                }
+                if (checker.type != "exact") {
+                    eval_json["checker"] = checker_to_engine_json(checker);
+                }
 
-            // test_cases: el motor espera id, input, expected_output
-            for (std::size_t i = 0; i < p.test_cases.size(); ++i) {
-                const auto& tc = p.test_cases[i];
-                auto idx = static_cast<int>(i); // Crow usa índices int
+                if (!test_data_key.empty()) {
+                    eval_json["test_data_key"] = test_data_key;
+                } else {
+                    eval_json["test_cases"] = test_cases_to_engine_json(problem->test_cases);
+                }
+                return encode_for_engine(eval_json);
+            };
+
+            // 4. Llamar a un motor de evaluación (<motor>/evaluate); el
+            //    EngineRouter elige el menos cargado y reintenta en otro si
+            //    la conexión falla
+            std::optional<crow::response> load_error;
+            auto post_evaluation = [&](const std::string& engine_url) {
+                EngineBody encoded = build_eval_json();
+                return cpr::Post(
+                    cpr::Url{engine_url + "/evaluate"},
+                    cpr::Header{{"Content-Type", encoded.content_type}},
+                    cpr::Body{std::move(encoded.data)}
+                );
+            };
+
+            cpr::Response resp = engines.send([&](std::size_t, const std::string& engine_url) {
+                if (test_data_key.empty() && problem) {
+                    upload_to(engine_url);
+                }
+                cpr::Response r = post_evaluation(engine_url);
+
+                // 409: este motor no tiene el set (reinicio, expulsión o
+                // nunca se le subió) → subirlo y reintentar en el mismo
+                if (!r.error && r.status_code == 409 && !test_data_key.empty()) {
+                    test_data_keys.erase(problem_id);
+                    if ((load_error = load_problem())) {
+                        return r;
+                    }
+                    upload_to(engine_url);
+                    r = post_evaluation(engine_url);
+                }
+                return r;
+            });
 
-                eval_json["test_cases"][idx]["id"]              = std::to_string(i + 1);
-                eval_json["test_cases"][idx]["input"]           = tc.input;
-                eval_json["test_cases"][idx]["expected_output"] = tc.expected_output;
+            if (load_error) {
+                return std::move(*load_error);
             }
 
-            // 4. Llamar al motor de evaluación (http://localhost:8090/evaluate)
-            std::string eval_url = "http://localhost:8090/evaluate";
-
-            cpr::Response resp = cpr::Post(
-                cpr::Url{eval_url},
-                cpr::Header{{"Content-Type", "application/json"}},
-                cpr::Body{eval_json.dump()}
-            );
-
             if (resp.error) {
                 return make_error_response(502, std::string("Error al llamar al motor de evaluación: ") + resp.error.message);
             }
@@ -406,8 +723,11 @@ int main() {
         });
 
         // --------- POST /run  (simple execution, no judge) ---------
+        // La primera llamada compila y devuelve "session_id"; si la UI lo
+        // reenvía con la misma fuente, el motor reutiliza el binario y solo
+        // ejecuta con el nuevo input.
         CROW_ROUTE(app, "/run").methods(crow::HTTPMethod::Post)
-        ([&repo](const crow::request& req) {
+        ([&engines, &app](const crow::request& req) {
 
             auto body_json = crow::json::load(req.body);
             if (!body_json)
@@ -422,24 +742,34 @@ int main() {
             std::string sourceCode = body_json["source_code"].s();
             std::string input      = body_json["input"].s();
 
-            // preparar un request minimalista para el motor
-            crow::json::wvalue evalJson;
-            evalJson["submission_id"] = "run-" + std::to_string(rand());
-            evalJson["language"]      = "cpp";
-            evalJson["source_code"]   = sourceCode;
-            evalJson["time_limit_ms"] = 2000;
-
-            // test único sin expected_output
-            evalJson["test_cases"][0]["id"]    = "1";
-            evalJson["test_cases"][0]["input"] = input;
-            evalJson["test_cases"][0]["expected_output"] = "";  // vacío → no comparar
-
-            // llamar al motor
-            auto resp = cpr::Post(
-                cpr::Url{"http://localhost:8090/evaluate"},
-                cpr::Header{{"Content-Type", "application/json"}},
-                cpr::Body{evalJson.dump()}
-            );
+            // Sesión anterior: volver al motor que la tiene
+            std::optional<std::pair<std::size_t, std::string>> session;
+            if (body_json.has("session_id") && body_json["session_id"].t() == crow::json::type::String) {
+                session = from_ui_session_id(std::string(body_json["session_id"].s()));
+            }
+
+            // request para el motor (sin tests: solo stdin). El session_id
+            // solo sirve en su motor: en otro se crea una sesión nueva
+            std::size_t engine_used = 0;
+            const std::string client_key = app.get_context<ClientKeys>(req).key;
+            auto resp = engines.send([&](std::size_t engine, const std::string& engine_url) {
+                engine_used = engine;
+                nlohmann::json runJson;
+                runJson["language"]      = "cpp";
+                runJson["source_code"]   = sourceCode;
+                runJson["input"]         = input;
+                runJson["time_limit_ms"] = 2000;
+                runJson["client_key"]    = client_key;
+                if (session && session->first == engine) {
+                    runJson["session_id"] = session->second;
+                }
+                EngineBody encoded = encode_for_engine(runJson);
+                return cpr::Post(
+                    cpr::Url{engine_url + "/run"},
+                    cpr::Header{{"Content-Type", encoded.content_type}},
+                    cpr::Body{std::move(encoded.data)}
+                );
+            }, session ? std::optional<std::size_t>(session->first) : std::nullopt);
 
             if (resp.error)
                 return crow::response(502, resp.error.message);
@@ -448,11 +778,49 @@ int main() {
             r.code = resp.status_code;
             r.set_header("Content-Type", "application/json");
             r.body = resp.text;
+
+            // session_id del motor → el de la UI (con el motor delante)
+            auto res_json = crow::json::load(resp.text);
+            if (resp.status_code == 200 && res_json && res_json.has("session_id")) {
+                crow::json::wvalue out(res_json);
+                out["session_id"] = to_ui_session_id(
+                    engine_used, std::string(res_json["session_id"].s()));
+                r.body = out.dump();
+            }
             return r;
         });
 
+        // --------- DELETE /run/<session_id> (liberar la sesión en el motor) ---------
+        CROW_ROUTE(app, "/run/<string>").methods(crow::HTTPMethod::Delete)
+        ([&engines](const crow::request&, const std::string& session_id) {
+            auto session = from_ui_session_id(session_id);
+            if (!session || session->first >= engines.size())
+                return crow::response(404, "Sesión desconocida");
+            auto resp = cpr::Delete(cpr::Url{engines.url(session->first) + "/run/" + session->second});
+            if (resp.error)
+                return crow::response(502, resp.error.message);
+            return crow::response(static_cast<int>(resp.status_code));
+        });
+
 
 
+        // --------- GET /engines (estado de los motores de evaluación) ---------
+        CROW_ROUTE(app, "/engines")
+        ([&engines] {
+            crow::json::wvalue body;
+            auto status = engines.status();
+            for (std::size_t i = 0; i < status.size(); ++i) {
+                auto idx = static_cast<int>(i); // Crow usa índices int
+                body["engines"][idx]["url"]         = status[i].url;
+                body["engines"][idx]["healthy"]     = status[i].healthy;
+                body["engines"][idx]["outstanding"] = status[i].outstanding;
+                body["engines"][idx]["requests"]    = status[i].requests;
+                body["engines"][idx]["failures"]    = status[i].failures;
+                body["engines"][idx]["ejections"]   = status[i].ejections;
+            }
+            return make_json_response(200, body);
+        });
+
         // 5. Levantar el servidor
         std::cout << "[GestorREST] Escuchando en http://localhost:8080 ..." << std::endl;
         app.port(8080).multithreaded().run();
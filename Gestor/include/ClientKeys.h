@@ -0,0 +1,64 @@
+#pragma once
+
+#include <crow.h>
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// ============================================================================
+// Clave de cliente para el reparto en la cola del motor
+// ============================================================================
+
+// Límites del registro de clientes.
+struct ClientKeysConfig {
+    int new_ids_per_ip_per_min{60};   // ids nuevos que puede pedir una IP por minuto
+    int idle_expiry_s{24 * 3600};     // un id sin usar tanto tiempo se olvida
+    std::size_t max_clients{100000};  // ids vivos como máximo
+};
+
+// ============================================================================
+// Middleware de Crow que decide con qué clave compite cada request en la
+// cola del motor (client_key). El Gestor no tiene usuarios autenticados,
+// así que la identidad es un id aleatorio que emite él mismo en la cookie
+// cc_client (el HttpClient de la UI la guarda y la reenvía sola):
+// - cookie con un id emitido por este Gestor → "id:<id>";
+// - sin cookie, o con un id que no emitió (inventado, vencido o de antes de
+//   un reinicio) → "ip:<IP de origen>", y la respuesta trae un id nuevo.
+// Ningún header del cliente se toma como clave. Para que rotar ids no
+// sirva para saltarse el tope por cliente de la cola, cada IP puede pedir
+// a lo sumo new_ids_per_ip_per_min ids por minuto; pasado ese tope sus
+// requests sin id válido siguen compitiendo todos como su IP.
+// ============================================================================
+class ClientKeys {
+public:
+    struct context {
+        std::string key;     // client_key para el motor
+        std::string new_id;  // id emitido en esta respuesta (vacío = ninguno)
+    };
+
+    void configure(ClientKeysConfig config);
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx);
+    void after_handle(crow::request& req, crow::response& res, context& ctx);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct MintWindow {
+        Clock::time_point start;
+        int count{0};
+    };
+
+    // Con mutex_ tomado.
+    bool may_mint(const std::string& ip, Clock::time_point now);
+    void purge(Clock::time_point now);
+
+    ClientKeysConfig config_;
+    std::mutex mutex_;
+    std::unordered_map<std::string, Clock::time_point> clients_;  // id → último uso
+    std::unordered_map<std::string, MintWindow> mints_;           // IP → ids emitidos en el minuto
+    Clock::time_point last_purge_{};
+};
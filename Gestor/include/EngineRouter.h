@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cpr/cpr.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// Balanceo entre motores de evaluación
+// ============================================================================
+
+// Configuración de los health checks y de la expulsión de motores.
+struct EngineRouterConfig {
+    int health_interval_ms{2000};     // cada cuánto se consulta GET /health de cada motor
+    int health_timeout_ms{1000};      // sin respuesta en este tiempo = check fallido
+    int eject_after_failures{2};      // fallos seguidos (requests o checks) para expulsar
+    int readmit_after_successes{2};   // checks OK seguidos para volver a usarlo
+};
+
+// Estado de un motor visto por el Gestor (GET /engines).
+struct EngineStatus {
+    std::string url;
+    bool healthy{true};
+    std::size_t outstanding{0};       // requests en curso
+    std::uint64_t requests{0};
+    std::uint64_t failures{0};        // errores de conexión y checks fallidos
+    std::uint64_t ejections{0};
+};
+
+// ============================================================================
+// Reparte las llamadas al motor entre varios procesos (en esta máquina o
+// en otras):
+// - cada request va al motor sano con menos requests en curso;
+// - un hilo consulta GET /health de todos los motores; tras
+//   eject_after_failures fallos seguidos el motor se expulsa y vuelve tras
+//   readmit_after_successes checks correctos;
+// - si la conexión falla, el request se reintenta una vez en otro motor.
+// Solo los errores de conexión cuentan como fallo: un 4xx/5xx es una
+// respuesta del motor y se devuelve tal cual.
+// ============================================================================
+class EngineRouter {
+public:
+    // Lo que se hace con un motor: recibe su índice y su URL base
+    // (p. ej. "http://localhost:8090").
+    using Call = std::function<cpr::Response(std::size_t engine, const std::string& base_url)>;
+
+    // Lanza std::invalid_argument si no hay ningún motor.
+    explicit EngineRouter(std::vector<std::string> urls,
+                          EngineRouterConfig config = EngineRouterConfig{});
+    ~EngineRouter();
+
+    EngineRouter(const EngineRouter&) = delete;
+    EngineRouter& operator=(const EngineRouter&) = delete;
+
+    // URLs separadas por coma de la variable de entorno (p. ej.
+    // CODECOACH_ENGINES="http://localhost:8090,http://localhost:8091").
+    // Si no existe o está vacía, solo `fallback`.
+    static std::vector<std::string> urls_from_env(const char* name,
+                                                  const std::string& fallback);
+
+    // Ejecuta call en `preferred` si está sano (afinidad, p. ej. la sesión
+    // de /run) o en el motor sano con menos requests en curso. Si todos
+    // están expulsados se prueba igual con uno: el Gestor nunca se queda
+    // sin motor por un health check.
+    cpr::Response send(const Call& call,
+                       std::optional<std::size_t> preferred = std::nullopt);
+
+    std::size_t size() const { return engines_.size(); }
+    const std::string& url(std::size_t engine) const { return engines_[engine].url; }
+
+    std::vector<EngineStatus> status() const;
+
+private:
+    struct Engine {
+        std::string url;
+        bool healthy{true};
+        int consecutive_failures{0};
+        int consecutive_successes{0};
+        std::size_t outstanding{0};
+        std::uint64_t requests{0};
+        std::uint64_t failures{0};
+        std::uint64_t ejections{0};
+    };
+
+    // Motor para el próximo intento (con mutex_ tomado). std::nullopt =
+    // no queda ninguno distinto de `exclude`.
+    std::optional<std::size_t> pick(std::optional<std::size_t> preferred,
+                                    std::optional<std::size_t> exclude);
+    cpr::Response attempt(const Call& call, std::size_t engine);
+    void record(std::size_t engine, bool ok); // con mutex_ tomado
+    void health_loop();
+
+    EngineRouterConfig config_;
+    mutable std::mutex mutex_;
+    std::vector<Engine> engines_;     // tamaño fijo desde el constructor
+    std::size_t next_{0};             // desempate rotativo entre motores igual de cargados
+    std::condition_variable stop_cv_;
+    bool stopping_{false};
+    std::thread health_thread_;
+};
@@ -20,6 +20,18 @@ struct TestCase {
     std::string expected_output;
 };
 
+// Checker con el que el motor decide si una salida es correcta.
+// - type: "exact" (por defecto), "tokens", "float", "unordered_lines" o "custom".
+// - abs_epsilon / rel_epsilon: tolerancias del checker "float".
+// - source: código C++ del checker "custom" (el motor lo compila una vez
+//   por versión y lo cachea).
+struct Checker {
+    std::string type{"exact"};
+    double abs_epsilon{1e-6};
+    double rel_epsilon{1e-6};
+    std::string source;
+};
+
 // Representa un problema almacenado en MongoDB.
 // Este objeto se construye tanto desde JSON (UI) como desde documentos BSON.
 struct Problem {
@@ -30,6 +42,7 @@ struct Problem {
     std::vector<std::string> tags;    // Lista de etiquetas (ej: ["math", "loops"]).
     std::vector<TestCase> test_cases; // Casos de prueba para el juez.
     std::string code_stub;            // Código base inicial mostrado al usuario.
+    Checker checker;                  // Cómo se validan las salidas.
 };
 
 // ============================================================================
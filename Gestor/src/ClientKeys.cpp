@@ -0,0 +1,98 @@
+#include "ClientKeys.h"
+
+#include <iomanip>
+#include <iterator>
+#include <random>
+#include <sstream>
+
+static constexpr const char* kCookieName = "cc_client";
+
+// Valor de una cookie del header Cookie ("a=1; cc_client=...; b=2").
+static std::string cookie_value(const std::string& header, const std::string& name) {
+    std::size_t pos = 0;
+    while (pos < header.size()) {
+        std::size_t end = header.find(';', pos);
+        if (end == std::string::npos) {
+            end = header.size();
+        }
+        std::size_t start = header.find_first_not_of(' ', pos);
+        if (start < end && header.compare(start, name.size(), name) == 0 &&
+            start + name.size() < end && header[start + name.size()] == '=') {
+            return header.substr(start + name.size() + 1, end - start - name.size() - 1);
+        }
+        pos = end + 1;
+    }
+    return {};
+}
+
+// 128 bits aleatorios en hex: imposibles de adivinar, así que un id válido
+// solo se consigue pidiéndoselo al Gestor.
+static std::string random_id() {
+    static thread_local std::mt19937_64 gen{std::random_device{}()};
+    std::ostringstream oss;
+    oss << std::hex << std::setfill('0')
+        << std::setw(16) << gen() << std::setw(16) << gen();
+    return oss.str();
+}
+
+void ClientKeys::configure(ClientKeysConfig config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+}
+
+void ClientKeys::before_handle(crow::request& req, crow::response&, context& ctx) {
+    const auto now = Clock::now();
+    std::string id = cookie_value(req.get_header_value("Cookie"), kCookieName);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    purge(now);
+
+    auto it = id.empty() ? clients_.end() : clients_.find(id);
+    if (it != clients_.end()) {
+        it->second = now;
+        ctx.key = "id:" + id;
+        return;
+    }
+
+    ctx.key = "ip:" + req.remote_ip_address;
+    if (clients_.size() < config_.max_clients && may_mint(req.remote_ip_address, now)) {
+        ctx.new_id = random_id();
+        clients_.emplace(ctx.new_id, now);
+    }
+}
+
+void ClientKeys::after_handle(crow::request&, crow::response& res, context& ctx) {
+    if (!ctx.new_id.empty()) {
+        res.add_header("Set-Cookie", std::string(kCookieName) + "=" + ctx.new_id +
+                                     "; Path=/; HttpOnly; SameSite=Strict");
+    }
+}
+
+bool ClientKeys::may_mint(const std::string& ip, Clock::time_point now) {
+    MintWindow& window = mints_[ip];
+    if (now - window.start >= std::chrono::minutes(1)) {
+        window.start = now;
+        window.count = 0;
+    }
+    if (window.count >= config_.new_ids_per_ip_per_min) {
+        return false;
+    }
+    ++window.count;
+    return true;
+}
+
+// Olvida ids vencidos y ventanas de emisión viejas (una vez por minuto).
+void ClientKeys::purge(Clock::time_point now) {
+    if (now - last_purge_ < std::chrono::minutes(1)) {
+        return;
+    }
+    last_purge_ = now;
+
+    const auto idle = std::chrono::seconds(config_.idle_expiry_s);
+    for (auto it = clients_.begin(); it != clients_.end();) {
+        it = now - it->second > idle ? clients_.erase(it) : std::next(it);
+    }
+    for (auto it = mints_.begin(); it != mints_.end();) {
+        it = now - it->second.start >= std::chrono::minutes(1) ? mints_.erase(it) : std::next(it);
+    }
+}
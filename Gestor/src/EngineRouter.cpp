@@ -0,0 +1,224 @@
+#include "EngineRouter.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+// Quita espacios y la "/" final ("http://host:8090/ " → "http://host:8090").
+static std::string normalize_url(std::string url) {
+    const char* blanks = " \t\r\n";
+    url.erase(0, url.find_first_not_of(blanks));
+    url.erase(url.find_last_not_of(blanks) + 1);
+    while (!url.empty() && url.back() == '/') {
+        url.pop_back();
+    }
+    return url;
+}
+
+EngineRouter::EngineRouter(std::vector<std::string> urls, EngineRouterConfig config)
+    : config_(config) {
+    for (auto& u : urls) {
+        std::string url = normalize_url(u);
+        if (!url.empty()) {
+            Engine e;
+            e.url = std::move(url);
+            engines_.push_back(std::move(e));
+        }
+    }
+    if (engines_.empty()) {
+        throw std::invalid_argument("EngineRouter: no hay motores configurados");
+    }
+    health_thread_ = std::thread([this] { health_loop(); });
+}
+
+EngineRouter::~EngineRouter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    stop_cv_.notify_all();
+    health_thread_.join();
+}
+
+std::vector<std::string> EngineRouter::urls_from_env(const char* name,
+                                                     const std::string& fallback) {
+    std::vector<std::string> urls;
+    const char* value = std::getenv(name);
+    if (value && *value) {
+        std::istringstream iss(value);
+        std::string item;
+        while (std::getline(iss, item, ',')) {
+            item = normalize_url(item);
+            if (!item.empty()) {
+                urls.push_back(item);
+            }
+        }
+    }
+    if (urls.empty()) {
+        urls.push_back(fallback);
+    }
+    return urls;
+}
+
+// ============================================================================
+// pick
+// Menos requests en curso entre los sanos; a igualdad, rotativo (así dos
+// motores ociosos se alternan). Sin sanos, el expulsado menos cargado.
+// ============================================================================
+std::optional<std::size_t> EngineRouter::pick(std::optional<std::size_t> preferred,
+                                              std::optional<std::size_t> exclude) {
+    if (preferred && *preferred < engines_.size() && preferred != exclude &&
+        engines_[*preferred].healthy) {
+        return preferred;
+    }
+
+    std::optional<std::size_t> best;
+    bool best_healthy = false;
+    const std::size_t n = engines_.size();
+    for (std::size_t k = 0; k < n; ++k) {
+        std::size_t i = (next_ + k) % n;
+        if (exclude && i == *exclude) {
+            continue;
+        }
+        const Engine& e = engines_[i];
+        bool better = !best ||
+            (e.healthy && !best_healthy) ||
+            (e.healthy == best_healthy && e.outstanding < engines_[*best].outstanding);
+        if (better) {
+            best = i;
+            best_healthy = e.healthy;
+        }
+    }
+    if (best) {
+        next_ = (*best + 1) % n;
+    }
+    return best;
+}
+
+cpr::Response EngineRouter::attempt(const Call& call, std::size_t engine) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++engines_[engine].outstanding;
+        ++engines_[engine].requests;
+    }
+
+    cpr::Response resp;
+    try {
+        resp = call(engine, engines_[engine].url);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --engines_[engine].outstanding;
+        throw;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    --engines_[engine].outstanding;
+    record(engine, !resp.error);
+    return resp;
+}
+
+cpr::Response EngineRouter::send(const Call& call, std::optional<std::size_t> preferred) {
+    std::optional<std::size_t> first;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        first = pick(preferred, std::nullopt);
+    }
+    cpr::Response resp = attempt(call, *first);
+    if (!resp.error) {
+        return resp;
+    }
+
+    // Error de conexión: un solo reintento, en otro motor
+    std::optional<std::size_t> second;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        second = pick(std::nullopt, first);
+    }
+    if (!second) {
+        return resp;
+    }
+    std::cerr << "[EngineRouter] " << engines_[*first].url << " falló ("
+              << resp.error.message << "), reintentando en "
+              << engines_[*second].url << std::endl;
+    return attempt(call, *second);
+}
+
+// ============================================================================
+// record
+// Resultado de un request o de un health check. Expulsa tras
+// eject_after_failures fallos seguidos y readmite tras
+// readmit_after_successes éxitos seguidos.
+// ============================================================================
+void EngineRouter::record(std::size_t engine, bool ok) {
+    Engine& e = engines_[engine];
+    if (ok) {
+        e.consecutive_failures = 0;
+        ++e.consecutive_successes;
+        if (!e.healthy && e.consecutive_successes >= config_.readmit_after_successes) {
+            e.healthy = true;
+            std::cerr << "[EngineRouter] " << e.url << " readmitido" << std::endl;
+        }
+        return;
+    }
+
+    ++e.failures;
+    e.consecutive_successes = 0;
+    ++e.consecutive_failures;
+    if (e.healthy && e.consecutive_failures >= config_.eject_after_failures) {
+        e.healthy = false;
+        ++e.ejections;
+        std::cerr << "[EngineRouter] " << e.url << " expulsado tras "
+                  << e.consecutive_failures << " fallos" << std::endl;
+    }
+}
+
+// ============================================================================
+// health_loop
+// GET /health de cada motor cada health_interval_ms (fuera del lock: un
+// motor colgado no frena a los requests).
+// ============================================================================
+void EngineRouter::health_loop() {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            stop_cv_.wait_for(lock, std::chrono::milliseconds(config_.health_interval_ms),
+                              [this] { return stopping_; });
+            if (stopping_) {
+                return;
+            }
+        }
+
+        for (std::size_t i = 0; i < engines_.size(); ++i) {
+            cpr::Response resp = cpr::Get(
+                cpr::Url{engines_[i].url + "/health"},
+                cpr::Timeout{config_.health_timeout_ms}
+            );
+            bool ok = !resp.error && resp.status_code == 200;
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) {
+                return;
+            }
+            record(i, ok);
+        }
+    }
+}
+
+std::vector<EngineStatus> EngineRouter::status() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<EngineStatus> out;
+    out.reserve(engines_.size());
+    for (const auto& e : engines_) {
+        EngineStatus s;
+        s.url = e.url;
+        s.healthy = e.healthy;
+        s.outstanding = e.outstanding;
+        s.requests = e.requests;
+        s.failures = e.failures;
+        s.ejections = e.ejections;
+        out.push_back(std::move(s));
+    }
+    return out;
+}
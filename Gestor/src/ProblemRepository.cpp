@@ -25,6 +25,55 @@ static std::string get_string_field(const bsoncxx::document::view& doc,
     return {};
 }
 
+// Extrae un campo numérico (double o entero) del documento BSON.
+// Si no existe o no es numérico, se devuelve `fallback`.
+static double get_double_field(const bsoncxx::document::view& doc,
+                               const char* field_name,
+                               double fallback) {
+    auto elem = doc[field_name];
+    if (!elem) {
+        return fallback;
+    }
+    switch (elem.type()) {
+        case bsoncxx::type::k_double: return elem.get_double().value;
+        case bsoncxx::type::k_int32:  return elem.get_int32().value;
+        case bsoncxx::type::k_int64:  return static_cast<double>(elem.get_int64().value);
+        default:                      return fallback;
+    }
+}
+
+// Subdocumento "checker". Los problemas guardados antes de que existiera
+// no lo tienen: quedan con el checker "exact".
+static Checker document_to_checker(const bsoncxx::document::view& doc_view) {
+    Checker c;
+    auto it = doc_view.find("checker");
+    if (it == doc_view.end() || it->type() != bsoncxx::type::k_document) {
+        return c;
+    }
+    auto checker_doc = it->get_document().value;
+
+    std::string type = get_string_field(checker_doc, "type");
+    if (!type.empty()) {
+        c.type = type;
+    }
+    c.abs_epsilon = get_double_field(checker_doc, "abs_epsilon", c.abs_epsilon);
+    c.rel_epsilon = get_double_field(checker_doc, "rel_epsilon", c.rel_epsilon);
+    c.source      = get_string_field(checker_doc, "source");
+    return c;
+}
+
+// Construye el subdocumento "checker" para insert/update.
+static bsoncxx::document::value checker_to_document(const Checker& c) {
+    document checker_doc;
+    checker_doc.append(
+        kvp("type", c.type),
+        kvp("abs_epsilon", c.abs_epsilon),
+        kvp("rel_epsilon", c.rel_epsilon),
+        kvp("source", c.source)
+    );
+    return checker_doc.extract();
+}
+
 // Convierte un documento BSON a un struct Problem.
 // Se usa en GET /problems, GET by id, etc.
 static Problem document_to_problem(const bsoncxx::document::view& doc_view) {
@@ -36,6 +85,7 @@ static Problem document_to_problem(const bsoncxx::document::view& doc_view) {
     p.description = get_string_field(doc_view, "description");
     p.difficulty  = get_string_field(doc_view, "difficulty");
     p.code_stub   = get_string_field(doc_view, "code_stub");
+    p.checker     = document_to_checker(doc_view);
 
     // --------------------------
     // tags: array de strings
@@ -124,7 +174,8 @@ void ProblemRepository::insert_problem(const Problem& p) {
         kvp("difficulty", p.difficulty),
         kvp("code_stub", p.code_stub),
         kvp("tags", tags_arr),
-        kvp("test_cases", tcs_arr)
+        kvp("test_cases", tcs_arr),
+        kvp("checker", checker_to_document(p.checker))
     );
 
     collection_.insert_one(doc_builder.view());
@@ -210,7 +261,8 @@ bool ProblemRepository::update_problem(const Problem& p) {
         kvp("difficulty", p.difficulty),
         kvp("code_stub", p.code_stub),
         kvp("tags", tags_arr),
-        kvp("test_cases", tcs_arr)
+        kvp("test_cases", tcs_arr),
+        kvp("checker", checker_to_document(p.checker))
     );
 
     // Filtro por problem_id
@@ -0,0 +1,582 @@
+// ============================================================================
+// judge-driver
+//
+// Driver que corre DENTRO del contenedor y ejecuta varios tests en una sola
+// invocación de Docker. Por cada id recibido:
+//   stdin  <- input_<id>.txt
+//   stdout -> output_<id>.txt
+//   stderr -> runtime_<id>.log
+// con su propio límite de tiempo y rlimits, y agrega una línea al archivo de
+// resultados:
+//   id=<id> exit=<código> signal=<señal> cpu_ms=<n> wall_ms=<n> rss_kb=<n> timed_out=<0|1>
+//      output_limit=<0|1>
+//
+// El límite (--time-ms) se controla sobre el tiempo de CPU del proceso, con
+// resolución de milisegundos; --wall-ms es un tope de tiempo real para
+// programas dormidos o bloqueados (por defecto 2 * time-ms + 100).
+//
+// Con --jobs J se ejecutan hasta J tests a la vez; los registros se escriben
+// a medida que terminan (el motor los empareja por id).
+//
+// Con --stop-on timeout|failure no se lanzan más tests después del primero
+// que excede el tiempo (o termina con error); los ya lanzados terminan y los
+// restantes quedan sin registro (el motor los reporta como Skipped).
+//
+// Con --output-bytes N el programa no puede escribir más de N bytes: a los
+// archivos se les aplica RLIMIT_FSIZE (N + 1, así un programa que ignora
+// SIGXFSZ igual deja un archivo más grande que N) y, si stdout es "-", la
+// salida pasa por un pipe propio del driver que la reenvía contando bytes y
+// mata al programa en cuanto supera N. En ambos casos output_limit=1.
+//
+// Con --stdin/--stdout/--stderr se ejecuta un único test con esos archivos
+// en lugar de los nombres derivados del id (lo usa runSingleTest). "-"
+// deja el stream del driver tal cual (modo en memoria: el motor escribe y
+// lee por los pipes de `docker exec -i`); con <resultados> = "-" cada
+// registro se escribe en stderr, tras una línea "#judge-driver#". Es lo que
+// usa el motor: un archivo de resultados en /workspace lo podría reescribir
+// el programa.
+//
+// Cada test corre en su propio grupo de procesos. Al terminar (o al
+// matarlo) se mata el grupo entero y, como el driver es subreaper, también
+// los procesos que el test dejó fuera del grupo (setsid, doble fork): nada
+// sigue corriendo mientras se ejecutan los tests siguientes.
+//
+// Uso:
+//   judge-driver [--time-ms N] [--wall-ms W] [--memory-mb M] [--jobs J] [--binary ./main]
+//                [--output-bytes N] [--stop-on timeout|failure]
+//                [--stdin F --stdout F --stderr F] <resultados> <id>...
+// ============================================================================
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ctime>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+    struct Options {
+        long timeMs{2000};          // límite de CPU por test
+        long wallMs{0};             // tope de tiempo real (0 = automático)
+        long memoryMb{256};         // límite de memoria (espacio virtual)
+        long jobs{1};               // tests en paralelo
+        long long outputBytes{0};   // tope de salida (0 = sin límite)
+        std::string binary{"./main"};
+        std::string stopOn;         // "", "timeout" o "failure"
+        std::string stdinFile;      // vacíos = input_<id>.txt, etc.
+        std::string stdoutFile;
+        std::string stderrFile;
+        std::string resultsFile;
+        std::vector<std::string> ids;
+    };
+
+    struct Record {
+        int exitCode{0};
+        int signal{0};
+        long cpuMs{0};
+        long wallMs{0};
+        long rssKb{0};
+        bool timedOut{false};
+        bool outputLimit{false};
+    };
+
+    long toMs(const timeval& tv) {
+        return static_cast<long>(tv.tv_sec) * 1000 + tv.tv_usec / 1000;
+    }
+
+    bool parseArgs(int argc, char** argv, Options& opt) {
+        int i = 1;
+        for (; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.rfind("--", 0) != 0) {
+                break;
+            }
+            if (i + 1 >= argc) {
+                return false;
+            }
+            std::string value = argv[++i];
+            if (arg == "--time-ms") {
+                opt.timeMs = std::atol(value.c_str());
+            } else if (arg == "--wall-ms") {
+                opt.wallMs = std::atol(value.c_str());
+            } else if (arg == "--memory-mb") {
+                opt.memoryMb = std::atol(value.c_str());
+            } else if (arg == "--jobs") {
+                opt.jobs = std::atol(value.c_str());
+                if (opt.jobs < 1) {
+                    opt.jobs = 1;
+                }
+            } else if (arg == "--stop-on") {
+                if (value != "timeout" && value != "failure") {
+                    return false;
+                }
+                opt.stopOn = value;
+            } else if (arg == "--output-bytes") {
+                opt.outputBytes = std::atoll(value.c_str());
+            } else if (arg == "--binary") {
+                opt.binary = value;
+            } else if (arg == "--stdin") {
+                opt.stdinFile = value;
+            } else if (arg == "--stdout") {
+                opt.stdoutFile = value;
+            } else if (arg == "--stderr") {
+                opt.stderrFile = value;
+            } else {
+                return false;
+            }
+        }
+        if (i >= argc) {
+            return false;
+        }
+        opt.resultsFile = argv[i++];
+        for (; i < argc; ++i) {
+            opt.ids.emplace_back(argv[i]);
+        }
+        if (opt.wallMs <= 0) {
+            opt.wallMs = opt.timeMs * 2 + 100;
+        }
+        bool explicitFiles = !opt.stdinFile.empty() || !opt.stdoutFile.empty() ||
+                             !opt.stderrFile.empty();
+        return !explicitFiles || opt.ids.size() == 1;
+    }
+
+    // CPU (user+sys) consumida hasta ahora por un proceso vivo, en ms.
+    // Usa el reloj de CPU del proceso (ns); si no está disponible, los ticks
+    // de /proc/<pid>/stat.
+    long cpuMsOf(pid_t pid) {
+        clockid_t clock;
+        timespec ts{};
+        if (clock_getcpuclockid(pid, &clock) == 0 && clock_gettime(clock, &ts) == 0) {
+            return static_cast<long>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+        }
+
+        std::string path = "/proc/" + std::to_string(pid) + "/stat";
+        std::FILE* f = std::fopen(path.c_str(), "r");
+        if (!f) {
+            return 0;
+        }
+        char buf[1024];
+        std::size_t n = std::fread(buf, 1, sizeof(buf) - 1, f);
+        std::fclose(f);
+        buf[n] = '\0';
+
+        // Campos 14 y 15 (utime, stime), contando desde después de "(comm)"
+        const char* p = std::strrchr(buf, ')');
+        unsigned long utime = 0, stime = 0;
+        if (!p || std::sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+                              &utime, &stime) != 2) {
+            return 0;
+        }
+        long ticks = sysconf(_SC_CLK_TCK);
+        return static_cast<long>((utime + stime) * 1000 / static_cast<unsigned long>(ticks));
+    }
+
+    // Abre `path` sobre targetFd; "-" conserva el stream heredado del driver.
+    void redirect(const std::string& path, int targetFd, int flags) {
+        if (path == "-") {
+            return;
+        }
+        int fd = open(path.c_str(), flags, 0644);
+        if (fd < 0) {
+            _exit(127);
+        }
+        dup2(fd, targetFd);
+        close(fd);
+    }
+
+    std::string stdoutNameOf(const Options& opt, const std::string& id) {
+        return opt.stdoutFile.empty() ? "output_" + id + ".txt" : opt.stdoutFile;
+    }
+
+    // Proceso hijo: redirige archivos, aplica rlimits y ejecuta el binario.
+    // captureFd >= 0: extremo de escritura del pipe de salida del driver.
+    [[noreturn]] void execChild(const Options& opt, const std::string& id, int captureFd) {
+        setpgid(0, 0); // grupo propio: killpg alcanza a todo lo que lance
+
+        std::string in  = opt.stdinFile.empty()  ? "input_"   + id + ".txt" : opt.stdinFile;
+        std::string out = stdoutNameOf(opt, id);
+        std::string err = opt.stderrFile.empty() ? "runtime_" + id + ".log" : opt.stderrFile;
+
+        redirect(in, STDIN_FILENO, O_RDONLY);
+        if (captureFd >= 0) {
+            dup2(captureFd, STDOUT_FILENO);
+        } else {
+            redirect(out, STDOUT_FILENO, O_WRONLY | O_CREAT | O_TRUNC);
+        }
+        redirect(err, STDERR_FILENO, O_WRONLY | O_CREAT | O_TRUNC);
+
+        // Salida: tope por archivo (stdout y stderr)
+        if (opt.outputBytes > 0) {
+            rlim_t fsize = static_cast<rlim_t>(opt.outputBytes) + 1;
+            rlimit rlFsize{fsize, fsize};
+            setrlimit(RLIMIT_FSIZE, &rlFsize);
+        }
+
+        // Memoria: espacio virtual
+        rlim_t mem = static_cast<rlim_t>(opt.memoryMb) * 1024 * 1024;
+        rlimit rlMem{mem, mem};
+        setrlimit(RLIMIT_AS, &rlMem);
+
+        // CPU: respaldo en segundos por si el driver no alcanza a matar
+        // (el límite real en ms lo aplica runAll)
+        rlim_t cpu = static_cast<rlim_t>((opt.timeMs + 999) / 1000 + 1);
+        rlimit rlCpu{cpu, cpu};
+        setrlimit(RLIMIT_CPU, &rlCpu);
+
+        // Sin core dumps
+        rlimit rlCore{0, 0};
+        setrlimit(RLIMIT_CORE, &rlCore);
+
+        char* const args[] = {const_cast<char*>(opt.binary.c_str()), nullptr};
+        execv(opt.binary.c_str(), args);
+        _exit(127);
+    }
+
+    // Test en ejecución.
+    struct Running {
+        pid_t pid{-1};
+        std::string id;
+        std::chrono::steady_clock::time_point start;
+        bool timedOut{false};
+        int captureFd{-1};          // lectura del pipe de salida (-1 = sin pipe)
+        long long outputBytes{0};   // bytes recibidos por el pipe
+        bool outputLimit{false};
+    };
+
+    // Lanza un test sin esperar a que termine. Con tope de salida y stdout
+    // "-", la salida del programa pasa por un pipe del driver.
+    Running startTest(const Options& opt, const std::string& id) {
+        Running run;
+        run.id = id;
+        run.start = std::chrono::steady_clock::now();
+
+        int capture[2] = {-1, -1};
+        const std::string out = stdoutNameOf(opt, id);
+        if (opt.outputBytes > 0 && out == "-" && pipe2(capture, O_CLOEXEC) != 0) {
+            run.pid = -1;
+            return run;
+        }
+        // El tamaño del archivo se vigila mientras corre: que no cuente
+        // lo de una ejecución anterior antes de que el hijo lo trunque
+        if (opt.outputBytes > 0 && out != "-") {
+            truncate(out.c_str(), 0);
+        }
+
+        run.pid = fork();
+        if (run.pid == 0) {
+            execChild(opt, id, capture[1]);
+        }
+        if (run.pid > 0) {
+            setpgid(run.pid, run.pid); // también acá: sin carrera con el hijo
+        }
+        if (capture[0] >= 0) {
+            close(capture[1]);
+            if (run.pid < 0) {
+                close(capture[0]);
+            } else {
+                fcntl(capture[0], F_SETFL, O_NONBLOCK);
+                run.captureFd = capture[0];
+            }
+        }
+        return run;
+    }
+
+    // Reenvía al stdout del driver lo que el programa escribió, hasta
+    // opt.outputBytes; si se pasa, lo mata. `final` = el programa ya
+    // terminó (se lee hasta EOF).
+    void drainCapture(const Options& opt, Running& run, bool final) {
+        char buf[65536];
+        while (run.captureFd >= 0) {
+            ssize_t n = read(run.captureFd, buf, sizeof(buf));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && errno == EAGAIN && !final) {
+                return;
+            }
+            if (n <= 0) {
+                close(run.captureFd);
+                run.captureFd = -1;
+                return;
+            }
+            long long room = opt.outputBytes - run.outputBytes;
+            long long forward = std::min<long long>(n, std::max(0LL, room));
+            for (long long off = 0; off < forward;) {
+                ssize_t w = write(STDOUT_FILENO, buf + off, static_cast<std::size_t>(forward - off));
+                if (w < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (w <= 0) {
+                    break;
+                }
+                off += w;
+            }
+            run.outputBytes += n;
+            if (run.outputBytes > opt.outputBytes && !run.outputLimit) {
+                run.outputLimit = true;
+                killpg(run.pid, SIGKILL);
+            }
+        }
+    }
+
+    // Padre de un proceso según /proc/<pid>/stat (-1 si ya no existe).
+    pid_t parentOf(pid_t pid) {
+        std::string path = "/proc/" + std::to_string(pid) + "/stat";
+        std::FILE* f = std::fopen(path.c_str(), "r");
+        if (!f) {
+            return -1;
+        }
+        char buf[1024];
+        std::size_t n = std::fread(buf, 1, sizeof(buf) - 1, f);
+        std::fclose(f);
+        buf[n] = '\0';
+
+        const char* p = std::strrchr(buf, ')');
+        int ppid = -1;
+        if (!p || std::sscanf(p + 2, "%*c %d", &ppid) != 1) {
+            return -1;
+        }
+        return static_cast<pid_t>(ppid);
+    }
+
+    // ============================================================================
+    // killStrays
+    // Mata y recoge los hijos del driver que no son tests en curso: procesos
+    // que dejó un test y que, al morir sus padres, quedaron colgados del
+    // driver (PR_SET_CHILD_SUBREAPER). Se repite porque al matar uno sus
+    // propios hijos pasan a ser del driver.
+    // ============================================================================
+    void killStrays(const std::vector<Running>& running) {
+        const pid_t self = getpid();
+        for (int round = 0; round < 64; ++round) {
+            std::vector<pid_t> strays;
+            DIR* proc = opendir("/proc");
+            if (!proc) {
+                return;
+            }
+            while (dirent* entry = readdir(proc)) {
+                if (!std::isdigit(static_cast<unsigned char>(entry->d_name[0]))) {
+                    continue;
+                }
+                pid_t pid = static_cast<pid_t>(std::atol(entry->d_name));
+                bool tracked = std::any_of(running.begin(), running.end(),
+                                           [pid](const Running& r) { return r.pid == pid; });
+                if (!tracked && parentOf(pid) == self) {
+                    strays.push_back(pid);
+                }
+            }
+            closedir(proc);
+
+            if (strays.empty()) {
+                return;
+            }
+            for (pid_t pid : strays) {
+                kill(pid, SIGKILL);
+            }
+            for (pid_t pid : strays) {
+                while (waitpid(pid, nullptr, 0) < 0 && errno == EINTR) {
+                }
+            }
+        }
+    }
+
+
+    // Convierte el estado de wait4 en un registro.
+    Record finishTest(const Options& opt, const Running& run, int status, const rusage& usage) {
+        Record rec;
+        rec.timedOut = run.timedOut;
+        rec.outputLimit = run.outputLimit;
+        rec.wallMs = static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - run.start).count());
+        rec.cpuMs = toMs(usage.ru_utime) + toMs(usage.ru_stime);
+        rec.rssKb = usage.ru_maxrss; // Linux: KB
+
+        if (WIFEXITED(status)) {
+            rec.exitCode = WEXITSTATUS(status);
+        } else if (WIFSIGNALED(status)) {
+            rec.signal = WTERMSIG(status);
+            rec.exitCode = 128 + rec.signal; // misma convención que bash
+            if (rec.signal == SIGXCPU) {
+                rec.timedOut = true;
+            }
+            if (rec.signal == SIGXFSZ) {
+                rec.outputLimit = true;
+            }
+        }
+        // Pudo pasarse del límite entre dos revisiones
+        if (rec.cpuMs > opt.timeMs) {
+            rec.timedOut = true;
+        }
+        // Un programa que ignora SIGXFSZ no muere, pero deja N + 1 bytes
+        std::string out = stdoutNameOf(opt, run.id);
+        struct stat st{};
+        if (opt.outputBytes > 0 && out != "-" && stat(out.c_str(), &st) == 0 &&
+            st.st_size > opt.outputBytes) {
+            rec.outputLimit = true;
+        }
+        return rec;
+    }
+
+    // true si el registro corta el resto de los tests (--stop-on).
+    bool stopsRun(const Options& opt, const Record& rec) {
+        if (opt.stopOn == "timeout") {
+            return rec.timedOut;
+        }
+        if (opt.stopOn == "failure") {
+            return rec.timedOut || rec.exitCode != 0 || rec.outputLimit;
+        }
+        return false;
+    }
+
+    void writeRecord(std::FILE* results, const std::string& id, const Record& rec) {
+        if (results == stderr) {
+            std::fputs("\n#judge-driver#\n", results); // separa el stderr del programa
+        }
+        std::fprintf(results,
+            "id=%s exit=%d signal=%d cpu_ms=%ld wall_ms=%ld rss_kb=%ld timed_out=%d output_limit=%d\n",
+            id.c_str(), rec.exitCode, rec.signal, rec.cpuMs, rec.wallMs, rec.rssKb,
+            rec.timedOut ? 1 : 0, rec.outputLimit ? 1 : 0);
+        std::fflush(results);
+    }
+
+    // ============================================================================
+    // runAll
+    // Mantiene hasta opt.jobs tests corriendo; revisa cada 1 ms cuáles
+    // terminaron y mata a los que exceden la CPU o el tope de tiempo real.
+    // ============================================================================
+    void runAll(const Options& opt, std::FILE* results) {
+        std::vector<Running> running;
+        std::size_t next = 0;
+
+        while (next < opt.ids.size() || !running.empty()) {
+            while (next < opt.ids.size() && static_cast<long>(running.size()) < opt.jobs) {
+                Running run = startTest(opt, opt.ids[next++]);
+                if (run.pid < 0) {
+                    Record rec;
+                    rec.exitCode = 127;
+                    writeRecord(results, run.id, rec);
+                    if (stopsRun(opt, rec)) {
+                        next = opt.ids.size();
+                    }
+                    continue;
+                }
+                running.push_back(std::move(run));
+            }
+
+            for (std::size_t i = 0; i < running.size();) {
+                Running& run = running[i];
+                int status = 0;
+                rusage usage{};
+
+                // Sin recogerlo todavía: mientras es zombie su pid (= id del
+                // grupo) no se reutiliza, así killpg no alcanza a otro test
+                siginfo_t info{};
+                int w = waitid(P_PID, static_cast<id_t>(run.pid), &info,
+                               WEXITED | WNOHANG | WNOWAIT);
+                bool exited = (w == 0 && info.si_pid == run.pid) || (w < 0 && errno != EINTR);
+
+                if (exited) {
+                    killpg(run.pid, SIGKILL); // lo que el test haya dejado corriendo
+                    while (wait4(run.pid, &status, 0, &usage) < 0 && errno == EINTR) {
+                    }
+                    killStrays(running);
+                    drainCapture(opt, run, /*final=*/true);
+                    Record rec = finishTest(opt, run, status, usage);
+                    writeRecord(results, run.id, rec);
+                    if (stopsRun(opt, rec)) {
+                        next = opt.ids.size(); // fail-fast: no lanzar más
+                    }
+                    running.erase(running.begin() + static_cast<long>(i));
+                    continue;
+                }
+
+                drainCapture(opt, run, /*final=*/false);
+
+                // Programa que ignora SIGXFSZ: el archivo queda en N + 1
+                // bytes y se lo detiene sin esperar al timeout
+                struct stat st{};
+                const std::string out = stdoutNameOf(opt, run.id);
+                if (!run.outputLimit && opt.outputBytes > 0 && out != "-" &&
+                    stat(out.c_str(), &st) == 0 && st.st_size > opt.outputBytes) {
+                    run.outputLimit = true;
+                    killpg(run.pid, SIGKILL);
+                }
+
+                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - run.start).count();
+                if (!run.timedOut && (elapsed > opt.wallMs || cpuMsOf(run.pid) > opt.timeMs)) {
+                    run.timedOut = true;
+                    killpg(run.pid, SIGKILL);
+                }
+                ++i;
+            }
+
+            if (!running.empty()) {
+                // Espera 1 ms (o menos si llega salida por algún pipe)
+                std::vector<pollfd> fds;
+                for (const auto& run : running) {
+                    if (run.captureFd >= 0) {
+                        fds.push_back({run.captureFd, POLLIN, 0});
+                    }
+                }
+                if (fds.empty()) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                } else {
+                    poll(fds.data(), fds.size(), 1);
+                }
+            }
+        }
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        std::fprintf(stderr,
+            "uso: judge-driver [--time-ms N] [--wall-ms W] [--memory-mb M] [--jobs J] [--binary ./main]\n"
+            "                  [--output-bytes N] [--stop-on timeout|failure]\n"
+            "                  [--stdin F --stdout F --stderr F] <resultados> <id>...\n");
+        return 2;
+    }
+
+    // Los procesos que deja un test quedan colgados del driver y no de
+    // init: así killStrays los encuentra
+    prctl(PR_SET_CHILD_SUBREAPER, 1, 0, 0, 0);
+
+    if (opt.resultsFile == "-") {
+        runAll(opt, stderr);
+        return 0;
+    }
+
+    // "e" (O_CLOEXEC): el programa no hereda el descriptor de resultados
+    std::FILE* results = std::fopen(opt.resultsFile.c_str(), "we");
+    if (!results) {
+        std::perror("judge-driver: resultados");
+        return 2;
+    }
+
+    runAll(opt, results);
+
+    std::fclose(results);
+    return 0;
+}
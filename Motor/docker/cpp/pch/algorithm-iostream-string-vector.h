@@ -0,0 +1,5 @@
+// Encabezado precompilado: <algorithm> <iostream> <string> <vector>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
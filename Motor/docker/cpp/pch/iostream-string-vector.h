@@ -0,0 +1,4 @@
+// Encabezado precompilado: <iostream> <string> <vector>
+#include <iostream>
+#include <string>
+#include <vector>
@@ -0,0 +1,3 @@
+// Encabezado precompilado: <iostream> <string>
+#include <iostream>
+#include <string>
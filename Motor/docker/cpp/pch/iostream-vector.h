@@ -0,0 +1,3 @@
+// Encabezado precompilado: <iostream> <vector>
+#include <iostream>
+#include <vector>
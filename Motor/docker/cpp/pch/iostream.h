@@ -0,0 +1,2 @@
+// Encabezado precompilado: <iostream>
+#include <iostream>
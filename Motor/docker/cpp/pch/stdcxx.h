@@ -0,0 +1,2 @@
+// Encabezado precompilado: todo <bits/stdc++.h>
+#include <bits/stdc++.h>
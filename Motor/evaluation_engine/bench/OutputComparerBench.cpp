@@ -0,0 +1,118 @@
+// ============================================================================
+// Microbenchmark de OutputComparer
+//
+// Mide areEqual (archivos) y areEqualText (memoria) con salidas grandes:
+//  - iguales (recorre todo)
+//  - diferencia en la primera línea (debe salir de inmediato)
+//  - diferencia en la última línea
+//  - iguales salvo \r\n y blancos al final (normalización)
+//
+// No es un test: se compila y corre a mano.
+//   g++ -std=c++17 -O2 -Iinclude bench/OutputComparerBench.cpp
+//       src/OutputComparer.cpp -o comparer_bench
+//   ./comparer_bench [MB]          (por defecto 50 MB)
+// ============================================================================
+
+#include "OutputComparer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace engine;
+
+namespace {
+
+    // Texto de ~bytes con líneas "i i*7 i*13\n".
+    std::string makeOutput(std::size_t bytes) {
+        std::string text;
+        text.reserve(bytes + 64);
+        for (long i = 0; text.size() < bytes; ++i) {
+            text += std::to_string(i) + " " + std::to_string(i * 7) + " " +
+                    std::to_string(i * 13) + "\n";
+        }
+        return text;
+    }
+
+    // Mismo texto con "  \r\n" como fin de línea y líneas vacías al final.
+    std::string withWindowsNewlines(const std::string& text) {
+        std::string out;
+        out.reserve(text.size() + text.size() / 4);
+        for (char c : text) {
+            if (c == '\n') out += "  \r\n";
+            else out += c;
+        }
+        return out + "\n\n";
+    }
+
+    void writeFile(const std::filesystem::path& path, const std::string& text) {
+        std::ofstream out(path, std::ios::binary);
+        out << text;
+    }
+
+    template <class F>
+    double bestOfMs(int runs, F&& f) {
+        double best = 1e18;
+        for (int i = 0; i < runs; ++i) {
+            auto t0 = std::chrono::steady_clock::now();
+            f();
+            auto t1 = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+        }
+        return best;
+    }
+
+    void report(const char* name, std::size_t bytes, bool equal, double ms) {
+        double mbps = ms > 0 ? (bytes / (1024.0 * 1024.0)) / (ms / 1000.0) : 0;
+        std::printf("%-28s %8.2f ms  %8.1f MB/s  equal=%d\n", name, ms, mbps, equal ? 1 : 0);
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t mb = argc > 1 ? static_cast<std::size_t>(std::atol(argv[1])) : 50;
+    std::size_t bytes = mb * 1024 * 1024;
+    const int runs = 5;
+
+    std::string expected  = makeOutput(bytes);
+    std::string firstDiff = "x" + expected.substr(1);
+    std::string lastDiff  = expected.substr(0, expected.size() - 2) + "x\n";
+    std::string crlf      = withWindowsNewlines(expected);
+
+    auto dir = std::filesystem::temp_directory_path() / "comparer_bench";
+    std::filesystem::create_directories(dir);
+    writeFile(dir / "expected.txt", expected);
+    writeFile(dir / "same.txt", expected);
+    writeFile(dir / "first.txt", firstDiff);
+    writeFile(dir / "last.txt", lastDiff);
+    writeFile(dir / "crlf.txt", crlf);
+
+    std::printf("OutputComparer, %zu MB, mejor de %d\n", mb, runs);
+
+    struct Case { const char* name; const char* file; const std::string* text; };
+    const Case cases[] = {
+        {"igual",                 "same.txt",  &expected},
+        {"difiere en linea 1",    "first.txt", &firstDiff},
+        {"difiere al final",      "last.txt",  &lastDiff},
+        {"igual (\\r\\n + blancos)", "crlf.txt",  &crlf},
+    };
+
+    for (const auto& c : cases) {
+        bool eq = false;
+        double ms = bestOfMs(runs, [&] {
+            eq = OutputComparer::areEqual(dir / c.file, dir / "expected.txt");
+        });
+        report((std::string("archivo: ") + c.name).c_str(), bytes, eq, ms);
+
+        ms = bestOfMs(runs, [&] {
+            eq = OutputComparer::areEqualText(*c.text, expected);
+        });
+        report((std::string("memoria: ") + c.name).c_str(), bytes, eq, ms);
+    }
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
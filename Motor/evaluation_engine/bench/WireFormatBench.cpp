@@ -0,0 +1,119 @@
+// ============================================================================
+// Microbenchmark del formato de los bodies: JSON vs MessagePack
+//
+// Para tests de 1 KB, 1 MB y 32 MB (input y expected de ese tamaño) mide:
+//  - request: codificar el documento de la submission y decodificarlo
+//    hasta SubmissionRequest (lo que hacen el Gestor y POST /evaluate)
+//  - result: codificar un EvaluationResult cuyo runtime log tiene ese
+//    tamaño y volver a leer el documento (lo que hace el cliente)
+//
+// No es un test: se compila y corre a mano.
+//   g++ -std=c++17 -O2 -Iinclude bench/WireFormatBench.cpp
+//       src/JsonCodec.cpp -o wire_bench
+//   ./wire_bench
+// ============================================================================
+
+#include "JsonCodec.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+using json = nlohmann::json;
+using namespace engine;
+
+namespace {
+
+    // Texto de ~bytes con líneas "i i*7 i*13\n" (como un input típico).
+    std::string makeText(std::size_t bytes) {
+        std::string text;
+        text.reserve(bytes + 64);
+        for (long i = 0; text.size() < bytes; ++i) {
+            text += std::to_string(i) + " " + std::to_string(i * 7) + " " +
+                    std::to_string(i * 13) + "\n";
+        }
+        return text;
+    }
+
+    // Mejor tiempo por operación (ms) de `runs` rondas de `iterations`.
+    template <class F>
+    double bestOfMs(int runs, int iterations, F&& f) {
+        double best = 1e18;
+        for (int r = 0; r < runs; ++r) {
+            auto t0 = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i) {
+                f();
+            }
+            auto t1 = std::chrono::steady_clock::now();
+            best = std::min(best,
+                std::chrono::duration<double, std::milli>(t1 - t0).count() / iterations);
+        }
+        return best;
+    }
+
+    void report(const char* what, const char* format, std::size_t wireBytes,
+                double encodeMs, double decodeMs) {
+        std::printf("  %-8s %-8s %12zu B  encode %9.3f ms  decode %9.3f ms\n",
+                    what, format, wireBytes, encodeMs, decodeMs);
+    }
+
+    std::string toMsgpack(const json& doc) {
+        std::string bytes;
+        json::to_msgpack(doc, bytes);
+        return bytes;
+    }
+
+} // namespace
+
+int main() {
+    const std::size_t sizes[] = {1024, 1024 * 1024, 32 * 1024 * 1024};
+    const int runs = 3;
+
+    for (std::size_t size : sizes) {
+        // Documento de la submission con un test de ese tamaño
+        json request;
+        request["submission_id"] = "bench";
+        request["problem_id"]    = "bench";
+        request["language"]      = "cpp";
+        request["source_code"]   = "int main() { return 0; }\n";
+        request["time_limit_ms"] = 2000;
+        request["test_cases"] = json::array({
+            {{"id", "1"}, {"input", makeText(size)}, {"expected_output", makeText(size)}},
+        });
+
+        // Resultado con un runtime log de ese tamaño
+        EvaluationResult result;
+        result.submissionId = "bench";
+        result.overallStatus = OverallStatus::PartialAccepted;
+        TestResult t;
+        t.testId = "1";
+        t.status = TestStatus::RuntimeError;
+        t.runtimeLog = makeText(size);
+        result.tests.push_back(std::move(t));
+
+        // Más iteraciones con payloads chicos para que el reloj alcance
+        const int iterations = static_cast<int>(std::max<std::size_t>(1, (8u << 20) / size));
+        std::printf("payload %zu B (%d iteraciones, mejor de %d)\n", size, iterations, runs);
+
+        std::string text = request.dump();
+        std::string packed = toMsgpack(request);
+        SubmissionRequest sr;
+        report("request", "json", text.size(),
+               bestOfMs(runs, iterations, [&] { text = request.dump(); }),
+               bestOfMs(runs, iterations, [&] { sr = JsonCodec::parseSubmission(json::parse(text)); }));
+        report("request", "msgpack", packed.size(),
+               bestOfMs(runs, iterations, [&] { packed = toMsgpack(request); }),
+               bestOfMs(runs, iterations, [&] { sr = JsonCodec::parseSubmission(json::from_msgpack(packed)); }));
+
+        json doc;
+        text = JsonCodec::toJson(result).dump();
+        packed = toMsgpack(JsonCodec::toJson(result));
+        report("result", "json", text.size(),
+               bestOfMs(runs, iterations, [&] { text = JsonCodec::toJson(result).dump(); }),
+               bestOfMs(runs, iterations, [&] { doc = json::parse(text); }));
+        report("result", "msgpack", packed.size(),
+               bestOfMs(runs, iterations, [&] { packed = toMsgpack(JsonCodec::toJson(result)); }),
+               bestOfMs(runs, iterations, [&] { doc = json::from_msgpack(packed); }));
+    }
+    return 0;
+}
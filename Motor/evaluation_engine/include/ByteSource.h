@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <string_view>
+#include <vector>
+
+namespace engine {
+
+    // ============================================================================
+    // ByteSource
+    //
+    // Entrega un byte a la vez desde un texto en memoria (sin copiarlo) o
+    // desde un stream leído en bloques de kChunkBytes. Lo usan los
+    // comparadores de salida para recorrer archivos grandes con memoria
+    // constante.
+    // ============================================================================
+    class ByteSource {
+    public:
+        // Tamaño de cada lectura al recorrer un stream.
+        static constexpr std::size_t kChunkBytes = 64 * 1024;
+
+        explicit ByteSource(std::string_view text)
+            : pos_(text.data()), end_(text.data() + text.size()) {}
+
+        explicit ByteSource(std::istream& in)
+            : in_(&in), buffer_(kChunkBytes) {}
+
+        // Siguiente byte (0-255) o -1 al final.
+        int get() {
+            if (pos_ == end_ && !refill()) {
+                return -1;
+            }
+            return static_cast<unsigned char>(*pos_++);
+        }
+
+    private:
+        bool refill() {
+            if (!in_ || !*in_) {
+                return false;
+            }
+            in_->read(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+            std::streamsize n = in_->gcount();
+            pos_ = buffer_.data();
+            end_ = pos_ + n;
+            return n > 0;
+        }
+
+        const char* pos_{nullptr};
+        const char* end_{nullptr};
+        std::istream* in_{nullptr};
+        std::vector<char> buffer_;
+    };
+
+} // namespace engine
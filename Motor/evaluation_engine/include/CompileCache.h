@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace engine {
+
+    // Contadores del cache de compilación.
+    struct CompileCacheStats {
+        std::uint64_t hits{0};
+        std::uint64_t misses{0};
+        std::uint64_t stores{0};
+        std::uint64_t evictions{0};
+        std::uintmax_t bytes{0};    // tamaño actual en disco
+        std::size_t entries{0};
+    };
+
+    // ============================================================================
+    // CompileCache
+    //
+    // Cache "content-addressed" de artefactos de compilación:
+    //   clave = sha256(código fuente, flags, toolchain/imagen)
+    //   <cacheDir>/<clave>/main         binario (solo si compiló bien)
+    //   <cacheDir>/<clave>/compile.log  log del compilador
+    //   <cacheDir>/<clave>/exit_code    código de salida del compilador
+    //
+    // Se comparte entre submissions (y sobrevive reinicios: el índice se
+    // reconstruye leyendo la carpeta). Si el tamaño total supera maxBytes se
+    // expulsan las entradas usadas hace más tiempo (LRU).
+    //
+    // El mutex solo protege el índice: las copias de archivos se hacen
+    // fuera de él. Una entrada que se está copiando queda "fijada" y, si la
+    // expulsan mientras tanto, su carpeta se borra al soltarla.
+    // ============================================================================
+    class CompileCache {
+    public:
+        CompileCache(std::filesystem::path cacheDir, std::uintmax_t maxBytes);
+
+        // Calcula la clave del artefacto.
+        static std::string makeKey(const std::string& sourceCode,
+                                   const std::string& flags,
+                                   const std::string& toolchainId);
+
+        // Si la clave existe, copia main y compile.log a submissionDir y
+        // devuelve el código de salida guardado. Si no, std::nullopt.
+        std::optional<int> restore(const std::string& key,
+                                   const std::filesystem::path& submissionDir);
+
+        // Guarda el resultado de compilar en submissionDir bajo la clave.
+        void store(const std::string& key,
+                   const std::filesystem::path& submissionDir,
+                   int exitCode);
+
+        CompileCacheStats stats() const;
+
+    private:
+        struct Entry {
+            std::uintmax_t bytes{0};
+            std::list<std::string>::iterator lruPos; // posición en lru_
+        };
+
+        using Trash = std::vector<std::filesystem::path>;
+
+        // Con mutex_ tomado. Las carpetas a borrar se mueven a nombres
+        // temporales y se agregan a `trash`, que se vacía sin el lock.
+        void loadIndex();
+        void touch(Entry& entry, const std::string& key);
+        void evictIfNeeded(Trash& trash);
+        void discard(const std::string& key, Trash& trash);
+        void unpin(const std::string& key, Trash& trash);
+        static void emptyTrash(const Trash& trash);
+
+        std::filesystem::path cacheDir_;
+        std::uintmax_t maxBytes_;
+
+        mutable std::mutex mutex_;
+        std::unordered_map<std::string, Entry> index_;
+        std::list<std::string> lru_; // frente = más reciente
+        std::unordered_map<std::string, int> pins_;  // restores en curso por clave
+        std::unordered_set<std::string> doomed_;     // expulsadas aún fijadas
+        CompileCacheStats stats_;
+    };
+
+} // namespace engine
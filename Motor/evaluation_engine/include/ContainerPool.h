@@ -0,0 +1,130 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace engine {
+
+    // Configuración del pool de contenedores "calientes".
+    struct ContainerPoolConfig {
+        std::size_t size{4};            // contenedores pre-iniciados
+        int memoryLimitMb{512};         // límite de memoria de cada contenedor
+        double cpuLimit{1.0};           // CPUs asignadas a cada contenedor
+        int pidsLimit{64};              // límite de procesos (evita fork-bombs)
+        int maxLeasesPerContainer{50};  // reciclar tras N usos (0 = nunca)
+        bool recycleOnTimeout{true};    // reciclar si la submission tuvo un TLE
+    };
+
+    // Contadores expuestos por el pool.
+    struct ContainerPoolStats {
+        std::uint64_t leases{0};       // préstamos entregados
+        std::uint64_t waits{0};        // préstamos que tuvieron que esperar
+        std::uint64_t totalWaitMs{0};  // tiempo total esperando un contenedor
+        std::uint64_t resets{0};       // limpiezas entre submissions
+        std::uint64_t recycles{0};     // contenedores destruidos y recreados
+        std::uint64_t repairs{0};      // slots rotos recreados con éxito en acquire
+        std::uint64_t repairFailures{0}; // intentos de recrear un slot roto que fallaron
+        std::size_t broken{0};         // slots sin contenedor en este momento
+        std::size_t idle{0};           // contenedores libres en este momento
+        std::size_t busy{0};           // contenedores prestados en este momento
+    };
+
+    // ============================================================================
+    // ContainerPool
+    //
+    // Mantiene N contenedores ya iniciados (sin red y con límites de recursos)
+    // para evitar el costo de `docker run --rm` en cada paso:
+    //  - cada contenedor monta su propia carpeta host en /workspace
+    //  - el motor "presta" un contenedor por submission y ejecuta con `docker exec`
+    //  - al devolverlo se limpia (procesos del usuario runner y /workspace)
+    //  - tras maxLeasesPerContainer usos, o si algo falla, se recicla
+    //  - si el contenedor no se puede recrear, el slot queda "roto": no se
+    //    presta y acquire vuelve a intentar recrearlo cuando no hay otro libre
+    // ============================================================================
+    class ContainerPool {
+    public:
+        // Punto de montaje de la carpeta del slot dentro del contenedor.
+        static constexpr const char* kMountPoint = "/workspace";
+
+        // Préstamo RAII de un contenedor: se devuelve al pool al destruirse.
+        class Lease {
+        public:
+            Lease(Lease&& other) noexcept;
+            Lease& operator=(Lease&& other) noexcept;
+            Lease(const Lease&) = delete;
+            Lease& operator=(const Lease&) = delete;
+            ~Lease();
+
+            // Nombre del contenedor (para `docker exec`).
+            const std::string& containerName() const;
+
+            // Carpeta del host montada en /workspace de este contenedor.
+            const std::filesystem::path& hostDir() const;
+
+            // Fuerza el reciclaje del contenedor al devolverlo.
+            void markDirty();
+
+        private:
+            friend class ContainerPool;
+            Lease(ContainerPool* pool, std::size_t slot);
+
+            ContainerPool* pool_{nullptr};
+            std::size_t slot_{0};
+            bool dirty_{false};
+        };
+
+        // imageName: imagen Docker de los contenedores
+        // hostBaseDir: carpeta host bajo la que se crea una subcarpeta por slot
+        ContainerPool(std::string imageName,
+                      std::filesystem::path hostBaseDir,
+                      ContainerPoolConfig config);
+        ~ContainerPool();
+
+        ContainerPool(const ContainerPool&) = delete;
+        ContainerPool& operator=(const ContainerPool&) = delete;
+
+        // Inicia todos los contenedores del pool.
+        void start();
+
+        // Presta un contenedor libre; bloquea si todos están ocupados.
+        // Lanza std::runtime_error si todos los slots están rotos y no se
+        // pudo recrear ninguno.
+        Lease acquire();
+
+        ContainerPoolStats stats() const;
+
+        const ContainerPoolConfig& config() const { return config_; }
+
+    private:
+        struct Slot {
+            std::string name;              // nombre del contenedor
+            std::filesystem::path hostDir; // carpeta montada en /workspace
+            int leaseCount{0};             // usos desde el último reciclaje
+            bool busy{false};
+            bool broken{false};            // el contenedor no existe (falló el reciclaje)
+        };
+
+        void release(std::size_t slot, bool dirty);
+
+        // remove + start + reset. false si el contenedor no quedó andando.
+        bool recreateContainer(const Slot& slot) const;
+        bool startContainer(const Slot& slot) const;
+        bool resetContainer(const Slot& slot) const;
+        void removeContainer(const Slot& slot) const;
+
+        std::string imageName_;
+        std::filesystem::path hostBaseDir_;
+        ContainerPoolConfig config_;
+
+        std::vector<Slot> slots_;
+        mutable std::mutex mutex_;
+        std::condition_variable available_;
+        ContainerPoolStats stats_;
+    };
+
+} // namespace engine
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "CompileCache.h"
+#include "Models.h"
+#include "SandboxRunner.h"
+
+#include <filesystem>
+#include <string>
+
+namespace engine {
+
+    // Veredicto de un checker propio sobre un test.
+    struct CheckerVerdict {
+        bool accepted{false};
+        bool failed{false};    // el checker no respondió 0/1 (error del problema)
+        std::string message;   // stdout + stderr del checker (recortado)
+    };
+
+    // ============================================================================
+    // CustomChecker
+    //
+    // Checker escrito por el autor del problema. Se compila con el mismo
+    // backend de sandbox que la submission (y pasa por el CompileCache: mismo
+    // código de checker = mismo binario) y se ejecuta, también en el sandbox,
+    // una vez por test.
+    //
+    // Nada de esto vive en la carpeta de la submission, que el programa del
+    // usuario puede escribir: el binario se publica en <checkerRoot>/<clave>
+    // (copia del motor, solo lectura) y cada ejecución usa una carpeta nueva
+    // con su propia copia del binario, del input, del expected y de la
+    // salida. El runner no debe ser el del contenedor prestado a la
+    // submission (en Docker cada check es un `docker run` aparte).
+    //
+    // Protocolo del checker:
+    //  - corre en una carpeta propia con input.txt, expected.txt y output.txt
+    //    (output.txt es la salida del programa y también llega por stdin)
+    //  - exit 0 = Accepted, exit 1 = WrongAnswer
+    //  - cualquier otro código, un crash o exceder el tiempo = error del
+    //    checker (el test queda InternalError)
+    //  - lo que escriba en stdout/stderr se agrega al runtime log del test
+    // ============================================================================
+    class CustomChecker {
+    public:
+        // checkerRoot: carpeta del motor, fuera de toda submission.
+        CustomChecker(const SandboxRunner& runner, std::filesystem::path checkerRoot);
+
+        // Compila `source` (o lo restaura del cache). Devuelve false si no
+        // compiló; el log del compilador queda en compileLog.
+        bool build(const std::string& source,
+                   CompileCache* cache,
+                   std::string& compileLog);
+
+        // Ejecuta el checker sobre un test. outputFile es la salida del
+        // programa. Se puede llamar en paralelo para tests distintos.
+        CheckerVerdict check(const TestCase& tc,
+                             const std::filesystem::path& outputFile) const;
+
+        // Borra las carpetas de compilación/ejecución que dejó un corte.
+        static void sweep(const std::filesystem::path& checkerRoot);
+
+    private:
+        std::filesystem::path freshDir(const std::string& tag) const;
+
+        const SandboxRunner& runner_;
+        std::filesystem::path root_;
+        std::filesystem::path binary_; // <root>/<clave>/main tras build()
+    };
+
+} // namespace engine
@@ -1,39 +1,13 @@
 #pragma once
 
+#include "SandboxRunner.h"
+
 #include <filesystem>
 #include <string>
+#include <vector>
 
 namespace engine {
 
-    // Resultado de la compilación dentro del contenedor Docker.
-    // Se almacena:
-    // - exitCode: código devuelto por el compilador (0 = éxito)
-    // - logFilePath: ruta local (host) al archivo compile.log generado
-    struct CompileResult {
-        int exitCode{0};
-        std::string logFilePath;
-    };
-
-    // Resultado de la ejecución de un solo test.
-    // - exitCode: código de retorno del programa
-    // - timedOut: true si excedió el límite de tiempo
-    // - runtimeLogPath: ruta al log generado (stderr / info)
-    // - outputPath: salida real generada por el programa para el test
-    struct RunResult {
-        int exitCode{0};
-        bool timedOut{false};
-        std::string runtimeLogPath;
-        std::string outputPath;
-    };
-
-    // Límites de seguridad/recursos para la ejecución dentro de Docker.
-    struct RunLimits {
-        int timeLimitSeconds{2};   // límite de tiempo por test
-        int memoryLimitMb{256};    // límite de memoria
-        double cpuLimit{1.0};      // CPUs asignadas (1.0 = una CPU completa)
-        int pidsLimit{64};         // límite de procesos (evita fork-bombs)
-    };
-
     // ============================================================================
     // DockerRunner
     //
@@ -41,37 +15,79 @@ namespace engine {
     //  - ejecutar compilación dentro del contenedor
     //  - ejecutar un test individual con límites
     //  - montar volúmenes para compartir archivos host <-> contenedor
+    //
+    // Por defecto cada paso es un `docker run --rm` nuevo. Con useContainer()
+    // los pasos se ejecutan con `docker exec` dentro de un contenedor del
+    // ContainerPool, que ya está iniciado y tiene sus propios límites.
     // ============================================================================
-    class DockerRunner {
+    class DockerRunner : public SandboxRunner {
     public:
         explicit DockerRunner(std::string imageName);
 
+        // Activa el modo pool:
+        // - containerName: contenedor prestado por ContainerPool
+        // - hostMountDir: carpeta host montada en /workspace de ese contenedor
+        //   (submissionDir debe estar dentro de ella)
+        void useContainer(std::string containerName,
+                          std::filesystem::path hostMountDir);
+
+        // Digest de la imagen (`docker image inspect`), calculado una vez por imagen.
+        std::string toolchainId() const override;
+
         // Compila el archivo fuente dentro del contenedor Docker.
         // submissionDir: carpeta donde está submission.cpp
         // sourceFileName: nombre del archivo del usuario (ej: "solution.cpp")
         CompileResult compile(
             const std::filesystem::path& submissionDir,
-            const std::string& sourceFileName) const;
+            const std::string& sourceFileName) const override;
 
         // Ejecuta un test:
         // - inputFileName: input_1.txt
         // - outputFileName: output_1.txt (salida generada)
         // - runtimeLogName: stderr/log
-        // - timeLimitSeconds: límite individual para el test
+        // - limits: CPU/tiempo real en ms, memoria, pids
         RunResult runSingleTest(
             const std::filesystem::path& submissionDir,
             const std::string& inputFileName,
             const std::string& outputFileName,
             const std::string& runtimeLogName,
-            int timeLimitSeconds,
-            const RunLimits& limits = RunLimits{}) const;
+            const RunLimits& limits = RunLimits{}) const override;
+
+        // stdin/stdout por pipes a `docker exec -i` (o `docker run -i`):
+        // judge-driver --stdio deja el programa conectado a los del contenedor.
+        RunResult runInMemory(
+            const std::filesystem::path& submissionDir,
+            const std::string& input,
+            std::size_t maxOutputBytes,
+            const RunLimits& limits = RunLimits{}) const override;
+
+        // Ejecuta todos los tests en UNA sola invocación del contenedor
+        // usando judge-driver (instalado en la imagen). Cada test corre con
+        // su propio timeout y rlimits; el driver escribe un registro por test
+        // en su stderr y aquí se convierte en un RunResult por id, en el
+        // mismo orden.
+        // Con jobs > 1 el driver corre varios tests a la vez y el contenedor
+        // recibe jobs × (CPU, memoria) de los límites por test.
+        std::vector<RunResult> runBatch(
+            const std::filesystem::path& submissionDir,
+            const std::vector<std::string>& testIds,
+            const RunLimits& limits = RunLimits{},
+            int jobs = 1,
+            FailurePolicy stopOn = FailurePolicy::RunAll) const override;
 
     private:
         std::string imageName_;  // nombre de la imagen Docker usada
 
+        std::string containerName_;          // vacío = `docker run --rm` por paso
+        std::filesystem::path hostMountDir_; // carpeta host montada (modo pool)
+
         // Construye el argumento `-v /host:/container` para montar el volumen.
         std::string buildVolumeArgument(
             const std::filesystem::path& submissionDir) const;
+
+        // Carpeta de trabajo dentro del contenedor para esta submission.
+        std::string containerWorkdir(
+            const std::filesystem::path& submissionDir) const;
     };
 
 } // namespace engine
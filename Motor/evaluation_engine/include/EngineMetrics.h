@@ -0,0 +1,132 @@
+#pragma once
+
+#include "Models.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace engine {
+
+    // Fases de una evaluación con latencia propia en /metrics.
+    enum class MetricsPhase {
+        FileWrite,   // main.cpp + inputs en la carpeta de la submission
+        Lease,       // espera de un contenedor del pool
+        Compile,     // compilación (o restauración desde el cache)
+        Spawn,       // costo del sandbox por ejecución (llamada - tiempo del programa)
+        Run,         // tiempo real del programa
+        Compare,     // checker / comparación de la salida
+        Evaluation,  // evaluate() completo
+        Count_
+    };
+
+    // ============================================================================
+    // LatencyHistogram
+    //
+    // Histograma de latencias con buckets fijos (segundos, como Prometheus).
+    // Solo contadores atómicos relajados: registrar es un par de fetch_add,
+    // sin locks, desde cualquier hilo.
+    // ============================================================================
+    class LatencyHistogram {
+    public:
+        static constexpr std::array<double, 13> kBoundsSeconds{
+            0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1,
+            0.25, 0.5, 1.0, 2.5, 5.0, 10.0};
+
+        void observe(std::chrono::microseconds duration);
+
+        // Líneas _bucket / _sum / _count con las etiquetas dadas
+        // (p. ej. `phase="compile"`; vacío = sin etiquetas).
+        void render(std::string& out, const std::string& name,
+                    const std::string& labels) const;
+
+    private:
+        std::array<std::atomic<std::uint64_t>, kBoundsSeconds.size() + 1> buckets_{}; // último = +Inf
+        std::atomic<std::uint64_t> sumMicros_{0};
+        std::atomic<std::uint64_t> count_{0};
+    };
+
+    // ============================================================================
+    // EngineMetrics
+    //
+    // Instrumentación del motor para GET /metrics (formato de texto de
+    // Prometheus): latencia por fase, evaluaciones en curso y veredictos por
+    // estado. Los contadores de caches, cola y pool no se duplican aquí: el
+    // servidor los agrega desde sus stats() con appendCounter/appendGauge.
+    // ============================================================================
+    class EngineMetrics {
+    public:
+        void observe(MetricsPhase phase, std::chrono::microseconds duration);
+
+        void evaluationStarted();
+        void evaluationFinished(OverallStatus status, bool cached);
+        void testFinished(TestStatus status);
+
+        // Texto de las métricas propias (histogramas, en curso, veredictos).
+        std::string render() const;
+
+        // Una métrica suelta con su HELP y TYPE.
+        static void appendCounter(std::string& out, const std::string& name,
+                                  const std::string& help, double value);
+        static void appendGauge(std::string& out, const std::string& name,
+                                const std::string& help, double value);
+
+        // Una métrica con varias series: cada muestra es (etiquetas, valor),
+        // p. ej. {`lane="graded"`, 3}. type = "counter" | "gauge".
+        static void appendFamily(std::string& out, const std::string& name,
+                                 const char* type, const std::string& help,
+                                 const std::vector<std::pair<std::string, double>>& samples);
+
+    private:
+        static constexpr std::size_t kPhases = static_cast<std::size_t>(MetricsPhase::Count_);
+        static constexpr std::size_t kOverallStatuses = 4;
+        static constexpr std::size_t kTestStatuses = 7;
+
+        std::array<LatencyHistogram, kPhases> phases_;
+        std::atomic<std::int64_t> inFlight_{0};
+        std::atomic<std::uint64_t> cachedEvaluations_{0};
+        std::array<std::atomic<std::uint64_t>, kOverallStatuses> evaluations_{};
+        std::array<std::atomic<std::uint64_t>, kTestStatuses> tests_{};
+    };
+
+    // ============================================================================
+    // PhaseTimer
+    //
+    // Mide desde la construcción hasta stop() (o el destructor) y lo registra
+    // en la fase. Con metrics == nullptr no hace nada.
+    // ============================================================================
+    class PhaseTimer {
+    public:
+        PhaseTimer(EngineMetrics* metrics, MetricsPhase phase)
+            : metrics_(metrics), phase_(phase),
+              start_(metrics ? std::chrono::steady_clock::now()
+                             : std::chrono::steady_clock::time_point{}) {}
+
+        ~PhaseTimer() { stop(); }
+
+        PhaseTimer(const PhaseTimer&) = delete;
+        PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+        // Registra la duración (una sola vez) y la devuelve.
+        std::chrono::microseconds stop() {
+            if (!metrics_) {
+                return std::chrono::microseconds{0};
+            }
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start_);
+            metrics_->observe(phase_, elapsed);
+            metrics_ = nullptr;
+            return elapsed;
+        }
+
+    private:
+        EngineMetrics* metrics_;
+        MetricsPhase phase_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+} // namespace engine
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Models.h"
+
+#include <cstddef>
+#include <string>
+
+namespace engine {
+
+    // Tipos de evento que produce una evaluación en curso.
+    enum class EvaluationEventType {
+        Compiled,      // terminó la compilación (ok o error)
+        TestFinished,  // un test ya tiene veredicto
+        Finished       // resumen final de la submission
+    };
+
+    // Un evento de progreso. Solo se usan los campos de su tipo.
+    struct EvaluationEvent {
+        EvaluationEventType type{EvaluationEventType::Finished};
+        std::size_t sequence{0};     // 0, 1, 2... dentro del job
+
+        // Compiled
+        bool compileOk{false};
+        std::string compileLog;
+
+        // TestFinished
+        std::size_t testIndex{0};    // posición en request.testCases
+        TestResult test;
+
+        // Finished (el resultado sin la lista de tests)
+        EvaluationResult summary;
+        std::size_t testCount{0};
+        std::size_t acceptedCount{0};
+    };
+
+    // ============================================================================
+    // EvaluationObserver
+    //
+    // Recibe el progreso de EvaluationService::evaluate a medida que ocurre.
+    // onTestFinished se llama desde los hilos que ejecutan los tests (en
+    // paralelo si la submission lo está), así que la implementación debe ser
+    // thread-safe. El orden de los tests es el de finalización, no el del
+    // request; testIndex indica la posición original.
+    // ============================================================================
+    class EvaluationObserver {
+    public:
+        virtual ~EvaluationObserver() = default;
+
+        virtual void onCompiled(bool success, const std::string& compileLog) = 0;
+        virtual void onTestFinished(std::size_t index, const TestResult& test) = 0;
+    };
+
+} // namespace engine
@@ -1,11 +1,29 @@
 #pragma once
 
 #include "Models.h"
+#include "CompileCache.h"
+#include "EngineMetrics.h"
+#include "EvaluationObserver.h"
+#include "ContainerPool.h"
+#include "NativeSandboxRunner.h"
+#include "RunSessionStore.h"
+#include "ThreadPool.h"
+#include "VerdictCache.h"
+#include "WorkdirManager.h"
 #include <filesystem>
+#include <memory>
 #include <string>
 
 namespace engine {
 
+    class DockerRunner;
+
+    // Backend que compila y ejecuta el código del usuario.
+    enum class SandboxBackend {
+        Docker,  // docker run / docker exec (por defecto, portable)
+        Native   // fork + namespaces + cgroup v2 + seccomp (solo Linux)
+    };
+
     // ========================================================================
     // EvaluationService
     //
@@ -15,6 +33,7 @@ namespace engine {
     //  - escritura de archivos (código, inputs)
     //  - compilación con DockerRunner
     //  - ejecución de todos los test cases
+    //  - verificación de cada salida con el checker del problema
     //  - armado del EvaluationResult final
     // ========================================================================
     class EvaluationService {
@@ -28,11 +47,90 @@ namespace engine {
         // - compila
         // - corre todos los test cases
         // - arma el resultado global
-        EvaluationResult evaluate(const SubmissionRequest& request);
+        // Si se pasa un observer, recibe la compilación y cada veredicto en
+        // cuanto se conocen (antes de que termine la submission).
+        EvaluationResult evaluate(const SubmissionRequest& request,
+                                  EvaluationObserver* observer = nullptr);
+
+        // Ejecuta el código con un stdin, sin juez (POST /run). El binario
+        // se guarda en la sesión y se reutiliza mientras la fuente no cambie.
+        // Lanza std::runtime_error si no hay sesiones configuradas.
+        RunOutcome run(const RunRequest& request);
+
+        // Descarta una sesión de /run. false si no existe (o no hay sesiones).
+        bool endRunSession(const std::string& sessionId);
+
+        // Usa un pool de contenedores calientes en vez de `docker run --rm`.
+        // Cada submission toma un contenedor prestado durante toda su evaluación.
+        void setContainerPool(std::shared_ptr<ContainerPool> pool);
+
+        // Modo batch por defecto: todos los tests de una submission en una
+        // sola invocación del contenedor (judge-driver). Cada request puede
+        // sobrescribirlo con SubmissionRequest::batchMode.
+        void setBatchMode(bool enabled);
+
+        // I/O en memoria por defecto: stdin por pipe y stdout capturado y
+        // comparado sin escribir input/expected/output en disco. Cada
+        // request puede sobrescribirlo con SubmissionRequest::inMemoryIo.
+        void setInMemoryIo(bool enabled);
+
+        // Ejecuta los tests de cada submission en paralelo sobre un pool de
+        // hilos compartido por todo el motor. defaultParallelism es el máximo
+        // de tests simultáneos por submission cuando el request no indica
+        // SubmissionRequest::parallelism (siempre acotado por pool->size()).
+        // Con un contenedor del pool prestado se acota además a lo que
+        // entra en él: floor(cpuLimit) tests, y no más de los que suman
+        // su memoryLimitMb y su pidsLimit con los límites de cada test
+        // (con la configuración por defecto, 1). Vale también para --jobs
+        // del modo batch.
+        void setTestParallelism(std::shared_ptr<ThreadPool> pool,
+                                int defaultParallelism);
+
+        // Selecciona el backend de sandbox. El pool de contenedores solo se
+        // usa con SandboxBackend::Docker.
+        void setBackend(SandboxBackend backend,
+                        NativeSandboxConfig nativeConfig = NativeSandboxConfig{});
+
+        // Reutiliza binarios ya compilados (clave: código + flags + toolchain).
+        void setCompileCache(std::shared_ptr<CompileCache> cache);
+
+        // Carpetas de trabajo con nombre único que se borran (o conservan
+        // para depurar) al terminar cada submission. Sin manager se usa
+        // baseDir/<submissionId> y la carpeta queda en disco.
+        void setWorkdirManager(std::shared_ptr<WorkdirManager> workdirs);
+
+        // Devuelve el resultado guardado cuando llega la misma submission
+        // (fuente, tests, límites, checker y toolchain) sin ejecutar nada.
+        // SubmissionRequest::bypassVerdictCache fuerza la evaluación (rejudge).
+        void setVerdictCache(std::shared_ptr<VerdictCache> cache);
+
+        // Latencia por fase, evaluaciones en curso y veredictos para /metrics.
+        void setMetrics(std::shared_ptr<EngineMetrics> metrics);
+
+        // Sesiones de POST /run (binarios compilados por sesión).
+        void setRunSessions(std::shared_ptr<RunSessionStore> sessions);
 
     private:
+        std::unique_ptr<SandboxRunner> makeRunner(DockerRunner** docker) const;
+        CompileResult compileWithCache(const SandboxRunner& runner,
+                                       const std::filesystem::path& dir,
+                                       const std::string& sourceCode) const;
+
         std::filesystem::path baseDir_; // carpeta base para submissions
         std::string dockerImage_;       // imagen Docker seleccionada
+        std::filesystem::path checkerDir_; // checkers compilados (baseDir/checkers)
+        std::shared_ptr<ContainerPool> pool_; // opcional (nullptr = sin pool)
+        bool batchMode_{false};
+        bool inMemoryIo_{false};
+        std::shared_ptr<ThreadPool> testPool_; // nullptr = tests secuenciales
+        int parallelism_{1};
+        SandboxBackend backend_{SandboxBackend::Docker};
+        NativeSandboxConfig nativeConfig_;
+        std::shared_ptr<CompileCache> compileCache_; // nullptr = sin cache
+        std::shared_ptr<WorkdirManager> workdirs_;   // nullptr = carpetas permanentes
+        std::shared_ptr<VerdictCache> verdictCache_; // nullptr = sin cache
+        std::shared_ptr<RunSessionStore> runSessions_; // nullptr = /run desactivado
+        std::shared_ptr<EngineMetrics> metrics_;       // nullptr = sin métricas
     };
 
 } // namespace engine
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace engine {
+
+    // ============================================================================
+    // Sha256
+    //
+    // SHA-256 incremental, sin dependencias externas. Se usa para las claves
+    // "content-addressed" de los caches del motor (compilación, tests, etc.).
+    // ============================================================================
+    class Sha256 {
+    public:
+        Sha256();
+
+        // Agrega bytes al hash.
+        Sha256& update(std::string_view data);
+
+        // Agrega un campo con su longitud delante, para que ("ab","c") y
+        // ("a","bc") no produzcan el mismo hash.
+        Sha256& updateField(std::string_view field);
+
+        // Cierra el hash y devuelve los 64 caracteres hex.
+        std::string hexDigest();
+
+    private:
+        void processBlock(const std::uint8_t* block);
+
+        std::array<std::uint32_t, 8> state_;
+        std::array<std::uint8_t, 64> buffer_{};
+        std::size_t bufferLen_{0};
+        std::uint64_t totalLen_{0};
+    };
+
+    // Atajo: hash hex de un solo bloque de datos.
+    std::string sha256Hex(std::string_view data);
+
+} // namespace engine
@@ -0,0 +1,210 @@
+#pragma once
+
+#include "EvaluationObserver.h"
+#include "Models.h"
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace engine {
+
+    // Configuración de la cola de evaluaciones.
+    struct JobQueueConfig {
+        std::size_t workers{2};        // evaluaciones simultáneas
+        std::size_t capacity{64};      // jobs en espera como máximo (todos los carriles)
+        std::size_t maxQueuedPerClient{16}; // jobs en espera de un cliente en un carril (0 = sin tope)
+        // Peso de cada carril (Interactive, Graded, Rejudge): con los tres
+        // ocupados, de cada 13 jobs iniciados 8 son interactivos, 4
+        // calificados y 1 rejudge
+        std::array<unsigned, kLaneCount> laneWeights{{8, 4, 1}};
+        int retentionSeconds{600};     // cuánto se guarda un resultado ya leído o no
+        std::size_t maxRetained{1000}; // resultados terminados guardados como máximo
+    };
+
+    enum class JobState {
+        Queued,
+        Running,
+        Done
+    };
+
+    // Foto del estado de un job.
+    struct JobSnapshot {
+        std::string id;
+        JobState state{JobState::Queued};
+        Lane lane{Lane::Graded};
+        std::size_t queuePosition{0};  // 1 = siguiente (solo en Queued; con los jobs de ahora)
+        std::int64_t queuedMs{0};      // espera en la cola (hasta ahora o total)
+        std::int64_t runMs{0};         // duración de la evaluación
+        std::optional<EvaluationResult> result; // solo en Done
+    };
+
+    // Eventos de progreso de un job a partir de un cursor.
+    struct JobEvents {
+        std::vector<EvaluationEvent> events;
+        std::size_t nextCursor{0};     // cursor para la siguiente consulta
+        bool done{false};              // ya se emitió el evento Finished
+    };
+
+    // Contadores de un carril.
+    struct LaneStats {
+        unsigned weight{1};
+        std::size_t depth{0};          // jobs esperando
+        std::size_t clients{0};        // clientes con jobs esperando
+        std::uint64_t submitted{0};
+        std::uint64_t rejected{0};     // cola llena o tope del cliente
+        std::uint64_t started{0};
+        std::uint64_t totalWaitMs{0};  // suma de esperas (jobs ya iniciados)
+        std::uint64_t maxWaitMs{0};
+    };
+
+    // Contadores de la cola.
+    struct JobQueueStats {
+        std::size_t depth{0};          // jobs esperando
+        std::size_t running{0};        // jobs en ejecución
+        std::size_t capacity{0};
+        std::size_t workers{0};
+        std::uint64_t submitted{0};
+        std::uint64_t rejected{0};     // rechazados por cola llena
+        std::uint64_t completed{0};
+        std::uint64_t totalWaitMs{0};  // suma de esperas en cola (jobs ya iniciados)
+        std::uint64_t maxWaitMs{0};
+        std::uint64_t totalRunMs{0};
+        std::array<LaneStats, kLaneCount> lanes;
+    };
+
+    // ============================================================================
+    // JobQueue
+    //
+    // Cola acotada de evaluaciones atendida por hilos propios. Los hilos de
+    // Crow solo encolan y consultan: una ráfaga de submissions espera aquí en
+    // lugar de ocupar a todos los hilos HTTP.
+    //  - submit(): encola y devuelve el id del job (o nada si la cola está llena)
+    //  - status() / waitFor(): consulta, opcionalmente esperando a que termine
+    //  - events(): progreso del job (compilación, cada test, resumen)
+    //  - evaluate(): encola y espera el resultado (POST /evaluate síncrono)
+    //  - execute(): corre una tarea cualquiera con la prioridad de un carril
+    //    (POST /run)
+    //
+    // Planificación: cada job va a un carril (Lane) y, dentro del carril, a
+    // la fila de su cliente. Entre carriles, stride scheduling con los pesos
+    // de la configuración (un carril vacío no acumula crédito); dentro de un
+    // carril, turno rotativo entre clientes, así que un cliente con muchos
+    // jobs no demora a los demás más de un job por turno.
+    // ============================================================================
+    class JobQueue {
+    public:
+        // El observer es nullptr cuando nadie puede consultar el progreso.
+        using Handler = std::function<EvaluationResult(const SubmissionRequest&,
+                                                       EvaluationObserver*)>;
+
+        JobQueue(Handler handler, JobQueueConfig config = JobQueueConfig{});
+        ~JobQueue();
+
+        JobQueue(const JobQueue&) = delete;
+        JobQueue& operator=(const JobQueue&) = delete;
+
+        // Encola la submission. std::nullopt = cola llena.
+        std::optional<std::string> submit(SubmissionRequest request);
+
+        // Estado actual del job. std::nullopt = id desconocido o ya expirado.
+        std::optional<JobSnapshot> status(const std::string& id) const;
+
+        // Como status(), pero espera hasta timeoutMs a que el job termine.
+        std::optional<JobSnapshot> waitFor(const std::string& id, int timeoutMs) const;
+
+        // Eventos con sequence >= cursor. Si no hay ninguno nuevo espera hasta
+        // timeoutMs a que llegue alguno. std::nullopt = id desconocido.
+        std::optional<JobEvents> events(const std::string& id,
+                                        std::size_t cursor,
+                                        int timeoutMs) const;
+
+        // Encola y espera el resultado sin registrarlo para consultas.
+        // std::nullopt = cola llena.
+        std::optional<EvaluationResult> evaluate(SubmissionRequest request);
+
+        // Encola task en el carril y espera a que un worker la ejecute.
+        // false = cola llena. Una excepción de task se relanza aquí.
+        bool execute(Lane lane, const std::string& clientKey, std::function<void()> task);
+
+        JobQueueStats stats() const;
+
+        const JobQueueConfig& config() const { return config_; }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Job {
+            std::string id;
+            SubmissionRequest request;
+            Lane lane{Lane::Graded};
+            std::string clientKey;
+            std::function<void()> task; // execute(): se corre esto en lugar del handler
+            std::exception_ptr taskError;
+            JobState state{JobState::Queued};
+            Clock::time_point enqueuedAt;
+            Clock::time_point startedAt;
+            Clock::time_point finishedAt;
+            EvaluationResult result;
+            std::vector<EvaluationEvent> events;
+            bool retained{true};      // visible por id (false = evaluate())
+        };
+
+        // Observer de un job: guarda los eventos y despierta a quien espera.
+        class JobObserver : public EvaluationObserver {
+        public:
+            JobObserver(JobQueue& queue, Job& job) : queue_(queue), job_(job) {}
+            void onCompiled(bool success, const std::string& compileLog) override;
+            void onTestFinished(std::size_t index, const TestResult& test) override;
+        private:
+            JobQueue& queue_;
+            Job& job_;
+        };
+
+        // Jobs en espera de un carril: una fila por cliente y el turno
+        // rotativo entre los clientes que tienen alguno.
+        struct LaneQueue {
+            std::unordered_map<std::string, std::deque<std::shared_ptr<Job>>> byClient;
+            std::deque<std::string> rotation; // frente = próximo cliente
+            std::size_t depth{0};
+            std::uint64_t pass{0};            // tiempo virtual del stride scheduling
+        };
+
+        void pushEvent(Job& job, EvaluationEvent event); // con mutex_ tomado
+        bool enqueue(const std::shared_ptr<Job>& job);
+        std::shared_ptr<Job> popNext();  // con mutex_ tomado y queued_ > 0
+        std::uint64_t stride(std::size_t lane) const;
+        std::size_t positionOf(const Job& job) const; // con mutex_ tomado
+        bool waitDone(const std::shared_ptr<Job>& job);
+        void workerLoop();
+        void purgeExpired();          // con mutex_ tomado
+        JobSnapshot snapshot(const Job& job) const; // con mutex_ tomado
+
+        Handler handler_;
+        JobQueueConfig config_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable workAvailable_;
+        mutable std::condition_variable jobUpdated_;  // cambio de estado o evento nuevo
+        std::array<LaneQueue, kLaneCount> lanes_;
+        std::size_t queued_{0};              // suma de depth de los carriles
+        std::uint64_t globalPass_{0};        // pass del último carril atendido
+        std::unordered_map<std::string, std::shared_ptr<Job>> jobs_;
+        std::deque<std::string> finishedOrder_; // para la retención
+        JobQueueStats stats_;
+        bool stopping_{false};
+        std::vector<std::thread> workers_;
+    };
+
+} // namespace engine
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "EvaluationObserver.h"
+#include "Models.h"
+
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+namespace engine {
+
+    // ============================================================================
+    // JsonCodec
+    //
+    // Conversión entre el JSON de la API REST y los modelos del motor. La
+    // usan tanto POST /evaluate como la cola de jobs, así el formato de
+    // request/respuesta es uno solo.
+    // ============================================================================
+    class JsonCodec {
+    public:
+        // Body de POST /evaluate (o /jobs) → SubmissionRequest.
+        // Lanza nlohmann::json::exception si falta un campo obligatorio o
+        // std::invalid_argument si un valor no es válido.
+        static SubmissionRequest parseSubmission(const nlohmann::json& body);
+
+        // Body de POST /run → RunRequest. Lanza nlohmann::json::exception
+        // si falta un campo obligatorio.
+        static RunRequest parseRun(const nlohmann::json& body);
+
+        // [{"id", "input", "expected_output"}, ...] → TestCase.
+        static std::vector<TestCase> parseTestCases(const nlohmann::json& list);
+
+        // EvaluationResult → JSON de respuesta.
+        static nlohmann::json toJson(const EvaluationResult& result);
+        static nlohmann::json toJson(const TestResult& test);
+        static nlohmann::json toJson(const RunOutcome& outcome);
+
+        // Desglose de tiempos ("timing": true en el request).
+        static nlohmann::json toJson(const EvaluationTiming& timing);
+        static nlohmann::json toJson(const TestTiming& timing);
+        static nlohmann::json toJson(const PhaseSpan& span);
+
+        // Evento de progreso → una línea del stream NDJSON
+        // ("compile" | "test" | "summary").
+        static nlohmann::json toJson(const EvaluationEvent& event);
+
+        // {"type", "abs_epsilon", "rel_epsilon", "source"} → CheckerSpec.
+        // Lanza std::invalid_argument si el tipo no existe, una tolerancia
+        // es negativa o un checker custom no trae código.
+        static CheckerSpec parseChecker(const nlohmann::json& body);
+
+        // "run_all" | "stop_on_failure" | "stop_on_timeout".
+        // Lanza std::invalid_argument si el nombre no existe.
+        static FailurePolicy parseFailurePolicy(const std::string& name);
+
+        // "interactive" | "graded" | "rejudge".
+        // Lanza std::invalid_argument si el nombre no existe.
+        static Lane parseLane(const std::string& name);
+
+        static const char* toString(Lane lane);
+
+        static const char* toString(OverallStatus status);
+        static const char* toString(TestStatus status);
+    };
+
+} // namespace engine
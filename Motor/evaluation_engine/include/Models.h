@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -12,22 +16,66 @@ namespace engine {
         std::string expectedOutput; // output esperado
     };
 
+    // Tests de un problema guardados en el TestDataCache del motor.
+    // Inmutable: se comparte entre todas las submissions que lo usan.
+    struct TestDataSet {
+        std::string key;             // sha256(problemId, tests)
+        std::string problemId;
+        std::filesystem::path dir;   // input_<id>.txt y expected_<id>.txt
+        std::vector<TestCase> testCases;
+        std::uintmax_t bytes{0};     // tamaño de inputs + expected
+    };
+
     // Estados de un test tras la ejecución del motor.
     enum class TestStatus {
         Accepted,
         WrongAnswer,
         TimeLimitExceeded,
+        OutputLimitExceeded, // escribió más que el tope de salida (se lo detuvo)
         RuntimeError,
-        InternalError
+        InternalError,
+        Skipped            // no se ejecutó (fail-fast tras un test fallido)
+    };
+
+    // Primera diferencia entre la salida y el expected de un WrongAnswer.
+    // Los fragmentos están acotados (OutputComparer::kDiffContextBytes
+    // antes y después de la diferencia, en la misma línea).
+    struct OutputDiff {
+        std::size_t line{0};     // 1 = primera línea
+        std::size_t column{0};   // 1 = primer byte de la línea
+        std::string expected;    // fragmento del expected alrededor
+        std::string actual;      // fragmento de la salida alrededor
+    };
+
+    // Una fase del desglose de tiempos: inicio en µs desde que empezó la
+    // evaluación (reloj monotónico) y duración en µs.
+    struct PhaseSpan {
+        std::int64_t startUs{0};
+        std::int64_t durationUs{0};
+    };
+
+    // Desglose de tiempos de un test (solo si el request lo pide).
+    // El sandbox no informa cuándo arrancó el programa dentro de la
+    // llamada: spawn es la llamada menos el tiempo del programa y se
+    // ubica antes de execution. En batch no hay spawn por test
+    // (EvaluationTiming::batchRun) y execution empieza con el batch.
+    struct TestTiming {
+        PhaseSpan spawn;
+        PhaseSpan execution;  // tiempo real del programa (el sandbox lo mide en ms)
+        PhaseSpan logRead;    // lectura del runtime log
+        PhaseSpan compare;    // checker / comparación de la salida
     };
 
-    // Resultado detallado de un único test.
     struct TestResult {
         std::string testId;
         TestStatus status{TestStatus::InternalError};
-        int timeMs{0};       // tiempo medido
+        int timeMs{0};       // tiempo reportado (CPU si el sandbox lo mide)
+        int cpuTimeMs{0};    // CPU user+sys del programa
+        int wallTimeMs{0};   // tiempo real del programa
         int memoryKb{0};     // memoria máxima utilizada
         std::string runtimeLog; // stderr o info adicional
+        std::optional<OutputDiff> diff; // solo WrongAnswer con checker "exact"
+        std::optional<TestTiming> timing; // solo con SubmissionRequest::collectTiming
     };
 
     // Estado global de una submission.
@@ -38,15 +86,74 @@ namespace engine {
         InternalError
     };
 
+    // Qué hacer con los tests restantes cuando uno no es aceptado.
+    enum class FailurePolicy {
+        RunAll,            // ejecutar todos (por defecto)
+        StopOnFailure,     // saltar el resto tras el primer test no aceptado
+        StopOnTimeout      // saltar el resto tras el primer TimeLimitExceeded
+    };
+
+    // Cómo se decide si la salida de un test es correcta.
+    enum class CheckerType {
+        Exact,             // OutputComparer: línea a línea (tolerante a blancos finales)
+        Tokens,            // misma secuencia de tokens, sin importar espacios/saltos
+        Float,             // tokens; los numéricos con tolerancia absoluta/relativa
+        UnorderedLines,    // mismas líneas en cualquier orden
+        Custom             // programa checker propio del problema (en sandbox)
+    };
+
+    // Checker configurado en el problema.
+    struct CheckerSpec {
+        CheckerType type{CheckerType::Exact};
+        double absEpsilon{1e-6};    // Float: |out - exp| <= absEpsilon
+        double relEpsilon{1e-6};    // Float: o |out - exp| <= relEpsilon * |exp|
+        std::string source;         // Custom: código C++ del checker
+    };
+
+    // Carril de la cola de evaluaciones. Cada carril tiene un peso y se
+    // reparte los workers en esa proporción (ver JobQueue).
+    enum class Lane {
+        Interactive,       // POST /run: una ejecución con el alumno esperando
+        Graded,            // submissions calificadas (por defecto)
+        Rejudge            // rejudges masivos
+    };
+    constexpr std::size_t kLaneCount = 3;
+
     // Request enviado por el GestorREST al motor.
     struct SubmissionRequest {
         std::string submissionId;
         std::string problemId;
         std::string language;       // "cpp"
         std::string sourceCode;
-        int timeLimitMs{2000};
+        int timeLimitMs{2000};      // límite de CPU por test
+        int wallTimeLimitMs{0};     // tope de tiempo real (0 = automático)
         int memoryLimitKb{262144};  // 256 MB
         std::vector<TestCase> testCases;
+        std::string testDataKey;    // referencia al TestDataCache (en lugar de testCases)
+        std::shared_ptr<const TestDataSet> testData; // testDataKey ya resuelto
+        std::optional<bool> batchMode; // sin valor = default del motor
+        std::optional<bool> inMemoryIo; // stdin/stdout por pipes (sin valor = default del motor)
+        std::optional<int> parallelism; // tests simultáneos (sin valor = default del motor)
+        FailurePolicy failurePolicy{FailurePolicy::RunAll};
+        CheckerSpec checker;
+        bool bypassVerdictCache{false}; // rejudge: evaluar aunque haya veredicto guardado
+        bool collectTiming{false};   // devolver el desglose de tiempos (EvaluationTiming)
+        Lane lane{Lane::Graded};     // carril en la cola (los rejudges van a Rejudge)
+        std::string clientKey;       // usuario o cliente: reparto equitativo dentro del carril
+    };
+
+    // Desglose de tiempos de una evaluación (solo si el request lo pide).
+    // Las fases que no ocurrieron (sin pool, sin batch, veredicto del
+    // cache...) quedan en cero.
+    struct EvaluationTiming {
+        std::int64_t startedAtUs{0}; // inicio de la evaluación (µs desde epoch, reloj del sistema)
+        std::int64_t totalUs{0};
+        PhaseSpan lease;             // espera de un contenedor del pool
+        PhaseSpan createDir;
+        PhaseSpan writeSource;       // main.cpp
+        PhaseSpan writeTests;        // inputs/expected (o hard links del TestDataCache)
+        PhaseSpan compile;
+        PhaseSpan batchRun;          // invocación única del modo batch
     };
 
     // Respuesta final del motor, enviada a la UI.
@@ -57,6 +164,29 @@ namespace engine {
         std::vector<TestResult> tests;
         int maxTimeMs{0};    // máximo entre todos los tests
         int maxMemoryKb{0};  // máximo entre todos los tests
+        bool cached{false};  // sale del VerdictCache (no se ejecutó de nuevo)
+        std::optional<EvaluationTiming> timing; // solo con SubmissionRequest::collectTiming
+    };
+
+    // Request de POST /run: ejecutar el código con un stdin, sin juez.
+    struct RunRequest {
+        std::string sessionId;      // vacío = sesión nueva
+        std::string language;       // "cpp"
+        std::string sourceCode;
+        std::string input;
+        int timeLimitMs{2000};      // límite de CPU
+        int memoryLimitKb{262144};  // 256 MB
+        std::string clientKey;      // usuario o cliente (reparto equitativo en la cola)
+    };
+
+    // Respuesta de POST /run.
+    struct RunOutcome {
+        std::string sessionId;
+        bool compiled{false};       // se compiló en esta llamada (fuente nueva o cambiada)
+        bool compileOk{false};
+        std::string compileLog;
+        TestResult run;             // Accepted = terminó bien; tiempos y stderr
+        std::string output;         // stdout del programa
     };
 
 } // namespace engine
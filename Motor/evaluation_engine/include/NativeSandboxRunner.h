@@ -0,0 +1,136 @@
+#pragma once
+
+#include "SandboxRunner.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace engine {
+
+    // Configuración del backend nativo.
+    struct NativeSandboxConfig {
+        std::string compilerPath{"/usr/bin/g++"};  // compilador del host
+        std::filesystem::path cgroupRoot{"/sys/fs/cgroup/codecoach"}; // cgroup v2 delegado
+        int sandboxUid{65534};     // usuario sin privilegios (si el motor corre como root)
+        int sandboxGid{65534};
+        // Sin root: el programa corre con el primer id subordinado del
+        // usuario del motor (/etc/subuid, /etc/subgid), mapeado con estos
+        // helpers setuid de shadow-utils
+        std::string newuidmapPath{"/usr/bin/newuidmap"};
+        std::string newgidmapPath{"/usr/bin/newgidmap"};
+        // Carpetas/archivos del host que se montan de solo lectura en la
+        // raíz del sandbox (los que no existen se omiten; los symlinks se
+        // recrean). pchDir se agrega aparte.
+        std::vector<std::string> readOnlyPaths{
+            "/usr", "/bin", "/lib", "/lib64", "/etc/ld.so.cache", "/etc/alternatives"};
+        bool useSeccomp{true};     // filtro de syscalls peligrosas
+        int compileTimeLimitSeconds{30};
+        int compileMemoryLimitMb{1024};
+        std::filesystem::path pchDir{"/opt/pch"}; // PCH generados como en la imagen
+    };
+
+    // ============================================================================
+    // NativeSandboxRunner
+    //
+    // Backend Linux que NO usa el CLI de Docker. Cada paso es un clone() directo:
+    //  - namespaces pid, mount, net, ipc y uts, más user si no somos root
+    //  - el programa nunca corre con el uid del motor: como root se baja a
+    //    sandboxUid; sin root, el root del user namespace es el motor (solo
+    //    para armar los montajes) y el programa corre con un uid subordinado
+    //  - pivot_root a una raíz mínima: readOnlyPaths de solo lectura,
+    //    /dev/{null,zero,full,random,urandom}, /proc y /tmp propios y la
+    //    carpeta de la submission, en su misma ruta
+    //  - la carpeta de la submission nunca es escribible para el sandbox:
+    //    se compila en una carpeta privada del motor (main y compile.log
+    //    vuelven copiados) y los tests la ven de solo lectura (la salida va
+    //    por los descriptores que abre el motor)
+    //  - cgroup v2 propio por ejecución: memory.max, cpu.max, pids.max; si
+    //    no se puede crear, la ejecución falla (nunca corre sin límites)
+    //  - rlimits (memoria virtual, CPU, procesos, archivos abiertos, core)
+    //  - seccomp: bloquea mount/ptrace/unshare/bpf/sockets/etc.
+    //
+    // Mismo contrato que DockerRunner (CompileResult / RunResult), pero el
+    // costo de arranque es el de un fork+exec en lugar de un contenedor.
+    // ============================================================================
+    class NativeSandboxRunner : public SandboxRunner {
+    public:
+        explicit NativeSandboxRunner(NativeSandboxConfig config = NativeSandboxConfig{});
+
+        // true si este backend puede aislar de verdad con `config`: root o
+        // ids subordinados + newuidmap, raíz de cgroup v2 delegada con
+        // memory/pids/cpu, y un spawn de prueba (clone con todos los
+        // namespaces, pivot_root, seccomp) que ejecuta el compilador.
+        // Si no, `reason` (opcional) explica por qué.
+        static bool isSupported(const NativeSandboxConfig& config = NativeSandboxConfig{},
+                                std::string* reason = nullptr);
+
+        // Ruta, tamaño y fecha del compilador del host.
+        std::string toolchainId() const override;
+
+        CompileResult compile(
+            const std::filesystem::path& submissionDir,
+            const std::string& sourceFileName) const override;
+
+        RunResult runSingleTest(
+            const std::filesystem::path& submissionDir,
+            const std::string& inputFileName,
+            const std::string& outputFileName,
+            const std::string& runtimeLogName,
+            const RunLimits& limits = RunLimits{}) const override;
+
+        // Pipes directos entre el motor y el programa (sin docker de por medio).
+        RunResult runInMemory(
+            const std::filesystem::path& submissionDir,
+            const std::string& input,
+            std::size_t maxOutputBytes,
+            const RunLimits& limits = RunLimits{}) const override;
+
+        // Sin contenedor que amortizar: cada test es un spawn propio, con
+        // hasta `jobs` hilos lanzándolos a la vez.
+        std::vector<RunResult> runBatch(
+            const std::filesystem::path& submissionDir,
+            const std::vector<std::string>& testIds,
+            const RunLimits& limits = RunLimits{},
+            int jobs = 1,
+            FailurePolicy stopOn = FailurePolicy::RunAll) const override;
+
+    private:
+        // Descripción de un proceso a lanzar dentro del sandbox.
+        struct SpawnSpec {
+            std::filesystem::path workDir;   // carpeta de la submission
+            std::vector<std::string> argv;   // argv[0] = ejecutable
+            std::string stdinPath;           // vacío = /dev/null
+            std::string stdoutPath;          // vacío = /dev/null
+            std::string stderrPath;          // vacío = /dev/null
+            int timeLimitMs{2000};           // tope de tiempo real
+            int cpuLimitMs{0};               // límite de CPU del programa (0 = sin límite)
+            RunLimits limits;
+            // Modo en memoria: stdin desde stdinData y stdout/stderr a
+            // SpawnResult (los *Path se ignoran)
+            const std::string* stdinData{nullptr};
+            std::size_t maxOutputBytes{0};
+        };
+
+        // Resultado crudo del proceso.
+        struct SpawnResult {
+            bool started{false};
+            int exitCode{0};
+            bool timedOut{false};
+            int wallMs{0};
+            int cpuMs{0};
+            int memoryKb{0};
+            std::string output;
+            std::string errors;
+            bool outputTruncated{false};
+            bool outputLimitExceeded{false}; // SIGXFSZ o pipe de salida lleno
+        };
+
+        SpawnResult spawn(const SpawnSpec& spec) const;
+
+        NativeSandboxConfig config_;
+        long subUid_{-1};   // id subordinado para el programa (-1 = no hay)
+        long subGid_{-1};
+    };
+
+} // namespace engine
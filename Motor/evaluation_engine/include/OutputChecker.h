@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Models.h"
+
+#include <filesystem>
+#include <string_view>
+
+namespace engine {
+
+    // ============================================================================
+    // OutputChecker
+    //
+    // Checkers integrados, elegidos por CheckerSpec::type:
+    //  - Exact:          OutputComparer (líneas, ignorando blancos finales)
+    //  - Tokens:         misma secuencia de tokens separados por blancos
+    //  - Float:          como Tokens, pero dos tokens numéricos son iguales si
+    //                    difieren a lo sumo absEpsilon o relEpsilon * |expected|
+    //  - UnorderedLines: el mismo multiconjunto de líneas (normalizadas como
+    //                    en Exact), en cualquier orden
+    //
+    // Exact, Tokens y Float recorren la salida en streaming y cortan en la
+    // primera diferencia; UnorderedLines necesita todas las líneas en memoria
+    // (la salida ya está acotada por el límite de output). Custom no se
+    // resuelve aquí: lo ejecuta CustomChecker dentro del sandbox.
+    // ============================================================================
+    class OutputChecker {
+    public:
+        // Lanza std::invalid_argument si spec.type es Custom. Con Exact,
+        // `diff` recibe la primera diferencia (ver OutputComparer); los
+        // demás checkers no lo completan.
+        static bool accepts(const CheckerSpec& spec,
+                            std::string_view output,
+                            std::string_view expected,
+                            OutputDiff* diff = nullptr);
+
+        // Igual, leyendo ambos archivos. Un archivo inexistente no es aceptado.
+        static bool acceptsFiles(const CheckerSpec& spec,
+                                 const std::filesystem::path& outputFile,
+                                 const std::filesystem::path& expectedFile,
+                                 OutputDiff* diff = nullptr);
+    };
+
+} // namespace engine
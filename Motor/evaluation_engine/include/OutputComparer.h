@@ -1,7 +1,11 @@
 #pragma once
 
+#include "Models.h"
+
+#include <cstddef>
 #include <filesystem>
 #include <string>
+#include <string_view>
 
 namespace engine {
 
@@ -15,12 +19,29 @@ namespace engine {
     //  - ignora líneas vacías al final
     //
     // Esto evita falsos WA por diferencias triviales de formato.
+    // La comparación es en streaming: lee por bloques, normaliza al vuelo y
+    // termina en la primera diferencia (memoria constante sin importar el
+    // tamaño de la salida).
+    //
+    // Si se pasa `diff` y las salidas difieren, se completa en la misma
+    // pasada con la línea/columna de la primera diferencia y un fragmento
+    // acotado de cada lado (sin volver a leer los archivos).
     // ============================================================================
     class OutputComparer {
     public:
+        // Bytes de contexto antes y después de la diferencia en OutputDiff.
+        static constexpr std::size_t kDiffContextBytes = 32;
+
         static bool areEqual(
             const std::filesystem::path& outputFile,
-            const std::filesystem::path& expectedFile);
+            const std::filesystem::path& expectedFile,
+            OutputDiff* diff = nullptr);
+
+        // Misma comparación sobre textos ya en memoria (modo de I/O en memoria).
+        static bool areEqualText(
+            std::string_view output,
+            std::string_view expected,
+            OutputDiff* diff = nullptr);
     };
 
 } // namespace engine
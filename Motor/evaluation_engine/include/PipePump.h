@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace engine {
+
+    // ============================================================================
+    // PipePump
+    //
+    // Lado del motor de los pipes de un proceso hijo (solo POSIX):
+    //  - escribe `input` en su stdin y lo cierra al terminar
+    //  - captura stdout y stderr en memoria, cada uno con un tope de bytes
+    //    (lo que excede se lee y se descarta para que el hijo no se bloquee;
+    //    de stderr se conservan también los últimos kErrorsTailBytes)
+    //
+    // Se usa con un bucle de espera propio: pump() hace una ronda de poll()
+    // (en lugar de dormir) y finish() vacía lo que queda cuando el proceso
+    // ya terminó.
+    // ============================================================================
+    class PipePump {
+    public:
+        static constexpr std::size_t kErrorsTailBytes = 4096;
+
+        PipePump(const std::string& input,
+                 std::size_t maxOutputBytes,
+                 std::size_t maxErrorBytes);
+        ~PipePump();
+
+        PipePump(const PipePump&) = delete;
+        PipePump& operator=(const PipePump&) = delete;
+
+        // Toma posesión de los fds del lado del motor (-1 = no se usa).
+        void attach(int stdinFd, int stdoutFd, int stderrFd);
+
+        // Una ronda de I/O esperando como mucho timeoutMs.
+        // Devuelve false cuando ya no queda ningún fd abierto.
+        bool pump(int timeoutMs);
+
+        // Tras la salida del proceso: lee lo que quedó en los pipes.
+        void finish();
+
+        std::string& output() { return output_; }
+        std::string& errors() { return errors_; }
+        bool outputTruncated() const { return outputTruncated_; }
+
+    private:
+        void closeFd(int& fd);
+        void writeInput();
+        void readInto(int& fd, std::string& buffer, std::size_t limit, bool& truncated);
+
+        const std::string& input_;
+        std::size_t inputPos_{0};
+        std::size_t maxOutputBytes_;
+        std::size_t maxErrorBytes_;
+
+        int stdinFd_{-1};
+        int stdoutFd_{-1};
+        int stderrFd_{-1};
+
+        std::string output_;
+        std::string errors_;
+        std::string errorsTail_;
+        bool outputTruncated_{false};
+        bool errorsTruncated_{false};
+    };
+
+} // namespace engine
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace engine {
+
+    // Un encabezado precompilado de la imagen: /opt/pch/<name> (+ .gch).
+    struct PrecompiledHeader {
+        std::string name;                 // archivo dentro de la carpeta PCH
+        std::vector<std::string> headers; // headers que incluye
+    };
+
+    // ============================================================================
+    // PrecompiledHeaders
+    //
+    // Conjuntos de headers que la imagen trae precompilados (ver
+    // docker/cpp/pch/). Se elige el conjunto más grande cuyos headers estén
+    // TODOS incluidos por la submission, para no hacer visibles nombres que
+    // el código no pidió. Si ninguno aplica se compila sin PCH.
+    //
+    // `-include` mete el PCH antes de la primera línea del código, así que
+    // solo se cuentan los `#include <...>` del comienzo del archivo (sin
+    // comentarios). Si antes de ellos o entre ellos hay cualquier otra
+    // directiva (#define _GLIBCXX_DEBUG, #pragma, #if, un include local...)
+    // adelantar los headers podría cambiar el resultado: no se usa PCH.
+    // ============================================================================
+    class PrecompiledHeaders {
+    public:
+        // Carpeta de los PCH dentro de la imagen del juez.
+        static constexpr const char* kImageDir = "/opt/pch";
+
+        // Tabla en orden de preferencia (debe coincidir con docker/cpp/pch/).
+        static const std::vector<PrecompiledHeader>& available();
+
+        // Headers de sistema del bloque inicial de includes: `#include <x>`
+        // -> "x". std::nullopt si el bloque tiene otras directivas.
+        static std::optional<std::set<std::string>> leadingIncludes(const std::string& sourceCode);
+
+        // Nombre del PCH a usar para este código, o std::nullopt.
+        static std::optional<std::string> select(const std::string& sourceCode);
+
+        // Igual que select(), leyendo el código desde un archivo.
+        static std::optional<std::string> selectForFile(const std::filesystem::path& sourcePath);
+    };
+
+} // namespace engine
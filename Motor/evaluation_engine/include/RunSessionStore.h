@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace engine {
+
+    // Una sesión de /run: el binario compilado de un código fuente, listo
+    // para ejecutarse con distintos stdin sin volver a compilar.
+    struct RunSession {
+        std::string id;
+        std::filesystem::path dir;    // main (y main.cpp, compile.log)
+        std::string sourceKey;        // sha256(lenguaje, fuente, toolchain); vacío = sin compilar
+        bool compileOk{false};
+        std::string compileLog;
+
+        // Una compilación/ejecución a la vez por sesión
+        std::mutex mutex;
+
+        // La carpeta se borra cuando nadie más usa la sesión (ni el store
+        // ni una ejecución en curso).
+        ~RunSession();
+    };
+
+    // Contadores de las sesiones de /run.
+    struct RunSessionStats {
+        std::uint64_t created{0};
+        std::uint64_t reused{0};      // llamadas con una sesión existente
+        std::uint64_t expired{0};     // por inactividad
+        std::uint64_t evicted{0};     // por superar maxSessions
+        std::size_t active{0};
+    };
+
+    // ============================================================================
+    // RunSessionStore
+    //
+    // Sesiones de POST /run: la primera llamada crea una sesión (una carpeta
+    // en root/<id>) y las siguientes con el mismo id la reutilizan mientras
+    // no venza. Una sesión sin usar durante idleTtl se descarta; si hay más
+    // de maxSessions se descartan las usadas hace más tiempo (LRU).
+    // ============================================================================
+    class RunSessionStore {
+    public:
+        RunSessionStore(std::filesystem::path root,
+                        std::size_t maxSessions,
+                        std::chrono::seconds idleTtl);
+
+        // Sesión con ese id si existe y no venció; si no (o id vacío), una
+        // nueva con id propio. El id pedido nunca se reutiliza para crear.
+        std::shared_ptr<RunSession> acquire(const std::string& id);
+
+        // Descarta la sesión. false si no existía.
+        bool remove(const std::string& id);
+
+        RunSessionStats stats() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Entry {
+            std::shared_ptr<RunSession> session;
+            Clock::time_point lastUsed;
+            std::list<std::string>::iterator lruPos; // posición en lru_
+        };
+
+        void purgeExpired(Clock::time_point now);
+
+        std::filesystem::path root_;
+        std::size_t maxSessions_;
+        std::chrono::seconds idleTtl_;
+
+        mutable std::mutex mutex_;
+        std::unordered_map<std::string, Entry> sessions_;
+        std::list<std::string> lru_; // frente = más reciente
+        RunSessionStats stats_;
+    };
+
+} // namespace engine
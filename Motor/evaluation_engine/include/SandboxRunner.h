@@ -0,0 +1,153 @@
+#pragma once
+
+#include "Models.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace engine {
+
+    // Flags de compilación comunes a todos los backends (forman parte de la
+    // clave del cache de compilación).
+    inline constexpr const char* kCompileFlags = "-O2 -std=c++20";
+
+    // Resultado de la compilación dentro del sandbox.
+    // Se almacena:
+    // - exitCode: código devuelto por el compilador (0 = éxito)
+    // - logFilePath: ruta local (host) al archivo compile.log generado
+    struct CompileResult {
+        int exitCode{0};
+        std::string logFilePath;
+    };
+
+    // Un compilador que falla siempre deja su diagnóstico en compile.log:
+    // salida distinta de 0 con el log vacío (o sin log) es que el sandbox no
+    // llegó a compilar (Docker caído, contenedor del pool muerto, spawn que
+    // no arrancó). Es una falla del motor, no un CompilationError.
+    inline bool compileDidNotRun(const CompileResult& r) {
+        if (r.exitCode == 0) {
+            return false;
+        }
+        std::error_code ec;
+        auto logSize = std::filesystem::file_size(r.logFilePath, ec);
+        return ec || logSize == 0;
+    }
+
+    // Resultado de la ejecución de un solo test.
+    // - exitCode: código de retorno del programa
+    // - timedOut: true si excedió el límite de tiempo
+    // - runtimeLogPath: ruta al log generado (stderr / info)
+    // - outputPath: salida real generada por el programa para el test
+    // - timeMs: tiempo real del proceso ./main (sin arranque del sandbox)
+    // - cpuTimeMs: tiempo de CPU user+sys del proceso
+    // - memoryKb: RSS máximo
+    //   (los tres medidos por el sandbox; -1 = no disponible)
+    // - executed: false si el sandbox no llegó a ejecutar el test (fallo interno)
+    // - outputLimitExceeded: se detuvo al programa por escribir más de
+    //   RunLimits::outputLimitBytes
+    // - output / runtimeLog / outputTruncated: solo en runInMemory (stdout y
+    //   stderr capturados en memoria en lugar de outputPath/runtimeLogPath)
+    struct RunResult {
+        int exitCode{0};
+        bool timedOut{false};
+        std::string runtimeLogPath;
+        std::string outputPath;
+        int timeMs{-1};
+        int cpuTimeMs{-1};
+        int memoryKb{-1};
+        bool executed{true};
+        bool outputLimitExceeded{false};
+        std::string output;
+        std::string runtimeLog;
+        bool outputTruncated{false};
+    };
+
+    // true si, con la política dada, este resultado detiene el resto del
+    // batch (el sandbox no puede detectar WrongAnswer: eso se compara después).
+    inline bool stopsBatch(const RunResult& r, FailurePolicy stopOn) {
+        switch (stopOn) {
+            case FailurePolicy::StopOnTimeout: return r.timedOut;
+            case FailurePolicy::StopOnFailure:
+                return r.timedOut || r.exitCode != 0 || !r.executed || r.outputLimitExceeded;
+            case FailurePolicy::RunAll:        break;
+        }
+        return false;
+    }
+
+    // Límites de seguridad/recursos para la ejecución dentro del sandbox.
+    // El tiempo se controla sobre CPU (user+sys) con resolución de ms; el
+    // tope de tiempo real solo atrapa programas dormidos o bloqueados.
+    struct RunLimits {
+        int timeLimitMs{2000};     // límite de CPU por test
+        int wallLimitMs{0};        // tope de tiempo real (0 = automático)
+        int memoryLimitMb{256};    // límite de memoria
+        double cpuLimit{1.0};      // CPUs asignadas (1.0 = una CPU completa)
+        int pidsLimit{64};         // límite de procesos (evita fork-bombs)
+        std::size_t outputLimitBytes{0}; // tope de stdout/stderr (0 = sin límite);
+                                         // se aplica mientras el programa corre
+
+        // Tope real efectivo: el doble del límite de CPU más un margen fijo.
+        int effectiveWallLimitMs() const {
+            return wallLimitMs > 0 ? wallLimitMs : timeLimitMs * 2 + 100;
+        }
+    };
+
+    // ============================================================================
+    // SandboxRunner
+    //
+    // Contrato común de los backends que compilan y ejecutan el código del
+    // usuario de forma aislada:
+    //  - DockerRunner: `docker run` / `docker exec` (portable, más lento)
+    //  - NativeSandboxRunner: fork + namespaces + cgroup v2 (solo Linux)
+    //
+    // Todos los archivos se leen/escriben en submissionDir del host, así el
+    // EvaluationService no depende del backend elegido.
+    // ============================================================================
+    class SandboxRunner {
+    public:
+        virtual ~SandboxRunner() = default;
+
+        // Identifica el compilador usado (digest de la imagen Docker, versión
+        // del g++ del host...). Dos binarios con el mismo fuente, flags y
+        // toolchainId son intercambiables.
+        virtual std::string toolchainId() const = 0;
+
+        // Compila sourceFileName → main. stderr del compilador en compile.log.
+        virtual CompileResult compile(
+            const std::filesystem::path& submissionDir,
+            const std::string& sourceFileName) const = 0;
+
+        // Ejecuta ./main con input/output/log indicados y los límites dados.
+        virtual RunResult runSingleTest(
+            const std::filesystem::path& submissionDir,
+            const std::string& inputFileName,
+            const std::string& outputFileName,
+            const std::string& runtimeLogName,
+            const RunLimits& limits = RunLimits{}) const = 0;
+
+        // Ejecuta ./main sin archivos de test: `input` llega por un pipe a
+        // stdin y stdout se captura en memoria hasta maxOutputBytes. Si lo
+        // supera, el programa se detiene y se marcan outputTruncated y
+        // outputLimitExceeded. Solo el binario vive en submissionDir.
+        virtual RunResult runInMemory(
+            const std::filesystem::path& submissionDir,
+            const std::string& input,
+            std::size_t maxOutputBytes,
+            const RunLimits& limits = RunLimits{}) const = 0;
+
+        // Ejecuta todos los tests (input_<id>.txt → output_<id>.txt), hasta
+        // `jobs` a la vez, y devuelve un RunResult por id, en el mismo orden.
+        // Con stopOn != RunAll no se lanzan más tests después del primero que
+        // excede el tiempo (o termina con error, en StopOnFailure); los que no
+        // llegaron a lanzarse vuelven con executed = false.
+        virtual std::vector<RunResult> runBatch(
+            const std::filesystem::path& submissionDir,
+            const std::vector<std::string>& testIds,
+            const RunLimits& limits = RunLimits{},
+            int jobs = 1,
+            FailurePolicy stopOn = FailurePolicy::RunAll) const = 0;
+    };
+
+} // namespace engine
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Models.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace engine {
+
+    // Contadores del cache de tests.
+    struct TestDataCacheStats {
+        std::uint64_t hits{0};
+        std::uint64_t misses{0};
+        std::uint64_t uploads{0};     // sets nuevos guardados
+        std::uint64_t evictions{0};
+        std::uintmax_t bytes{0};      // tamaño actual (disco = memoria)
+        std::size_t entries{0};
+    };
+
+    // ============================================================================
+    // TestDataCache
+    //
+    // Cache de los tests de cada problema, para que el GestorREST no tenga que
+    // mandar (ni el motor parsear y escribir) todos los inputs en cada
+    // submission:
+    //   clave = sha256(problemId, id/input/expected de cada test)
+    //   <cacheDir>/<clave>/manifest          problemId y los ids en orden
+    //   <cacheDir>/<clave>/input_<id>.txt
+    //   <cacheDir>/<clave>/expected_<id>.txt
+    //
+    // Los tests también quedan en memoria (los usa el modo de I/O en
+    // memoria). Los archivos son de solo lectura y nunca se modifican: una
+    // clave nueva = un set nuevo. Si el total supera maxBytes se expulsan los
+    // sets usados hace más tiempo (LRU); las submissions en curso conservan el
+    // suyo por el shared_ptr.
+    // ============================================================================
+    class TestDataCache {
+    public:
+        TestDataCache(std::filesystem::path cacheDir, std::uintmax_t maxBytes);
+
+        // Calcula la clave de un set de tests.
+        static std::string makeKey(const std::string& problemId,
+                                   const std::vector<TestCase>& testCases);
+
+        // Guarda el set (si no existía) y lo devuelve. Lanza
+        // std::invalid_argument si un id no sirve como nombre de archivo.
+        std::shared_ptr<const TestDataSet> put(const std::string& problemId,
+                                               std::vector<TestCase> testCases);
+
+        // Set guardado bajo la clave, o nullptr.
+        std::shared_ptr<const TestDataSet> find(const std::string& key);
+
+        // Deja input_<id>.txt en submissionDir: hard link si `hardlink` (solo
+        // es seguro si el programa del usuario no puede escribir archivos del
+        // motor), si no una copia. Los expected no se copian: el motor
+        // compara contra TestDataSet::testCases.
+        static void linkInputs(const TestDataSet& set,
+                               const std::filesystem::path& submissionDir,
+                               bool hardlink);
+
+        TestDataCacheStats stats() const;
+
+    private:
+        struct Entry {
+            std::shared_ptr<const TestDataSet> set;
+            std::list<std::string>::iterator lruPos; // posición en lru_
+        };
+
+        void loadIndex();
+        std::shared_ptr<TestDataSet> loadSet(const std::filesystem::path& dir) const;
+        void touch(Entry& entry, const std::string& key);
+        void evictIfNeeded();
+
+        std::filesystem::path cacheDir_;
+        std::uintmax_t maxBytes_;
+
+        mutable std::mutex mutex_;
+        std::unordered_map<std::string, Entry> index_;
+        std::list<std::string> lru_; // frente = más reciente
+        TestDataCacheStats stats_;
+    };
+
+} // namespace engine
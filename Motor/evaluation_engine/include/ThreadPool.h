@@ -0,0 +1,53 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace engine {
+
+    // ============================================================================
+    // ThreadPool
+    //
+    // Pool fijo de hilos compartido por todo el motor. Acota cuántos tests se
+    // ejecutan a la vez sumando TODAS las submissions en curso, sin importar
+    // cuántos hilos de Crow estén atendiendo requests.
+    // ============================================================================
+    class ThreadPool {
+    public:
+        // threads = 0 → std::thread::hardware_concurrency()
+        explicit ThreadPool(std::size_t threads = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Encola una tarea. No debe lanzar excepciones (se capturan y se ignoran).
+        void submit(std::function<void()> task);
+
+        std::size_t size() const { return workers_.size(); }
+
+        // Ejecuta fn(0..count-1) usando como máximo `parallelism` tareas del
+        // pool y espera a que terminen todas. Los índices se reparten
+        // dinámicamente; el orden de los resultados lo decide quien llama
+        // (normalmente escribiendo en un vector ya dimensionado).
+        // Si alguna llamada lanza, se relanza la primera excepción.
+        void parallelFor(std::size_t count,
+                         std::size_t parallelism,
+                         const std::function<void(std::size_t)>& fn);
+
+    private:
+        void workerLoop();
+
+        std::vector<std::thread> workers_;
+        std::queue<std::function<void()>> tasks_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        bool stopping_{false};
+    };
+
+} // namespace engine
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Models.h"
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace engine {
+
+    // Contadores del cache de veredictos.
+    struct VerdictCacheStats {
+        std::uint64_t hits{0};
+        std::uint64_t misses{0};
+        std::uint64_t stores{0};
+        std::uint64_t evictions{0};   // por tamaño
+        std::uint64_t expirations{0}; // por TTL
+        std::uint64_t bypasses{0};    // rejudges que no consultaron el cache
+        std::uintmax_t bytes{0};      // tamaño aproximado en memoria
+        std::size_t entries{0};
+    };
+
+    // ============================================================================
+    // VerdictCache
+    //
+    // Cache en memoria de resultados completos: la misma fuente para el mismo
+    // problema (copias en clase, reenvíos tras un timeout de la UI) devuelve
+    // el EvaluationResult guardado sin compilar ni ejecutar nada.
+    //   clave = sha256(lenguaje, fuente, hash de los tests, límites,
+    //                  checker, política de fallos, toolchain)
+    //
+    // Las entradas vencen tras `ttl` y, si el total supera maxBytes, se
+    // expulsan las usadas hace más tiempo (LRU). Los InternalError (global
+    // o de cualquier test) no se guardan: son fallas del motor, no del código.
+    // ============================================================================
+    class VerdictCache {
+    public:
+        VerdictCache(std::uintmax_t maxBytes, std::chrono::seconds ttl);
+
+        // Calcula la clave de una submission. toolchainId identifica el
+        // compilador/imagen (SandboxRunner::toolchainId).
+        static std::string makeKey(const SubmissionRequest& request,
+                                   const std::string& toolchainId);
+
+        // Resultado guardado bajo la clave (con cached = true), o nullopt.
+        std::optional<EvaluationResult> find(const std::string& key);
+
+        // Guarda (o reemplaza) el resultado de una evaluación.
+        void store(const std::string& key, const EvaluationResult& result);
+
+        // Cuenta un rejudge que evitó el cache (solo estadística).
+        void countBypass();
+
+        VerdictCacheStats stats() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Entry {
+            EvaluationResult result;
+            std::uintmax_t bytes{0};
+            Clock::time_point expiresAt;
+            std::list<std::string>::iterator lruPos; // posición en lru_
+        };
+
+        void erase(std::unordered_map<std::string, Entry>::iterator it);
+        void evictIfNeeded();
+
+        std::uintmax_t maxBytes_;
+        std::chrono::seconds ttl_;
+
+        mutable std::mutex mutex_;
+        std::unordered_map<std::string, Entry> index_;
+        std::list<std::string> lru_; // frente = más reciente
+        VerdictCacheStats stats_;
+    };
+
+} // namespace engine
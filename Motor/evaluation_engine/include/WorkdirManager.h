@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+
+namespace engine {
+
+    // Configuración de las carpetas de trabajo de las submissions.
+    struct WorkdirConfig {
+        std::uintmax_t tmpfsSizeMb{0};  // > 0: montar un tmpfs de ese tamaño en la raíz (requiere root)
+        int retentionSeconds{0};        // 0 = borrar al terminar; > 0 = conservar para depurar
+        std::size_t maxRetained{100};   // carpetas conservadas como máximo
+        bool retainOnlyFailures{true};  // conservar solo las que no terminaron Accepted
+    };
+
+    // ============================================================================
+    // WorkdirManager
+    //
+    // Ciclo de vida de las carpetas de trabajo:
+    //  - create(): carpeta con nombre único (id de la submission saneado +
+    //    sufijo), así dos submissions con el mismo id nunca se pisan
+    //  - release(): al terminar la evaluación se borra, o se mueve a
+    //    <raíz>/.retained durante retentionSeconds para depurar
+    //  - al arrancar se borran las carpetas huérfanas de una ejecución anterior
+    //
+    // La raíz puede ser un tmpfs (RAM) con tope de tamaño: si el motor corre
+    // como root y tmpfsSizeMb > 0 lo monta él mismo; si no, se puede montar
+    // desde fuera (fstab, `docker run --tmpfs`).
+    // ============================================================================
+    class WorkdirManager {
+    public:
+        WorkdirManager(std::filesystem::path root, WorkdirConfig config = WorkdirConfig{});
+
+        const std::filesystem::path& root() const { return root_; }
+        const WorkdirConfig& config() const { return config_; }
+
+        // true si la raíz está en un tmpfs (montado por el motor o no).
+        bool onTmpfs() const { return onTmpfs_; }
+
+        // Crea parent/<id saneado>-<único>. parent suele ser root() o la
+        // carpeta del contenedor prestado (que debe estar dentro de root()
+        // para que release() pueda conservarla con un rename).
+        std::filesystem::path create(const std::filesystem::path& parent,
+                                     const std::string& submissionId);
+
+        // Borra la carpeta o, si failed y hay retención, la conserva.
+        void release(const std::filesystem::path& dir, bool failed);
+
+    private:
+        void mountTmpfsIfRequested();
+        void sweepOrphans();
+        void purgeRetained();         // con mutex_ tomado
+
+        std::filesystem::path root_;
+        std::filesystem::path retainedDir_;
+        WorkdirConfig config_;
+        bool onTmpfs_{false};
+        std::mutex mutex_;
+    };
+
+} // namespace engine
@@ -0,0 +1,300 @@
+#include "CompileCache.h"
+
+#include "Hashing.h"
+#include "SandboxRunner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+    // Tamaño total de los archivos de una entrada.
+    std::uintmax_t directorySize(const std::filesystem::path& dir) {
+        std::uintmax_t total = 0;
+        std::error_code ec;
+        for (const auto& f : std::filesystem::directory_iterator(dir, ec)) {
+            if (f.is_regular_file(ec)) {
+                total += f.file_size(ec);
+            }
+        }
+        return total;
+    }
+
+} // namespace
+
+namespace engine {
+
+// ============================================================================
+// Constructor: crea la carpeta y reconstruye el índice desde disco.
+// ============================================================================
+CompileCache::CompileCache(std::filesystem::path cacheDir, std::uintmax_t maxBytes)
+    : cacheDir_(std::move(cacheDir)),
+      maxBytes_(maxBytes)
+{
+    std::filesystem::create_directories(cacheDir_);
+    loadIndex();
+}
+
+std::string CompileCache::makeKey(const std::string& sourceCode,
+                                  const std::string& flags,
+                                  const std::string& toolchainId)
+{
+    return Sha256()
+        .updateField(sourceCode)
+        .updateField(flags)
+        .updateField(toolchainId)
+        .hexDigest();
+}
+
+// ============================================================================
+// loadIndex
+// Entradas completas (con exit_code) ordenadas por fecha de modificación:
+// la más reciente queda al frente de la lista LRU. Restos de escrituras a
+// medio terminar (carpetas .tmp-*) se borran.
+// ============================================================================
+void CompileCache::loadIndex()
+{
+    struct Found {
+        std::string key;
+        std::filesystem::file_time_type mtime;
+        std::uintmax_t bytes;
+    };
+    std::vector<Found> found;
+
+    std::error_code ec;
+    for (const auto& d : std::filesystem::directory_iterator(cacheDir_, ec)) {
+        std::string name = d.path().filename().string();
+        if (!d.is_directory(ec)) {
+            continue;
+        }
+        if (name.rfind(".tmp-", 0) == 0 || !std::filesystem::exists(d.path() / "exit_code", ec)) {
+            std::filesystem::remove_all(d.path(), ec);
+            continue;
+        }
+        found.push_back({name,
+                         std::filesystem::last_write_time(d.path() / "exit_code", ec),
+                         directorySize(d.path())});
+    }
+
+    std::sort(found.begin(), found.end(),
+              [](const Found& a, const Found& b) { return a.mtime > b.mtime; });
+
+    for (const auto& f : found) {
+        lru_.push_back(f.key);
+        index_[f.key] = Entry{f.bytes, std::prev(lru_.end())};
+        stats_.bytes += f.bytes;
+    }
+    stats_.entries = index_.size();
+
+    Trash trash;
+    evictIfNeeded(trash);
+    emptyTrash(trash);
+}
+
+void CompileCache::touch(Entry& entry, const std::string& key)
+{
+    lru_.erase(entry.lruPos);
+    lru_.push_front(key);
+    entry.lruPos = lru_.begin();
+}
+
+// ============================================================================
+// evictIfNeeded
+// Saca desde el final de la lista LRU hasta quedar bajo el presupuesto.
+// Se llama con mutex_ tomado.
+// ============================================================================
+void CompileCache::evictIfNeeded(Trash& trash)
+{
+    while (stats_.bytes > maxBytes_ && !lru_.empty()) {
+        std::string victim = lru_.back();
+        lru_.pop_back();
+
+        auto it = index_.find(victim);
+        if (it != index_.end()) {
+            stats_.bytes -= std::min(stats_.bytes, it->second.bytes);
+            index_.erase(it);
+        }
+
+        if (pins_.count(victim)) {
+            doomed_.insert(victim); // la borra el último restore que la suelte
+        } else {
+            discard(victim, trash);
+        }
+        ++stats_.evictions;
+    }
+    stats_.entries = index_.size();
+}
+
+// ============================================================================
+// discard
+// Renombrar es inmediato y libera la clave (un store puede volver a
+// guardarla); el borrado real lo hace emptyTrash fuera del lock. Los
+// nombres ".tmp-" que queden por un corte los limpia loadIndex.
+// ============================================================================
+void CompileCache::discard(const std::string& key, Trash& trash)
+{
+    static std::atomic<unsigned long> counter{0};
+    std::filesystem::path target = cacheDir_ / (".tmp-evicted-" + key + "-" + std::to_string(counter++));
+    std::error_code ec;
+    std::filesystem::rename(cacheDir_ / key, target, ec);
+    if (ec) {
+        std::filesystem::remove_all(cacheDir_ / key, ec);
+        return;
+    }
+    trash.push_back(std::move(target));
+}
+
+void CompileCache::unpin(const std::string& key, Trash& trash)
+{
+    auto it = pins_.find(key);
+    if (it == pins_.end() || --it->second > 0) {
+        return;
+    }
+    pins_.erase(it);
+    if (doomed_.erase(key)) {
+        discard(key, trash);
+    }
+}
+
+void CompileCache::emptyTrash(const Trash& trash)
+{
+    std::error_code ec;
+    for (const auto& dir : trash) {
+        std::filesystem::remove_all(dir, ec);
+    }
+}
+
+// ============================================================================
+// restore
+// Copia (no enlaza) los artefactos: el programa del usuario no debe poder
+// modificar el binario guardado en el cache. Con el lock solo se busca la
+// entrada, se la fija y se actualiza su posición LRU; la copia va sin lock.
+// ============================================================================
+std::optional<int> CompileCache::restore(const std::string& key,
+                                         const std::filesystem::path& submissionDir)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            ++stats_.misses;
+            return std::nullopt;
+        }
+        touch(it->second, key);
+        ++pins_[key];
+    }
+
+    std::filesystem::path entryDir = cacheDir_ / key;
+    int exitCode = 0;
+    bool ok = false;
+    {
+        std::ifstream in(entryDir / "exit_code");
+        ok = static_cast<bool>(in >> exitCode);
+    }
+
+    std::error_code ec;
+    const auto overwrite = std::filesystem::copy_options::overwrite_existing;
+    if (ok) {
+        std::filesystem::copy_file(entryDir / "compile.log", submissionDir / "compile.log", overwrite, ec);
+    }
+    if (ok && !ec && exitCode == 0) {
+        std::filesystem::copy_file(entryDir / "main", submissionDir / "main", overwrite, ec);
+    }
+    ok = ok && !ec;
+
+    Trash trash;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        unpin(key, trash);
+        if (ok) {
+            ++stats_.hits;
+        } else {
+            ++stats_.misses; // entrada dañada: se recompila y se vuelve a guardar
+        }
+    }
+    emptyTrash(trash);
+
+    if (!ok) {
+        return std::nullopt;
+    }
+    return exitCode;
+}
+
+// ============================================================================
+// store
+// Escribe en una carpeta temporal y la renombra, así nunca se ve una entrada
+// a medias. No se guardan fallos sin log (suelen ser errores de
+// infraestructura, no del código).
+// ============================================================================
+void CompileCache::store(const std::string& key,
+                         const std::filesystem::path& submissionDir,
+                         int exitCode)
+{
+    if (compileDidNotRun(CompileResult{exitCode, (submissionDir / "compile.log").string()})) {
+        return;
+    }
+
+    std::error_code ec;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (index_.count(key)) {
+            return; // otra submission idéntica ya la guardó
+        }
+    }
+
+    static std::atomic<unsigned long> counter{0};
+    std::filesystem::path tmp = cacheDir_ / (".tmp-" + key + "-" + std::to_string(counter++));
+    std::filesystem::create_directories(tmp, ec);
+    if (ec) {
+        return;
+    }
+
+    const auto overwrite = std::filesystem::copy_options::overwrite_existing;
+    std::filesystem::copy_file(submissionDir / "compile.log", tmp / "compile.log", overwrite, ec);
+    if (!ec && exitCode == 0) {
+        std::filesystem::copy_file(submissionDir / "main", tmp / "main", overwrite, ec);
+    }
+    if (!ec) {
+        std::ofstream out(tmp / "exit_code");
+        out << exitCode;
+        if (!out) {
+            ec = std::make_error_code(std::errc::io_error);
+        }
+    }
+    if (ec) {
+        std::filesystem::remove_all(tmp, ec);
+        return;
+    }
+
+    std::uintmax_t bytes = directorySize(tmp);
+
+    Trash trash{tmp}; // si se publica, el rename la saca de acá
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Ya guardada, o expulsada pero con su carpeta aún en uso
+        if (!index_.count(key) && !doomed_.count(key)) {
+            std::filesystem::rename(tmp, cacheDir_ / key, ec);
+            if (!ec) {
+                trash.clear();
+                lru_.push_front(key);
+                index_[key] = Entry{bytes, lru_.begin()};
+                stats_.bytes += bytes;
+                ++stats_.stores;
+                evictIfNeeded(trash);
+            }
+        }
+    }
+    emptyTrash(trash);
+}
+
+CompileCacheStats CompileCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace engine
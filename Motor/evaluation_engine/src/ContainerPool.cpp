@@ -0,0 +1,325 @@
+#include "ContainerPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+    // Ruta absoluta del host con slashes (compatibilidad con Docker en Windows).
+    std::string toDockerPath(const std::filesystem::path& dir) {
+        std::string hostPath = std::filesystem::absolute(dir).string();
+        std::replace(hostPath.begin(), hostPath.end(), '\\', '/');
+        return hostPath;
+    }
+
+    // Prefijo aleatorio para que dos motores no choquen en nombres de contenedor.
+    std::string randomPrefix() {
+        std::random_device rd;
+        std::ostringstream oss;
+        oss << "codecoach-pool-" << std::hex << (rd() & 0xffffff);
+        return oss.str();
+    }
+
+} // namespace
+
+namespace engine {
+
+// ============================================================================
+// Lease
+// ============================================================================
+ContainerPool::Lease::Lease(ContainerPool* pool, std::size_t slot)
+    : pool_(pool), slot_(slot)
+{}
+
+ContainerPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_), slot_(other.slot_), dirty_(other.dirty_)
+{
+    other.pool_ = nullptr;
+}
+
+ContainerPool::Lease& ContainerPool::Lease::operator=(Lease&& other) noexcept
+{
+    if (this != &other) {
+        if (pool_) {
+            pool_->release(slot_, dirty_);
+        }
+        pool_  = other.pool_;
+        slot_  = other.slot_;
+        dirty_ = other.dirty_;
+        other.pool_ = nullptr;
+    }
+    return *this;
+}
+
+ContainerPool::Lease::~Lease()
+{
+    if (pool_) {
+        pool_->release(slot_, dirty_);
+    }
+}
+
+const std::string& ContainerPool::Lease::containerName() const
+{
+    return pool_->slots_[slot_].name;
+}
+
+const std::filesystem::path& ContainerPool::Lease::hostDir() const
+{
+    return pool_->slots_[slot_].hostDir;
+}
+
+void ContainerPool::Lease::markDirty()
+{
+    dirty_ = true;
+}
+
+// ============================================================================
+// Constructor: prepara los slots (nombre + carpeta host) sin iniciar nada.
+// ============================================================================
+ContainerPool::ContainerPool(std::string imageName,
+                             std::filesystem::path hostBaseDir,
+                             ContainerPoolConfig config)
+    : imageName_(std::move(imageName)),
+      hostBaseDir_(std::move(hostBaseDir)),
+      config_(config)
+{
+    if (config_.size == 0) {
+        throw std::invalid_argument("El pool de contenedores necesita al menos 1 slot");
+    }
+
+    std::string prefix = randomPrefix();
+    slots_.resize(config_.size);
+    for (std::size_t i = 0; i < slots_.size(); ++i) {
+        slots_[i].name    = prefix + "-" + std::to_string(i);
+        slots_[i].hostDir = hostBaseDir_ / ("pool-" + std::to_string(i));
+    }
+}
+
+// ============================================================================
+// Destructor: elimina todos los contenedores del pool.
+// ============================================================================
+ContainerPool::~ContainerPool()
+{
+    for (const auto& slot : slots_) {
+        removeContainer(slot);
+    }
+}
+
+// ============================================================================
+// start
+// Crea la carpeta de cada slot y levanta su contenedor con:
+//   docker run -d --network=none --memory --cpus --pids-limit
+//              -v "<slot>:/workspace" <imagen> sleep infinity
+// El proceso "sleep" corre como root para que limpiar los procesos del
+// usuario runner no mate al contenedor.
+// ============================================================================
+void ContainerPool::start()
+{
+    for (auto& slot : slots_) {
+        std::error_code ec;
+        std::filesystem::create_directories(slot.hostDir, ec);
+        if (ec) {
+            throw std::runtime_error(
+                "No se pudo crear la carpeta del pool: " +
+                slot.hostDir.string() + " - " + ec.message());
+        }
+
+        removeContainer(slot); // por si quedó uno viejo con el mismo nombre
+        if (!startContainer(slot)) {
+            throw std::runtime_error(
+                "No se pudo iniciar el contenedor del pool: " + slot.name);
+        }
+    }
+}
+
+bool ContainerPool::startContainer(const Slot& slot) const
+{
+    std::ostringstream cmd;
+    cmd << "docker run -d "
+        << "--name " << slot.name << " "
+        << "--network=none "
+        << "--memory=" << config_.memoryLimitMb << "m "
+        << "--cpus=" << config_.cpuLimit << " "
+        << "--pids-limit=" << config_.pidsLimit << " "
+        << "-u root "
+        << "-v \"" << toDockerPath(slot.hostDir) << ":" << kMountPoint << "\" "
+        << imageName_ << " sleep infinity > "
+#ifdef _WIN32
+        << "NUL";
+#else
+        << "/dev/null";
+#endif
+
+    return std::system(cmd.str().c_str()) == 0;
+}
+
+// ============================================================================
+// resetContainer
+// Deja el contenedor como nuevo para la siguiente submission:
+//  - mata cualquier proceso que haya quedado del usuario runner
+//  - vacía /workspace y /tmp
+// ============================================================================
+bool ContainerPool::resetContainer(const Slot& slot) const
+{
+    std::ostringstream cmd;
+    cmd << "docker exec -u root " << slot.name << " "
+        << "/bin/sh -c \"pkill -9 -u runner; "
+        << "find " << kMountPoint << " /tmp -mindepth 1 -delete; true\"";
+
+    return std::system(cmd.str().c_str()) == 0;
+}
+
+void ContainerPool::removeContainer(const Slot& slot) const
+{
+    std::string cmd = "docker rm -f " + slot.name +
+#ifdef _WIN32
+        " > NUL 2>&1";
+#else
+        " > /dev/null 2>&1";
+#endif
+    std::system(cmd.c_str());
+}
+
+bool ContainerPool::recreateContainer(const Slot& slot) const
+{
+    removeContainer(slot);
+    if (!startContainer(slot)) {
+        return false;
+    }
+    resetContainer(slot); // la carpeta host puede traer restos del anterior
+    return true;
+}
+
+// ============================================================================
+// acquire
+// Entrega el primer slot libre y sano. Si solo quedan libres slots rotos,
+// intenta recrear uno (fuera del lock); si falla y no hay ningún slot
+// sano que esperar, lanza. Las esperas se registran en stats.
+// ============================================================================
+ContainerPool::Lease ContainerPool::acquire()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    auto findFree = [this](bool broken) {
+        return std::find_if(slots_.begin(), slots_.end(),
+                            [broken](const Slot& s) { return !s.busy && s.broken == broken; });
+    };
+    auto allBroken = [this]() {
+        return std::all_of(slots_.begin(), slots_.end(),
+                           [](const Slot& s) { return s.broken; });
+    };
+
+    bool waited = false;
+    auto waitStart = std::chrono::steady_clock::now();
+    bool tryBroken = true; // tras un intento fallido, solo se esperan slots sanos
+
+    for (;;) {
+        auto it = findFree(false);
+        if (it == slots_.end() && tryBroken) {
+            auto broken = findFree(true);
+            if (broken != slots_.end()) {
+                broken->busy = true; // nadie más lo toma mientras se recrea
+                lock.unlock();
+                bool ok = recreateContainer(*broken);
+                lock.lock();
+                broken->busy = false;
+                if (ok) {
+                    broken->broken = false;
+                    broken->leaseCount = 0;
+                    ++stats_.repairs;
+                    it = broken;
+                } else {
+                    ++stats_.repairFailures;
+                    std::cerr << "[ContainerPool] " << broken->name
+                              << " sigue sin poder recrearse\n";
+                    if (allBroken()) {
+                        throw std::runtime_error(
+                            "No hay contenedores disponibles en el pool");
+                    }
+                    tryBroken = false;
+                    available_.notify_all(); // por si otro acquire esperaba este slot
+                }
+            }
+        }
+
+        if (it != slots_.end()) {
+            if (waited) {
+                stats_.totalWaitMs += static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - waitStart).count());
+            }
+            it->busy = true;
+            ++it->leaseCount;
+            ++stats_.leases;
+            return Lease(this, static_cast<std::size_t>(it - slots_.begin()));
+        }
+
+        if (!waited) {
+            waited = true;
+            ++stats_.waits;
+            waitStart = std::chrono::steady_clock::now();
+        }
+        available_.wait(lock);
+        if (allBroken()) {
+            tryBroken = true; // los sanos también se rompieron: volver a intentar
+        }
+    }
+}
+
+// ============================================================================
+// release
+// Limpia o recicla el contenedor fuera del lock y luego lo marca como libre.
+// Si no se puede recrear, el slot queda roto hasta que acquire lo repare.
+// ============================================================================
+void ContainerPool::release(std::size_t index, bool dirty)
+{
+    Slot& slot = slots_[index];
+
+    bool recycle = dirty ||
+        (config_.maxLeasesPerContainer > 0 &&
+         slot.leaseCount >= config_.maxLeasesPerContainer);
+
+    if (!recycle && !resetContainer(slot)) {
+        recycle = true; // si la limpieza falla, no confiamos en el contenedor
+    }
+
+    bool broken = false;
+    if (recycle && !recreateContainer(slot)) {
+        std::cerr << "[ContainerPool] No se pudo recrear " << slot.name
+                  << "; el slot queda fuera de uso\n";
+        broken = true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (recycle) {
+            slot.leaseCount = 0;
+            ++stats_.recycles;
+        } else {
+            ++stats_.resets;
+        }
+        slot.broken = broken;
+        slot.busy = false;
+    }
+    available_.notify_all();
+}
+
+ContainerPoolStats ContainerPool::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ContainerPoolStats s = stats_;
+    s.busy = static_cast<std::size_t>(
+        std::count_if(slots_.begin(), slots_.end(), [](const Slot& x) { return x.busy; }));
+    s.broken = static_cast<std::size_t>(
+        std::count_if(slots_.begin(), slots_.end(),
+                      [](const Slot& x) { return x.broken && !x.busy; }));
+    s.idle = slots_.size() - s.busy - s.broken;
+    return s;
+}
+
+} // namespace engine
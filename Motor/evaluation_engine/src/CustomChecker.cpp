@@ -0,0 +1,221 @@
+#include "CustomChecker.h"
+
+#include "SubmissionFilesystem.h"
+
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <system_error>
+
+namespace {
+
+    // Límites del checker: no dependen del límite del problema.
+    constexpr int kCheckerTimeLimitMs = 10000;
+    constexpr int kCheckerMemoryMb = 512;
+
+    // Máximo de texto del checker que se agrega al runtime log.
+    constexpr std::size_t kMaxMessageBytes = 1024;
+
+    // Carpeta temporal que se borra al salir del scope (salvo keep()).
+    class TempDir {
+    public:
+        explicit TempDir(std::filesystem::path path) : path_(std::move(path)) {}
+        ~TempDir() {
+            if (!path_.empty()) {
+                std::error_code ec;
+                std::filesystem::remove_all(path_, ec);
+            }
+        }
+        TempDir(const TempDir&) = delete;
+        TempDir& operator=(const TempDir&) = delete;
+
+        const std::filesystem::path& path() const { return path_; }
+        void keep() { path_.clear(); }
+
+    private:
+        std::filesystem::path path_;
+    };
+
+    // Siempre copia: ningún archivo de la ejecución comparte inode con algo
+    // que el programa del usuario haya podido tocar.
+    void copyFile(const std::filesystem::path& src, const std::filesystem::path& dst) {
+        std::error_code ec;
+        std::filesystem::copy_file(
+            src, dst, std::filesystem::copy_options::overwrite_existing, ec);
+        if (ec) {
+            throw std::runtime_error(
+                "No se pudo preparar " + dst.string() + ": " + ec.message());
+        }
+    }
+
+    void writeFile(const std::filesystem::path& path, const std::string& data) {
+        std::ofstream out(path, std::ios::binary);
+        out << data;
+        if (!out) {
+            throw std::runtime_error("No se pudo escribir " + path.string());
+        }
+    }
+
+    std::string readFile(const std::filesystem::path& path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(in)),
+                           std::istreambuf_iterator<char>());
+    }
+
+} // namespace
+
+namespace engine {
+
+CustomChecker::CustomChecker(const SandboxRunner& runner, std::filesystem::path checkerRoot)
+    : runner_(runner),
+      root_(std::move(checkerRoot))
+{}
+
+// ============================================================================
+// freshDir
+// Carpeta nueva y vacía en la raíz de los checkers. El prefijo ".tmp-" la
+// marca para sweep() si el motor se corta antes de borrarla.
+// ============================================================================
+std::filesystem::path CustomChecker::freshDir(const std::string& tag) const
+{
+    static std::atomic<unsigned long> counter{0};
+    std::error_code ec;
+    std::filesystem::create_directories(root_, ec);
+    for (;;) {
+        std::filesystem::path dir =
+            root_ / (".tmp-" + tag + "-" + std::to_string(counter++));
+        if (std::filesystem::create_directory(dir, ec)) {
+            return dir;
+        }
+        if (ec) {
+            throw std::runtime_error(
+                "No se pudo crear " + dir.string() + ": " + ec.message());
+        }
+    }
+}
+
+void CustomChecker::sweep(const std::filesystem::path& checkerRoot)
+{
+    std::error_code ec;
+    std::filesystem::directory_iterator it(checkerRoot, ec);
+    for (; !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+        if (it->path().filename().string().rfind(".tmp-", 0) == 0) {
+            std::error_code rmEc;
+            std::filesystem::remove_all(it->path(), rmEc);
+        }
+    }
+}
+
+// ============================================================================
+// build
+// Igual que la submission: main.cpp → main, con la misma clave de cache
+// (código + flags + toolchain). Se compila en una carpeta temporal y el
+// binario se publica copiado en <root>/<clave>: el compilado es del usuario
+// del sandbox, la copia es del motor y nadie más puede escribirla. Si ya
+// está publicado (otra submission del mismo problema) no se compila.
+// ============================================================================
+bool CustomChecker::build(const std::string& source,
+                          CompileCache* cache,
+                          std::string& compileLog)
+{
+    const std::string key =
+        CompileCache::makeKey(source, kCompileFlags, runner_.toolchainId());
+    const std::filesystem::path published = root_ / key;
+
+    std::error_code ec;
+    if (std::filesystem::exists(published / "main", ec)) {
+        binary_ = published / "main";
+        compileLog = readFile(published / "compile.log");
+        return true;
+    }
+
+    TempDir buildDir(freshDir("build"));
+    SubmissionFilesystem::writeSourceFile(buildDir.path(), "main.cpp", source);
+
+    std::optional<int> exitCode;
+    if (cache) {
+        exitCode = cache->restore(key, buildDir.path());
+    }
+    if (!exitCode) {
+        exitCode = runner_.compile(buildDir.path(), "main.cpp").exitCode;
+        if (cache) {
+            cache->store(key, buildDir.path(), *exitCode);
+        }
+    }
+
+    compileLog = readFile(buildDir.path() / "compile.log");
+    if (*exitCode != 0) {
+        return false;
+    }
+
+    TempDir stage(freshDir("stage"));
+    copyFile(buildDir.path() / "main", stage.path() / "main");
+    copyFile(buildDir.path() / "compile.log", stage.path() / "compile.log");
+    using std::filesystem::perms;
+    std::filesystem::permissions(
+        stage.path() / "main",
+        perms::owner_read | perms::owner_exec | perms::group_read |
+        perms::group_exec | perms::others_read | perms::others_exec,
+        std::filesystem::perm_options::replace, ec);
+
+    // Si otro build la publicó primero, el rename falla y se usa esa
+    std::filesystem::rename(stage.path(), published, ec);
+    if (!ec) {
+        stage.keep();
+    }
+    if (!std::filesystem::exists(published / "main", ec)) {
+        throw std::runtime_error(
+            "No se pudo publicar el checker en " + published.string());
+    }
+    binary_ = published / "main";
+    return true;
+}
+
+// ============================================================================
+// check
+// Cada test usa su propia carpeta nueva, así varios tests se verifican en
+// paralelo sin pisarse los archivos y ninguno hereda lo que dejó otro.
+// ============================================================================
+CheckerVerdict CustomChecker::check(const TestCase& tc,
+                                    const std::filesystem::path& outputFile) const
+{
+    TempDir runDir(freshDir("run"));
+    const std::filesystem::path& testDir = runDir.path();
+
+    copyFile(binary_, testDir / "main");
+    copyFile(outputFile, testDir / "output.txt");
+    writeFile(testDir / "input.txt", tc.input);
+    writeFile(testDir / "expected.txt", tc.expectedOutput);
+
+    RunLimits limits;
+    limits.timeLimitMs = kCheckerTimeLimitMs;
+    limits.memoryLimitMb = kCheckerMemoryMb;
+
+    RunResult run = runner_.runSingleTest(
+        testDir, "output.txt", "checker.out", "checker.log", limits);
+
+    CheckerVerdict verdict;
+    verdict.message = readFile(testDir / "checker.out") + readFile(testDir / "checker.log");
+    if (verdict.message.size() > kMaxMessageBytes) {
+        verdict.message.resize(kMaxMessageBytes);
+        verdict.message += "...";
+    }
+
+    if (!run.executed) {
+        verdict.failed = true;
+        verdict.message += "[checker no ejecutado]";
+    } else if (run.timedOut) {
+        verdict.failed = true;
+        verdict.message += "[checker excedió el tiempo]";
+    } else if (run.exitCode == 0 || run.exitCode == 1) {
+        verdict.accepted = run.exitCode == 0;
+    } else {
+        verdict.failed = true;
+        verdict.message += "[checker terminó con código " + std::to_string(run.exitCode) + "]";
+    }
+    return verdict;
+}
+
+} // namespace engine
@@ -1,10 +1,108 @@
 #include "DockerRunner.h"
 
+#include "PrecompiledHeaders.h"
+
 #include <algorithm>
+#include <array>
+#include <cstdio>
 #include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#else
+#include "PipePump.h"
+
+#include <chrono>
+#include <thread>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    // Ejecuta un comando y devuelve su stdout (sin el salto de línea final).
+    std::string captureCommand(const std::string& cmd) {
+        std::string out;
+        std::FILE* pipe = popen(cmd.c_str(), "r");
+        if (!pipe) {
+            return out;
+        }
+        std::array<char, 256> buf{};
+        while (std::fgets(buf.data(), static_cast<int>(buf.size()), pipe)) {
+            out += buf.data();
+        }
+        pclose(pipe);
+        while (!out.empty() && (out.back() == '\n' || out.back() == '\r')) {
+            out.pop_back();
+        }
+        return out;
+    }
+
+    // Convierte una línea "clave=valor clave=valor ..." de judge-driver en un mapa.
+    std::map<std::string, std::string> parseRecordLine(const std::string& line) {
+        std::map<std::string, std::string> fields;
+        std::istringstream iss(line);
+        std::string token;
+        while (iss >> token) {
+            auto eq = token.find('=');
+            if (eq != std::string::npos) {
+                fields[token.substr(0, eq)] = token.substr(eq + 1);
+            }
+        }
+        return fields;
+    }
+
+    // Registros de judge-driver con <resultados> = "-": cada uno es la línea
+    // que sigue a una línea "#judge-driver#" en el stderr del driver.
+    std::vector<std::map<std::string, std::string>> parseDriverRecords(const std::string& stream) {
+        std::vector<std::map<std::string, std::string>> records;
+        std::istringstream iss(stream);
+        std::string line;
+        while (std::getline(iss, line)) {
+            if (line == "#judge-driver#" && std::getline(iss, line)) {
+                records.push_back(parseRecordLine(line));
+            }
+        }
+        return records;
+    }
+
+    // Dentro del contenedor: el stderr del driver (los registros) pasa a
+    // ser la salida del comando y su stdout, que no se usa, se descarta.
+    constexpr const char* kRecordsToStdout = " 2>&1 >/dev/null";
+
+    int fieldInt(const std::map<std::string, std::string>& fields, const char* key) {
+        auto it = fields.find(key);
+        if (it == fields.end()) {
+            return 0;
+        }
+        try {
+            return std::stoi(it->second);
+        } catch (...) {
+            return 0;
+        }
+    }
+
+    // Copia los campos de un registro de judge-driver al RunResult.
+    void applyRecord(const std::map<std::string, std::string>& fields, engine::RunResult& rr) {
+        rr.exitCode  = fieldInt(fields, "exit");
+        rr.timedOut  = fieldInt(fields, "timed_out") != 0;
+        rr.timeMs    = fieldInt(fields, "wall_ms");
+        rr.cpuTimeMs = fieldInt(fields, "cpu_ms");
+        rr.memoryKb  = fieldInt(fields, "rss_kb");
+        rr.outputLimitExceeded = fieldInt(fields, "output_limit") != 0;
+    }
+
+} // namespace
+
 namespace engine {
 
 // ============================================================================
@@ -14,6 +112,43 @@ DockerRunner::DockerRunner(std::string imageName)
     : imageName_(std::move(imageName))
 {}
 
+// ============================================================================
+// useContainer
+// Cambia a modo pool: los comandos se lanzan con `docker exec` sobre un
+// contenedor ya iniciado en lugar de crear uno nuevo por paso.
+// ============================================================================
+void DockerRunner::useContainer(std::string containerName,
+                                std::filesystem::path hostMountDir)
+{
+    containerName_ = std::move(containerName);
+    hostMountDir_  = std::move(hostMountDir);
+}
+
+// ============================================================================
+// toolchainId
+// Digest de la imagen: si se reconstruye la imagen (otro g++), cambia la
+// clave del cache de compilación. Se memoriza por nombre de imagen.
+// ============================================================================
+std::string DockerRunner::toolchainId() const
+{
+    static std::mutex mutex;
+    static std::map<std::string, std::string> digests;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = digests.find(imageName_);
+    if (it != digests.end()) {
+        return it->second;
+    }
+
+    std::string digest = captureCommand(
+        "docker image inspect --format \"{{.Id}}\" " + imageName_);
+    if (digest.empty()) {
+        return imageName_; // sin Docker disponible: no se memoriza
+    }
+    digests[imageName_] = digest;
+    return digest;
+}
+
 // ============================================================================
 // buildVolumeArgument
 // Construye el argumento de volumen para Docker:
@@ -35,10 +170,27 @@ std::string DockerRunner::buildVolumeArgument(
     return oss.str();
 }
 
+// ============================================================================
+// containerWorkdir
+// - modo normal: la submission se monta directamente en /workspace
+// - modo pool: se monta la carpeta del slot, la submission es una subcarpeta
+// ============================================================================
+std::string DockerRunner::containerWorkdir(
+    const std::filesystem::path& submissionDir) const
+{
+    if (containerName_.empty()) {
+        return "/workspace";
+    }
+
+    std::string rel = std::filesystem::relative(submissionDir, hostMountDir_).string();
+    std::replace(rel.begin(), rel.end(), '\\', '/');
+    return "/workspace/" + rel;
+}
+
 // ============================================================================
 // compile
 // Ejecuta dentro del contenedor Docker:
-//   g++ main.cpp -O2 -std=c++20 -o main
+//   g++ [-include /opt/pch/<set>.h] main.cpp -O2 -std=c++20 -o main
 // El stderr se redirige a compile.log dentro del host.
 // ============================================================================
 CompileResult DockerRunner::compile(
@@ -46,18 +198,33 @@ CompileResult DockerRunner::compile(
     const std::string& sourceFileName) const
 {
     CompileResult result;
-    std::string volumeArg = buildVolumeArgument(submissionDir);
 
     std::ostringstream cmd;
-    cmd << "docker run --rm "
-        << "--network=none "          // sin acceso a red
-        << "--memory=512m "           // límite de memoria
-        << "--cpus=1 "                // una CPU
-        << volumeArg
-        << imageName_ << " "
-        << "/bin/bash -lc \"cd /workspace && "
-        << "g++ " << sourceFileName
-        << " -O2 -std=c++20 -o main 2> compile.log\"";
+    if (containerName_.empty()) {
+        cmd << "docker run --rm "
+            << "--network=none "          // sin acceso a red
+            << "--memory=512m "           // límite de memoria
+            << "--cpus=1 "                // una CPU
+            << buildVolumeArgument(submissionDir)
+            << imageName_ << " ";
+    } else {
+        cmd << "docker exec -u runner " << containerName_ << " ";
+    }
+    cmd << "/bin/bash -lc \"cd " << containerWorkdir(submissionDir) << " && ";
+
+    // Encabezado precompilado: solo si la imagen lo trae (imágenes viejas
+    // no tienen /opt/pch y se compila como siempre)
+    std::string gpp = "g++ " + sourceFileName + " " + kCompileFlags + " -o main";
+    auto pch = PrecompiledHeaders::selectForFile(submissionDir / sourceFileName);
+    if (pch) {
+        std::string header = std::string(PrecompiledHeaders::kImageDir) + "/" + *pch;
+        cmd << "if [ -f " << header << ".gch ]; "
+            << "then g++ -include " << header << " " << sourceFileName
+            << " " << kCompileFlags << " -o main; "
+            << "else " << gpp << "; fi 2> compile.log\"";
+    } else {
+        cmd << gpp << " 2> compile.log\"";
+    }
 
     // Ruta al log dentro del host
     result.logFilePath = (submissionDir / "compile.log").string();
@@ -71,53 +238,284 @@ CompileResult DockerRunner::compile(
 
 // ============================================================================
 // runSingleTest
-// Ejecuta un test dentro de Docker con:
-//   - timeout
-//   - /usr/bin/time -v (para obtener memoria)
-//   - límites (memoria, CPU, pids)
-//
-// El input se redirige "< input_#.txt"
-// El output se escribe en "output_#.txt"
-// El stderr va a runtime_#.log
+// Ejecuta un test dentro de Docker con judge-driver:
+//   judge-driver --stdin input_#.txt --stdout output_#.txt --stderr runtime_#.log
+// El driver mide el propio ./main (CPU user+sys, tiempo real y RSS con
+// wait4), así el arranque y la limpieza del contenedor no cuentan como
+// tiempo del programa. Un `timeout` externo acota la invocación completa.
+// Con --output-bytes el driver detiene al programa (RLIMIT_FSIZE) apenas
+// escribe más que limits.outputLimitBytes.
+// El registro se lee del stderr del driver y no de un archivo en la carpeta
+// montada, donde el programa podría escribir uno falso.
 // ============================================================================
 RunResult DockerRunner::runSingleTest(
     const std::filesystem::path& submissionDir,
     const std::string& inputFileName,
     const std::string& outputFileName,
     const std::string& runtimeLogName,
-    int timeLimitSeconds,
     const RunLimits& limits) const
 {
-    RunResult result;
-    std::string volumeArg = buildVolumeArgument(submissionDir);
-
     std::ostringstream cmd;
-    cmd << "docker run --rm "
-        << "--network=none "
-        << "--memory=" << limits.memoryLimitMb << "m "
-        << "--cpus=" << limits.cpuLimit << " "
-        << "--pids-limit=" << limits.pidsLimit << " "
-        << volumeArg
-        << imageName_ << " "
-        << "/bin/bash -lc \"cd /workspace && "
-        << "timeout " << timeLimitSeconds << "s "
-        << "/usr/bin/time -v ./main < " << inputFileName
-        << " > " << outputFileName
-        << " 2> " << runtimeLogName << "\"";
+    if (containerName_.empty()) {
+        cmd << "docker run --rm "
+            << "--network=none "
+            << "--memory=" << limits.memoryLimitMb << "m "
+            << "--cpus=" << limits.cpuLimit << " "
+            << "--pids-limit=" << limits.pidsLimit << " "
+            << buildVolumeArgument(submissionDir)
+            << imageName_ << " ";
+    } else {
+        // El contenedor del pool ya tiene red, CPU y pids limitados;
+        // la memoria del test la acota el driver con RLIMIT_AS.
+        cmd << "docker exec -u runner " << containerName_ << " ";
+    }
+    cmd << "/bin/bash -lc \"cd " << containerWorkdir(submissionDir) << " && "
+        << "timeout " << limits.effectiveWallLimitMs() / 1000 + 5 << "s "
+        << "judge-driver "
+        << "--time-ms " << limits.timeLimitMs << " "
+        << "--wall-ms " << limits.effectiveWallLimitMs() << " "
+        << "--memory-mb " << limits.memoryLimitMb << " "
+        << "--output-bytes " << limits.outputLimitBytes << " "
+        << "--stdin " << inputFileName << " "
+        << "--stdout " << outputFileName << " "
+        << "--stderr " << runtimeLogName << " "
+        << "- single" << kRecordsToStdout << "\"";
+
+    auto records = parseDriverRecords(captureCommand(cmd.str()));
 
     // Rutas finales de salida y log
+    RunResult result;
     result.outputPath     = (submissionDir / outputFileName).string();
     result.runtimeLogPath = (submissionDir / runtimeLogName).string();
 
-    int exitCode = std::system(cmd.str().c_str());
-    result.exitCode = exitCode;
+    if (!records.empty()) {
+        applyRecord(records.back(), result);
+    } else {
+        result.executed = false; // el driver no llegó a ejecutar el test
+    }
+
+    return result;
+}
 
-    // timeout devuelve 124 → time limit exceeded
-    if (exitCode == 124) {
-        result.timedOut = true;
+// ============================================================================
+// runInMemory
+// Lanza el CLI de Docker como subproceso con pipes propios:
+//   docker exec -i ... judge-driver --stdin - --stdout - --stderr - - mem
+// El input se escribe en su stdin y la salida del programa se lee de su
+// stdout; el registro del driver llega al final de stderr. En la carpeta de
+// la submission solo se usa el binario. El driver reenvía como mucho
+// maxOutputBytes y mata al programa si escribe más (output_limit=1).
+// ============================================================================
+RunResult DockerRunner::runInMemory(
+    const std::filesystem::path& submissionDir,
+    const std::string& input,
+    std::size_t maxOutputBytes,
+    const RunLimits& limits) const
+{
+#ifdef _WIN32
+    // Sin pipes POSIX: mismo resultado pasando por archivos temporales
+    const std::string inputName = "input_mem.txt";
+    const std::string outputName = "output_mem.txt";
+    const std::string logName = "runtime_mem.log";
+    {
+        std::ofstream in(submissionDir / inputName, std::ios::binary);
+        in << input;
     }
+    RunResult result = runSingleTest(submissionDir, inputName, outputName, logName, limits);
+
+    std::ifstream out(submissionDir / outputName, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(out)), std::istreambuf_iterator<char>());
+    result.outputTruncated = data.size() > maxOutputBytes;
+    result.outputLimitExceeded = result.outputLimitExceeded || result.outputTruncated;
+    data.resize(std::min(data.size(), maxOutputBytes));
+    result.output = std::move(data);
 
+    std::ifstream log(submissionDir / logName, std::ios::binary);
+    result.runtimeLog.assign(std::istreambuf_iterator<char>(log), std::istreambuf_iterator<char>());
     return result;
+#else
+    RunResult result;
+
+    std::vector<std::string> args = {"docker"};
+    if (containerName_.empty()) {
+        std::string hostPath = std::filesystem::absolute(submissionDir).string();
+        args.insert(args.end(), {
+            "run", "--rm", "-i", "--network=none",
+            "--memory=" + std::to_string(limits.memoryLimitMb) + "m",
+            "--cpus=" + std::to_string(limits.cpuLimit),
+            "--pids-limit=" + std::to_string(limits.pidsLimit),
+            "-v", hostPath + ":/workspace",
+            "-w", "/workspace",
+            imageName_});
+    } else {
+        args.insert(args.end(), {
+            "exec", "-i", "-u", "runner",
+            "-w", containerWorkdir(submissionDir),
+            containerName_});
+    }
+    args.insert(args.end(), {
+        "judge-driver",
+        "--time-ms", std::to_string(limits.timeLimitMs),
+        "--wall-ms", std::to_string(limits.effectiveWallLimitMs()),
+        "--memory-mb", std::to_string(limits.memoryLimitMb),
+        "--output-bytes", std::to_string(maxOutputBytes),
+        "--stdin", "-", "--stdout", "-", "--stderr", "-",
+        "-", "mem"});
+
+    std::vector<char*> argv;
+    for (auto& a : args) {
+        argv.push_back(a.data());
+    }
+    argv.push_back(nullptr);
+
+    int pipes[3][2] = {{-1, -1}, {-1, -1}, {-1, -1}};
+    for (auto& p : pipes) {
+        if (pipe2(p, O_CLOEXEC) != 0) {
+            for (auto& q : pipes) {
+                if (q[0] >= 0) { close(q[0]); close(q[1]); }
+            }
+            result.executed = false;
+            return result;
+        }
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(pipes[0][0], STDIN_FILENO);
+        dup2(pipes[1][1], STDOUT_FILENO);
+        dup2(pipes[2][1], STDERR_FILENO);
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+    close(pipes[0][0]);
+    close(pipes[1][1]);
+    close(pipes[2][1]);
+
+    PipePump pump(input, maxOutputBytes, 64 * 1024);
+    pump.attach(pipes[0][1], pipes[1][0], pipes[2][0]);
+    if (pid < 0) {
+        result.executed = false;
+        return result;
+    }
+
+    // Tope para el CLI completo (arranque del contenedor incluido)
+    auto deadline = std::chrono::steady_clock::now() +
+        std::chrono::milliseconds(limits.effectiveWallLimitMs() + 10000);
+    int status = 0;
+    for (;;) {
+        pid_t r = waitpid(pid, &status, WNOHANG);
+        if (r == pid || (r < 0 && errno != EINTR)) {
+            break;
+        }
+        if (std::chrono::steady_clock::now() > deadline) {
+            kill(pid, SIGKILL);
+        }
+        if (!pump.pump(1)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    pump.finish();
+
+    // stderr = <stderr del programa> "\n#judge-driver#\n" <registro>
+    std::string& errors = pump.errors();
+    const std::string marker = "\n#judge-driver#\n";
+    auto pos = errors.rfind(marker);
+    if (pos == std::string::npos) {
+        result.executed = false;
+        result.runtimeLog = std::move(errors);
+        return result;
+    }
+    applyRecord(parseRecordLine(errors.substr(pos + marker.size())), result);
+    errors.resize(pos);
+
+    result.runtimeLog = std::move(errors);
+    result.output = std::move(pump.output());
+    result.outputTruncated = pump.outputTruncated();
+    result.outputLimitExceeded = result.outputLimitExceeded || result.outputTruncated;
+    return result;
+#endif
+}
+
+// ============================================================================
+// runBatch
+// Una sola invocación de Docker para todos los tests:
+//   judge-driver --time-ms T --memory-mb M - 1 2 3 ...
+// El driver aplica timeout y rlimits a cada test y registra exit code,
+// tiempo de CPU, tiempo real, RSS máximo y si hubo timeout. Los registros
+// llegan por su stderr (fuera del alcance del programa, que escribe en
+// runtime_<id>.log), no por un archivo en la carpeta montada.
+// Un `timeout` externo acota la invocación completa por si el driver falla.
+// Con stopOn el driver deja de lanzar tests tras el primer TLE / error.
+// ============================================================================
+std::vector<RunResult> DockerRunner::runBatch(
+    const std::filesystem::path& submissionDir,
+    const std::vector<std::string>& testIds,
+    const RunLimits& limits,
+    int jobs,
+    FailurePolicy stopOn) const
+{
+    jobs = std::max(1, jobs);
+    int rounds = (static_cast<int>(testIds.size()) + jobs - 1) / jobs;
+    int outerTimeoutSeconds = rounds * (limits.effectiveWallLimitMs() / 1000 + 1) + 5;
+
+    std::ostringstream cmd;
+    if (containerName_.empty()) {
+        cmd << "docker run --rm "
+            << "--network=none "
+            << "--memory=" << limits.memoryLimitMb * jobs << "m "
+            << "--cpus=" << limits.cpuLimit * jobs << " "
+            << "--pids-limit=" << limits.pidsLimit * jobs << " "
+            << buildVolumeArgument(submissionDir)
+            << imageName_ << " ";
+    } else {
+        cmd << "docker exec -u runner " << containerName_ << " ";
+    }
+    cmd << "/bin/bash -lc \"cd " << containerWorkdir(submissionDir) << " && "
+        << "timeout " << outerTimeoutSeconds << "s "
+        << "judge-driver "
+        << "--jobs " << jobs << " "
+        << "--time-ms " << limits.timeLimitMs << " "
+        << "--wall-ms " << limits.effectiveWallLimitMs() << " "
+        << "--memory-mb " << limits.memoryLimitMb << " "
+        << "--output-bytes " << limits.outputLimitBytes << " ";
+    if (stopOn == FailurePolicy::StopOnTimeout) {
+        cmd << "--stop-on timeout ";
+    } else if (stopOn == FailurePolicy::StopOnFailure) {
+        cmd << "--stop-on failure ";
+    }
+    cmd << "-";
+    for (const auto& id : testIds) {
+        cmd << " " << id;
+    }
+    cmd << kRecordsToStdout << "\"";
+
+    // Registros indexados por id
+    std::map<std::string, std::map<std::string, std::string>> records;
+    for (auto& fields : parseDriverRecords(captureCommand(cmd.str()))) {
+        auto it = fields.find("id");
+        if (it != fields.end()) {
+            records[it->second] = std::move(fields);
+        }
+    }
+
+    std::vector<RunResult> results;
+    results.reserve(testIds.size());
+
+    for (const auto& id : testIds) {
+        RunResult rr;
+        rr.outputPath     = (submissionDir / ("output_"  + id + ".txt")).string();
+        rr.runtimeLogPath = (submissionDir / ("runtime_" + id + ".log")).string();
+
+        auto it = records.find(id);
+        if (it == records.end()) {
+            rr.executed = false; // el driver no llegó a este test
+        } else {
+            applyRecord(it->second, rr);
+        }
+        results.push_back(std::move(rr));
+    }
+
+    return results;
 }
 
 } // namespace engine
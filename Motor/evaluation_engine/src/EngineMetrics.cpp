@@ -0,0 +1,172 @@
+#include "EngineMetrics.h"
+
+#include "JsonCodec.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+    constexpr auto kRelaxed = std::memory_order_relaxed;
+
+    const char* phaseName(engine::MetricsPhase phase) {
+        switch (phase) {
+            case engine::MetricsPhase::FileWrite:  return "file_write";
+            case engine::MetricsPhase::Lease:      return "lease";
+            case engine::MetricsPhase::Compile:    return "compile";
+            case engine::MetricsPhase::Spawn:      return "spawn";
+            case engine::MetricsPhase::Run:        return "run";
+            case engine::MetricsPhase::Compare:    return "compare";
+            case engine::MetricsPhase::Evaluation: return "evaluation";
+            case engine::MetricsPhase::Count_:     break;
+        }
+        return "unknown";
+    }
+
+    // Número en el formato de Prometheus (15 dígitos: 0.0025 y no 0.0025000000000000001).
+    std::string formatValue(double value) {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%.15g", value);
+        return buf;
+    }
+
+    void appendHeader(std::string& out, const std::string& name,
+                      const char* type, const std::string& help) {
+        out += "# HELP " + name + " " + help + "\n";
+        out += "# TYPE " + name + " " + type + "\n";
+    }
+
+} // namespace
+
+namespace engine {
+
+void LatencyHistogram::observe(std::chrono::microseconds duration)
+{
+    const double seconds = static_cast<double>(duration.count()) / 1e6;
+    std::size_t i = 0;
+    while (i < kBoundsSeconds.size() && seconds > kBoundsSeconds[i]) {
+        ++i;
+    }
+    buckets_[i].fetch_add(1, kRelaxed);
+    sumMicros_.fetch_add(static_cast<std::uint64_t>(std::max<std::int64_t>(0, duration.count())),
+                         kRelaxed);
+    count_.fetch_add(1, kRelaxed);
+}
+
+// ============================================================================
+// render
+// Los buckets de Prometheus son acumulativos (le = "menor o igual que").
+// Las lecturas no son una foto atómica: con registros en curso el total
+// puede diferir en uno o dos del último bucket, lo que Prometheus tolera.
+// ============================================================================
+void LatencyHistogram::render(std::string& out, const std::string& name,
+                              const std::string& labels) const
+{
+    const std::string prefix = labels.empty() ? "" : labels + ",";
+    std::uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < buckets_.size(); ++i) {
+        cumulative += buckets_[i].load(kRelaxed);
+        std::string le = i < kBoundsSeconds.size() ? formatValue(kBoundsSeconds[i]) : "+Inf";
+        out += name + "_bucket{" + prefix + "le=\"" + le + "\"} " +
+               std::to_string(cumulative) + "\n";
+    }
+    const std::string braces = labels.empty() ? "" : "{" + labels + "}";
+    out += name + "_sum" + braces + " " +
+           formatValue(static_cast<double>(sumMicros_.load(kRelaxed)) / 1e6) + "\n";
+    out += name + "_count" + braces + " " + std::to_string(count_.load(kRelaxed)) + "\n";
+}
+
+void EngineMetrics::observe(MetricsPhase phase, std::chrono::microseconds duration)
+{
+    auto index = static_cast<std::size_t>(phase);
+    if (index < kPhases) {
+        phases_[index].observe(duration);
+    }
+}
+
+void EngineMetrics::evaluationStarted()
+{
+    inFlight_.fetch_add(1, kRelaxed);
+}
+
+void EngineMetrics::evaluationFinished(OverallStatus status, bool cached)
+{
+    inFlight_.fetch_sub(1, kRelaxed);
+    auto index = static_cast<std::size_t>(status);
+    if (index < kOverallStatuses) {
+        evaluations_[index].fetch_add(1, kRelaxed);
+    }
+    if (cached) {
+        cachedEvaluations_.fetch_add(1, kRelaxed);
+    }
+}
+
+void EngineMetrics::testFinished(TestStatus status)
+{
+    auto index = static_cast<std::size_t>(status);
+    if (index < kTestStatuses) {
+        tests_[index].fetch_add(1, kRelaxed);
+    }
+}
+
+std::string EngineMetrics::render() const
+{
+    std::string out;
+
+    appendHeader(out, "codecoach_phase_duration_seconds", "histogram",
+                 "Latencia de cada fase de una evaluación");
+    for (std::size_t i = 0; i < kPhases; ++i) {
+        phases_[i].render(out, "codecoach_phase_duration_seconds",
+                          std::string("phase=\"") + phaseName(static_cast<MetricsPhase>(i)) + "\"");
+    }
+
+    appendGauge(out, "codecoach_evaluations_in_flight",
+                "Evaluaciones en curso", static_cast<double>(inFlight_.load(kRelaxed)));
+
+    appendHeader(out, "codecoach_evaluations_total", "counter",
+                 "Evaluaciones terminadas por estado global");
+    for (std::size_t i = 0; i < kOverallStatuses; ++i) {
+        out += std::string("codecoach_evaluations_total{status=\"") +
+               JsonCodec::toString(static_cast<OverallStatus>(i)) + "\"} " +
+               std::to_string(evaluations_[i].load(kRelaxed)) + "\n";
+    }
+
+    appendCounter(out, "codecoach_evaluations_cached_total",
+                  "Evaluaciones respondidas desde el cache de veredictos",
+                  static_cast<double>(cachedEvaluations_.load(kRelaxed)));
+
+    appendHeader(out, "codecoach_test_verdicts_total", "counter",
+                 "Tests ejecutados por veredicto");
+    for (std::size_t i = 0; i < kTestStatuses; ++i) {
+        out += std::string("codecoach_test_verdicts_total{status=\"") +
+               JsonCodec::toString(static_cast<TestStatus>(i)) + "\"} " +
+               std::to_string(tests_[i].load(kRelaxed)) + "\n";
+    }
+    return out;
+}
+
+void EngineMetrics::appendCounter(std::string& out, const std::string& name,
+                                  const std::string& help, double value)
+{
+    appendHeader(out, name, "counter", help);
+    out += name + " " + formatValue(value) + "\n";
+}
+
+void EngineMetrics::appendGauge(std::string& out, const std::string& name,
+                                const std::string& help, double value)
+{
+    appendHeader(out, name, "gauge", help);
+    out += name + " " + formatValue(value) + "\n";
+}
+
+void EngineMetrics::appendFamily(std::string& out, const std::string& name,
+                                 const char* type, const std::string& help,
+                                 const std::vector<std::pair<std::string, double>>& samples)
+{
+    appendHeader(out, name, type, help);
+    for (const auto& [labels, value] : samples) {
+        out += name + "{" + labels + "} " + formatValue(value) + "\n";
+    }
+}
+
+} // namespace engine
@@ -2,19 +2,128 @@
 
 #include "SubmissionFilesystem.h"
 #include "DockerRunner.h"
-#include "OutputComparer.h"
+#include "CustomChecker.h"
+#include "Hashing.h"
+#include "OutputChecker.h"
+#include "TestDataCache.h"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <fstream>
 #include <iostream>
 #include <cstdint>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
 #include <system_error>
 
 #include <sstream>
 
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
 namespace {
 
+    // Límite de tamaño de salida por ejecución: 1 MB. El sandbox detiene al
+    // programa en cuanto lo supera (no se espera al timeout ni se llena el disco)
+    constexpr std::uintmax_t MAX_OUTPUT_BYTES = 1 * 1024 * 1024;
+
+    bool runningAsRoot() {
+#ifdef _WIN32
+        return false;
+#else
+        return geteuid() == 0;
+#endif
+    }
+
+    // Devuelve la carpeta de la submission al WorkdirManager al salir de
+    // evaluate (también con excepciones). Se considera fallida si no terminó
+    // Accepted (el estado inicial de EvaluationResult es InternalError).
+    struct WorkdirRelease {
+        engine::WorkdirManager* manager;
+        std::filesystem::path dir;
+        const engine::EvaluationResult& result;
+
+        ~WorkdirRelease() {
+            if (manager) {
+                manager->release(dir, result.overallStatus != engine::OverallStatus::Accepted);
+            }
+        }
+    };
+
+    using SteadyClock = std::chrono::steady_clock;
+
+    std::int64_t microsBetween(SteadyClock::time_point from, SteadyClock::time_point to) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+    }
+
+    // Mide una fase del desglose de tiempos de la submission hasta stop()
+    // (o el destructor). Con span == nullptr (request sin timing) no lee
+    // el reloj.
+    class SpanTimer {
+    public:
+        SpanTimer(engine::PhaseSpan* span, SteadyClock::time_point origin)
+            : span_(span), origin_(origin),
+              start_(span ? SteadyClock::now() : SteadyClock::time_point{}) {}
+
+        ~SpanTimer() { stop(); }
+
+        SpanTimer(const SpanTimer&) = delete;
+        SpanTimer& operator=(const SpanTimer&) = delete;
+
+        void stop() {
+            if (span_) {
+                span_->startUs = microsBetween(origin_, start_);
+                span_->durationUs = microsBetween(start_, SteadyClock::now());
+                span_ = nullptr;
+            }
+        }
+
+    private:
+        engine::PhaseSpan* span_;
+        SteadyClock::time_point origin_;
+        SteadyClock::time_point start_;
+    };
+
+    // Cuenta la evaluación como "en curso" mientras dura evaluate y al salir
+    // (también con excepciones o retornos tempranos) registra su estado
+    // final y la latencia total.
+    struct EvaluationMetricsScope {
+        engine::EngineMetrics* metrics;
+        const engine::EvaluationResult& result;
+        engine::PhaseTimer timer;
+
+        EvaluationMetricsScope(engine::EngineMetrics* m, const engine::EvaluationResult& r)
+            : metrics(m), result(r), timer(m, engine::MetricsPhase::Evaluation) {
+            if (metrics) {
+                metrics->evaluationStarted();
+            }
+        }
+
+        ~EvaluationMetricsScope() {
+            if (metrics) {
+                timer.stop();
+                metrics->evaluationFinished(result.overallStatus, result.cached);
+            }
+        }
+    };
+
+    // ============================================================================
+    // leasedContainerCapacity
+    // Tests que caben a la vez en un contenedor del pool sin competir por sus
+    // límites: una CPU entera por test (si no, el tope de tiempo real da TLE
+    // falsos), su memoria y sus procesos completos. Siempre al menos 1.
+    // ============================================================================
+    std::size_t leasedContainerCapacity(const engine::ContainerPoolConfig& pool,
+                                        const engine::RunLimits& limits) {
+        int byCpu = static_cast<int>(pool.cpuLimit);
+        int byMemory = pool.memoryLimitMb / std::max(1, limits.memoryLimitMb);
+        int byPids = pool.pidsLimit / std::max(1, limits.pidsLimit);
+        return static_cast<std::size_t>(std::max(1, std::min({byCpu, byMemory, byPids})));
+    }
+
     // ============================================================================
     // extractMaxMemoryKb
     // Extrae del runtime.log la línea con:
@@ -52,47 +161,253 @@ namespace engine {
 EvaluationService::EvaluationService(std::filesystem::path baseDir,
                                      std::string dockerImage)
     : baseDir_(std::move(baseDir)),
-      dockerImage_(std::move(dockerImage))
-{}
+      dockerImage_(std::move(dockerImage)),
+      checkerDir_(baseDir_ / "checkers")
+{
+    CustomChecker::sweep(checkerDir_);
+}
+
+void EvaluationService::setContainerPool(std::shared_ptr<ContainerPool> pool)
+{
+    pool_ = std::move(pool);
+}
+
+void EvaluationService::setBatchMode(bool enabled)
+{
+    batchMode_ = enabled;
+}
+
+void EvaluationService::setTestParallelism(std::shared_ptr<ThreadPool> pool,
+                                           int defaultParallelism)
+{
+    testPool_ = std::move(pool);
+    parallelism_ = std::max(1, defaultParallelism);
+}
+
+void EvaluationService::setInMemoryIo(bool enabled)
+{
+    inMemoryIo_ = enabled;
+}
+
+void EvaluationService::setCompileCache(std::shared_ptr<CompileCache> cache)
+{
+    compileCache_ = std::move(cache);
+}
+
+void EvaluationService::setVerdictCache(std::shared_ptr<VerdictCache> cache)
+{
+    verdictCache_ = std::move(cache);
+}
+
+void EvaluationService::setRunSessions(std::shared_ptr<RunSessionStore> sessions)
+{
+    runSessions_ = std::move(sessions);
+}
+
+void EvaluationService::setMetrics(std::shared_ptr<EngineMetrics> metrics)
+{
+    metrics_ = std::move(metrics);
+}
+
+void EvaluationService::setWorkdirManager(std::shared_ptr<WorkdirManager> workdirs)
+{
+    workdirs_ = std::move(workdirs);
+}
+
+void EvaluationService::setBackend(SandboxBackend backend,
+                                   NativeSandboxConfig nativeConfig)
+{
+    backend_ = backend;
+    nativeConfig_ = std::move(nativeConfig);
+}
+
+// ============================================================================
+// makeRunner
+// Runner del backend elegido. Si es Docker, *docker apunta a él (para
+// asignarle un contenedor del pool).
+// ============================================================================
+std::unique_ptr<SandboxRunner> EvaluationService::makeRunner(DockerRunner** docker) const
+{
+    *docker = nullptr;
+    if (backend_ == SandboxBackend::Native) {
+        return std::make_unique<NativeSandboxRunner>(nativeConfig_);
+    }
+    auto dockerPtr = std::make_unique<DockerRunner>(dockerImage_);
+    *docker = dockerPtr.get();
+    return dockerPtr;
+}
+
+// ============================================================================
+// compileWithCache
+// Compila dir/main.cpp. Cache de compilación: mismo código + flags +
+// toolchain = mismo binario, así que se reutiliza sin invocar al compilador.
+// ============================================================================
+CompileResult EvaluationService::compileWithCache(const SandboxRunner& runner,
+                                                  const std::filesystem::path& dir,
+                                                  const std::string& sourceCode) const
+{
+    CompileResult comp;
+    std::optional<int> cachedExit;
+    std::string cacheKey;
+    if (compileCache_) {
+        cacheKey = CompileCache::makeKey(sourceCode, kCompileFlags, runner.toolchainId());
+        cachedExit = compileCache_->restore(cacheKey, dir);
+    }
+
+    if (cachedExit) {
+        comp.exitCode = *cachedExit;
+        comp.logFilePath = (dir / "compile.log").string();
+    } else {
+        comp = runner.compile(dir, "main.cpp");
+        if (compileCache_) {
+            compileCache_->store(cacheKey, dir, comp.exitCode);
+        }
+    }
+    return comp;
+}
 
 // ============================================================================
 // evaluate
 // Orquesta tod0 el flujo:
 //
+// 0) Devolver el veredicto guardado si la misma submission ya se evaluó
 // 1) Crear carpeta submission
 // 2) Escribir archivo fuente y archivos input/expected
 // 3) Compilar
 // 4) Ejecutar test por test
 // 5) Medir tiempo/memoria
-// 6) Comparar salida con expected_output
+// 6) Comparar salida con expected_output (checker del problema)
 // 7) Construir EvaluationResult final
+//
+// Con request.collectTiming cada fase queda además en result.timing (y la
+// de cada test en su TestResult::timing).
 // ============================================================================
-EvaluationResult EvaluationService::evaluate(const SubmissionRequest& request)
+EvaluationResult EvaluationService::evaluate(const SubmissionRequest& request,
+                                             EvaluationObserver* observer)
 {
     EvaluationResult result;
     result.submissionId = request.submissionId;
+    EvaluationMetricsScope metricsScope{metrics_.get(), result};
+    EngineMetrics* metrics = metrics_.get();
+
+    // Desglose de tiempos: solo si el request lo pide (timing == nullptr
+    // deja todos los SpanTimer sin efecto)
+    const auto origin = SteadyClock::now();
+    EvaluationTiming* timing = nullptr;
+    if (request.collectTiming) {
+        result.timing.emplace();
+        result.timing->startedAtUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        timing = &*result.timing;
+    }
+    auto finishTiming = [&] {
+        if (timing) {
+            timing->totalUs = microsBetween(origin, SteadyClock::now());
+        }
+    };
 
+    std::string verdictKey;
     try {
         // -------------------------
-        // 1. Crear directorio
+        // 0. Sandbox y cache de veredictos
+        // -------------------------
+        DockerRunner* docker = nullptr;
+        std::unique_ptr<SandboxRunner> runnerPtr = makeRunner(&docker);
+        const SandboxRunner& runner = *runnerPtr;
+
+        // Misma fuente, tests, límites y toolchain = mismo veredicto: se
+        // devuelve el guardado sin tomar contenedor ni carpeta. El observer
+        // recibe los mismos eventos que en una evaluación normal.
+        if (verdictCache_) {
+            verdictKey = VerdictCache::makeKey(request, runner.toolchainId());
+            if (request.bypassVerdictCache) {
+                verdictCache_->countBypass();
+            } else if (auto hit = verdictCache_->find(verdictKey)) {
+                hit->submissionId = request.submissionId;
+                if (observer) {
+                    observer->onCompiled(
+                        hit->overallStatus != OverallStatus::CompilationError,
+                        hit->compileLog);
+                    for (std::size_t i = 0; i < hit->tests.size(); ++i) {
+                        observer->onTestFinished(i, hit->tests[i]);
+                    }
+                }
+                hit->timing = std::move(result.timing);
+                result = std::move(*hit);
+                finishTiming();
+                return result;
+            }
+        }
+
+        // -------------------------
+        // 1. Tomar contenedor del pool (si hay)
         // -------------------------
-        auto submissionDir =
-            SubmissionFilesystem::createSubmissionDir(baseDir_, request.submissionId);
+        // La carpeta de la submission se crea dentro de la carpeta montada
+        // por el contenedor prestado; el pool la limpia al devolverlo.
+        std::optional<ContainerPool::Lease> lease;
+        if (pool_ && docker) {
+            PhaseTimer leaseTimer(metrics, MetricsPhase::Lease);
+            SpanTimer leaseSpan(timing ? &timing->lease : nullptr, origin);
+            lease.emplace(pool_->acquire());
+            docker->useContainer(lease->containerName(), lease->hostDir());
+        }
 
-        // 2. Escribir código fuente
+        // -------------------------
+        // 2. Crear directorio
+        // -------------------------
+        const std::filesystem::path& parentDir =
+            lease ? lease->hostDir() : (workdirs_ ? workdirs_->root() : baseDir_);
+        SpanTimer createDirSpan(timing ? &timing->createDir : nullptr, origin);
+        auto submissionDir = workdirs_
+            ? workdirs_->create(parentDir, request.submissionId)
+            : SubmissionFilesystem::createSubmissionDir(parentDir, request.submissionId);
+        createDirSpan.stop();
+        WorkdirRelease workdirRelease{workdirs_.get(), submissionDir, result};
+
+        // 3. Escribir código fuente
+        PhaseTimer writeTimer(metrics, MetricsPhase::FileWrite);
+        SpanTimer writeSourceSpan(timing ? &timing->writeSource : nullptr, origin);
         SubmissionFilesystem::writeSourceFile(
             submissionDir, "main.cpp", request.sourceCode);
-
-        // 3. Escribir todos los test cases
-        SubmissionFilesystem::writeTestFiles(
-            submissionDir, request.testCases);
+        writeSourceSpan.stop();
+
+        // 4. Escribir todos los test cases (en modo de I/O en memoria los
+        //    inputs y outputs nunca pasan por disco). Si el request referencia
+        //    un set del TestDataCache, los inputs se enlazan desde el cache y
+        //    los expected se comparan desde memoria.
+        const TestDataSet* cached = request.testData.get();
+        const std::vector<TestCase>& testCases =
+            cached ? cached->testCases : request.testCases;
+
+        const bool inMemory = request.inMemoryIo.value_or(inMemoryIo_);
+        SpanTimer writeTestsSpan(timing ? &timing->writeTests : nullptr, origin);
+        if (!inMemory && cached) {
+            // Hard link solo si el motor es root: los archivos del cache son
+            // de root y solo lectura, y el programa corre con otro usuario.
+            // Si no, el programa podría modificar el inode compartido.
+            TestDataCache::linkInputs(*cached, submissionDir, runningAsRoot());
+        } else if (!inMemory) {
+            SubmissionFilesystem::writeTestFiles(
+                submissionDir, request.testCases);
+        }
+        writeTestsSpan.stop();
+        writeTimer.stop();
 
         // -------------------------
-        // 2. Compilar
+        // 5. Compilar
         // -------------------------
-        DockerRunner runner(dockerImage_);
-
-        auto comp = runner.compile(submissionDir, "main.cpp");
+        PhaseTimer compileTimer(metrics, MetricsPhase::Compile);
+        SpanTimer compileSpan(timing ? &timing->compile : nullptr, origin);
+        CompileResult comp = compileWithCache(runner, submissionDir, request.sourceCode);
+        compileSpan.stop();
+        compileTimer.stop();
+
+        // Falla del sandbox: termina como InternalError (que no se cachea)
+        // en vez de un CompilationError sin log
+        if (compileDidNotRun(comp)) {
+            throw std::runtime_error(
+                "El sandbox no llegó a compilar (código " + std::to_string(comp.exitCode) + ")");
+        }
 
         // Leer compile.log
         std::ifstream compLog(comp.logFilePath);
@@ -102,20 +417,124 @@ EvaluationResult EvaluationService::evaluate(const SubmissionRequest& request)
                 std::istreambuf_iterator<char>());
         }
 
+        if (observer) {
+            observer->onCompiled(comp.exitCode == 0, result.compileLog);
+        }
+
         // Si compilación falló
         if (comp.exitCode != 0) {
             result.overallStatus = OverallStatus::CompilationError;
+            if (verdictCache_) {
+                verdictCache_->store(verdictKey, result);
+            }
+            finishTiming();
             return result;
         }
 
+        // Checker propio del problema: se compila (o sale del cache) antes
+        // de correr los tests. Si no compila es un error del problema, no
+        // de la submission. Vive en checkerDir_ y corre con un runner propio
+        // (sin el contenedor prestado), fuera del alcance de la submission.
+        const CheckerSpec& checkerSpec = request.checker;
+        std::unique_ptr<SandboxRunner> checkerRunner;
+        std::optional<CustomChecker> customChecker;
+        if (checkerSpec.type == CheckerType::Custom) {
+            DockerRunner* unpooled = nullptr;
+            checkerRunner = makeRunner(&unpooled);
+            customChecker.emplace(*checkerRunner, checkerDir_);
+            std::string checkerLog;
+            if (!customChecker->build(checkerSpec.source, compileCache_.get(), checkerLog)) {
+                result.overallStatus = OverallStatus::InternalError;
+                result.compileLog += "\n[CHECKER] No compiló el checker del problema:\n";
+                result.compileLog += checkerLog;
+                finishTiming();
+                return result;
+            }
+        }
+
         // -------------------------
-        // 3. Ejecutar test cases
+        // 6. Ejecutar test cases
         // -------------------------
         int maxTimeMs = 0;
         int maxMemoryKb = 0;
 
-        for (const auto& tc : request.testCases) {
-            TestResult tr;
+        // Configurar límites de ejecución (iguales para todos los tests)
+        RunLimits limits;
+
+        // Límite de CPU en ms (sin redondear) y tope de tiempo real opcional
+        limits.timeLimitMs = request.timeLimitMs > 0 ? request.timeLimitMs : 2000;
+        limits.wallLimitMs = std::max(0, request.wallTimeLimitMs);
+
+        // memoria → convertir KB a MB
+        if (request.memoryLimitKb > 0) {
+            limits.memoryLimitMb = std::max(16, request.memoryLimitKb / 1024);
+        } else {
+            limits.memoryLimitMb = 256;
+        }
+
+        limits.cpuLimit  = 1.0;
+        limits.pidsLimit = 64;
+
+        limits.outputLimitBytes = MAX_OUTPUT_BYTES;
+
+        // Tests en paralelo: por request o el default del motor (1 = secuencial)
+        const std::size_t testCount = testCases.size();
+        std::size_t parallelism = static_cast<std::size_t>(
+            std::max(1, request.parallelism.value_or(parallelism_)));
+        if (testPool_) {
+            parallelism = std::min(parallelism, testPool_->size());
+        } else {
+            parallelism = 1;
+        }
+        if (lease) {
+            // Todos los tests comparten el contenedor prestado y sus límites
+            parallelism = std::min(parallelism, leasedContainerCapacity(pool_->config(), limits));
+        }
+
+        // Modo batch: una sola invocación del contenedor para todos los tests
+        // (trabaja con archivos, así que no aplica al modo en memoria)
+        const bool batch = !inMemory && request.batchMode.value_or(batchMode_);
+        const FailurePolicy policy = request.failurePolicy;
+
+        // Fail-fast: índice del primer test que cortó la evaluación (npos =
+        // ninguno). Los tests posteriores que aún no empezaron se saltan; los
+        // que ya estaban corriendo en paralelo conservan su veredicto.
+        constexpr std::size_t npos = static_cast<std::size_t>(-1);
+        std::atomic<std::size_t> stopIndex{npos};
+        auto markStop = [&stopIndex](std::size_t i) {
+            std::size_t cur = stopIndex.load();
+            while (i < cur && !stopIndex.compare_exchange_weak(cur, i)) {
+            }
+        };
+
+        std::vector<RunResult> batchResults;
+        if (batch) {
+            std::vector<std::string> ids;
+            ids.reserve(testCount);
+            for (const auto& tc : testCases) {
+                ids.push_back(tc.id);
+            }
+            SpanTimer batchSpan(timing ? &timing->batchRun : nullptr, origin);
+            batchResults = runner.runBatch(
+                submissionDir, ids, limits, static_cast<int>(parallelism), policy);
+            batchSpan.stop();
+            for (std::size_t i = 0; i < batchResults.size(); ++i) {
+                if (batchResults[i].executed && stopsBatch(batchResults[i], policy)) {
+                    markStop(i);
+                    break;
+                }
+            }
+        }
+
+        // Cada índice escribe solo su posición: el orden de result.tests es
+        // siempre el de testCases, sin importar cuál termine primero.
+        std::vector<TestResult> testResults(testCount);
+        std::atomic<bool> anyTimeout{false};
+
+        auto runTest = [&](std::size_t i) {
+            const auto& tc = testCases[i];
+
+            TestResult& tr = testResults[i];
             tr.testId = tc.id;
 
             // Construcción de nombres
@@ -123,89 +542,231 @@ EvaluationResult EvaluationService::evaluate(const SubmissionRequest& request)
             std::string outputFile  = "output_"  + tc.id + ".txt";
             std::string runtimeFile = "runtime_" + tc.id + ".log";
 
-            // Configurar límites de ejecución
-            RunLimits limits;
+            // Saltado por fail-fast: en batch solo si el driver no llegó a
+            // lanzarlo; fuera de batch, si aún no empezó
+            bool skip = policy != FailurePolicy::RunAll && i > stopIndex.load() &&
+                        (!batch || !batchResults[i].executed);
+            if (skip) {
+                tr.status = TestStatus::Skipped;
+                if (metrics) {
+                    metrics->testFinished(tr.status);
+                }
+                if (observer) {
+                    observer->onTestFinished(i, tr);
+                }
+                return;
+            }
 
-            // time limit → mínimo 1s
-            limits.timeLimitSeconds = std::max(1, request.timeLimitMs / 1000);
+            TestTiming* testTiming = nullptr;
+            if (timing) {
+                tr.timing.emplace();
+                testTiming = &*tr.timing;
+            }
 
-            // memoria → convertir KB a MB
-            if (request.memoryLimitKb > 0) {
-                limits.memoryLimitMb = std::max(16, request.memoryLimitKb / 1024);
+            RunResult runRes;
+            const auto runStart = SteadyClock::now();
+            if (batch) {
+                runRes = batchResults[i];
+            } else if (inMemory) {
+                // Salida truncada = más de MAX_OUTPUT_BYTES
+                runRes = runner.runInMemory(
+                    submissionDir, tc.input, MAX_OUTPUT_BYTES, limits);
             } else {
-                limits.memoryLimitMb = 256;
+                runRes = runner.runSingleTest(
+                    submissionDir,
+                    inputFile,
+                    outputFile,
+                    runtimeFile,
+                    limits);
             }
 
-            limits.cpuLimit  = 1.0;
-            limits.pidsLimit = 64;
-
-            // Medición de tiempo
-            auto start = std::chrono::steady_clock::now();
-
-            auto runRes = runner.runSingleTest(
-                submissionDir,
-                inputFile,
-                outputFile,
-                runtimeFile,
-                limits.timeLimitSeconds,
-                limits);
-
-            auto end = std::chrono::steady_clock::now();
-            tr.timeMs = static_cast<int>(
-                std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
-
-            if (tr.timeMs > maxTimeMs) {
-                maxTimeMs = tr.timeMs;
+            // Métricas y timing: tiempo del programa y lo que costó el
+            // sandbox alrededor (en batch el arranque es uno solo para todos)
+            if ((metrics || testTiming) && runRes.executed && runRes.timeMs >= 0) {
+                const std::int64_t programUs = std::int64_t{runRes.timeMs} * 1000;
+                const std::int64_t spawnUs = batch ? 0 : std::max<std::int64_t>(
+                    0, microsBetween(runStart, SteadyClock::now()) - programUs);
+                if (metrics) {
+                    metrics->observe(MetricsPhase::Run, std::chrono::microseconds{programUs});
+                    if (!batch) {
+                        metrics->observe(MetricsPhase::Spawn, std::chrono::microseconds{spawnUs});
+                    }
+                }
+                if (testTiming) {
+                    const std::int64_t startUs =
+                        batch ? timing->batchRun.startUs : microsBetween(origin, runStart);
+                    testTiming->spawn = PhaseSpan{startUs, spawnUs};
+                    testTiming->execution = PhaseSpan{startUs + spawnUs, programUs};
+                }
             }
 
+            // Tiempos del propio programa medidos por el sandbox; el tiempo
+            // reportado es el de CPU (no depende de la carga del host)
+            tr.wallTimeMs = std::max(0, runRes.timeMs);
+            tr.cpuTimeMs  = std::max(0, runRes.cpuTimeMs);
+            tr.timeMs     = runRes.cpuTimeMs >= 0 ? tr.cpuTimeMs : tr.wallTimeMs;
+
             // Leer runtime log
-            std::ifstream rt(runRes.runtimeLogPath);
-            if (rt) {
-                tr.runtimeLog.assign(
-                    (std::istreambuf_iterator<char>(rt)),
-                    std::istreambuf_iterator<char>());
+            SpanTimer logReadSpan(testTiming ? &testTiming->logRead : nullptr, origin);
+            if (inMemory) {
+                tr.runtimeLog = std::move(runRes.runtimeLog);
+            } else {
+                std::ifstream rt(runRes.runtimeLogPath);
+                if (rt) {
+                    tr.runtimeLog.assign(
+                        (std::istreambuf_iterator<char>(rt)),
+                        std::istreambuf_iterator<char>());
+                }
             }
+            logReadSpan.stop();
 
-            // Extraer memoria usada
-            tr.memoryKb = extractMaxMemoryKb(tr.runtimeLog);
-            if (tr.memoryKb > maxMemoryKb) {
-                maxMemoryKb = tr.memoryKb;
-            }
+            // Memoria usada: la reporta el sandbox o /usr/bin/time -v en el log
+            tr.memoryKb = runRes.memoryKb >= 0
+                ? runRes.memoryKb
+                : extractMaxMemoryKb(tr.runtimeLog);
+
+            // Veredicto del checker propio (salida ya escrita en outputPath)
+            auto applyChecker = [&](const std::filesystem::path& outputPath) {
+                CheckerVerdict v;
+                try {
+                    v = customChecker->check(tc, outputPath);
+                } catch (const std::exception& ex) {
+                    v.failed = true;
+                    v.message = ex.what();
+                }
+                tr.status = v.accepted ? TestStatus::Accepted
+                          : v.failed   ? TestStatus::InternalError
+                                       : TestStatus::WrongAnswer;
+                if (!v.message.empty()) {
+                    tr.runtimeLog += "\n[checker] " + v.message;
+                }
+            };
 
             // Clasificar estado del test
-            if (runRes.timedOut) {
+            // El exceso de salida va antes que TLE/RE: el programa muere por
+            // SIGXFSZ o SIGKILL justamente porque superó el límite
+            if (!runRes.executed) {
+                tr.status = TestStatus::InternalError;
+            }
+            else if (runRes.outputLimitExceeded ||
+                     (inMemory && runRes.outputTruncated)) {
+                tr.status = TestStatus::OutputLimitExceeded;
+                tr.runtimeLog +=
+                    "\n[Output limit exceeded: more than " +
+                    std::to_string(MAX_OUTPUT_BYTES) + " bytes]\n";
+            }
+            else if (runRes.timedOut) {
                 tr.status = TestStatus::TimeLimitExceeded;
+                anyTimeout = true;
             }
             else if (runRes.exitCode != 0) {
                 tr.status = TestStatus::RuntimeError;
             }
+            else if (inMemory) {
+                PhaseTimer compareTimer(metrics, MetricsPhase::Compare);
+                SpanTimer compareSpan(testTiming ? &testTiming->compare : nullptr, origin);
+                // Caso /run: no se compara expected_output
+                if (tc.expectedOutput.empty()) {
+                    tr.status = TestStatus::Accepted;
+                } else if (customChecker) {
+                    // El checker lee archivos: solo aquí la salida pasa por disco
+                    auto outputPath = submissionDir / outputFile;
+                    {
+                        std::ofstream out(outputPath, std::ios::binary);
+                        out << runRes.output;
+                    }
+                    applyChecker(outputPath);
+                } else {
+                    OutputDiff diff;
+                    bool ok = OutputChecker::accepts(
+                        checkerSpec, runRes.output, tc.expectedOutput, &diff);
+                    tr.status = ok ? TestStatus::Accepted : TestStatus::WrongAnswer;
+                    if (!ok && diff.line > 0) {
+                        tr.diff = std::move(diff);
+                    }
+                }
+            }
             else {
-                // Límite de tamaño de salida: 1 MB
-                constexpr std::uintmax_t MAX_OUTPUT_BYTES = 1 * 1024 * 1024;
-
+                PhaseTimer compareTimer(metrics, MetricsPhase::Compare);
+                SpanTimer compareSpan(testTiming ? &testTiming->compare : nullptr, origin);
                 std::error_code ecSize;
                 auto outputPath = submissionDir / outputFile;
                 auto outSize = std::filesystem::file_size(outputPath, ecSize);
 
+                // Respaldo por si el sandbox no aplicó el límite
                 if (!ecSize && outSize > MAX_OUTPUT_BYTES) {
-                    tr.status = TestStatus::RuntimeError;
+                    tr.status = TestStatus::OutputLimitExceeded;
                     tr.runtimeLog +=
                         "\n[Output limit exceeded: " + std::to_string(outSize) + " bytes]\n";
                 } else {
                     // Caso /run: no se compara expected_output
                     if (tc.expectedOutput.empty()) {
                         tr.status = TestStatus::Accepted;
+                    } else if (customChecker) {
+                        applyChecker(outputPath);
                     } else {
-                        // Comparación tolerante
-                        bool ok = OutputComparer::areEqual(
-                            submissionDir / outputFile,
-                            submissionDir / ("expected_" + tc.id + ".txt"));
+                        // Checker integrado del problema. Con tests del cache
+                        // el expected ya está en memoria (la salida está
+                        // acotada a MAX_OUTPUT_BYTES)
+                        bool ok;
+                        OutputDiff diff;
+                        if (cached) {
+                            std::ifstream out(outputPath, std::ios::binary);
+                            std::string text((std::istreambuf_iterator<char>(out)),
+                                             std::istreambuf_iterator<char>());
+                            ok = OutputChecker::accepts(
+                                checkerSpec, text, tc.expectedOutput, &diff);
+                        } else {
+                            ok = OutputChecker::acceptsFiles(
+                                checkerSpec,
+                                outputPath,
+                                submissionDir / ("expected_" + tc.id + ".txt"),
+                                &diff);
+                        }
 
                         tr.status = ok ? TestStatus::Accepted : TestStatus::WrongAnswer;
+                        if (!ok && diff.line > 0) {
+                            tr.diff = std::move(diff);
+                        }
                     }
                 }
             }
 
+            bool stops =
+                (policy == FailurePolicy::StopOnTimeout &&
+                 tr.status == TestStatus::TimeLimitExceeded) ||
+                (policy == FailurePolicy::StopOnFailure &&
+                 tr.status != TestStatus::Accepted);
+            if (stops) {
+                markStop(i);
+            }
+
+            if (metrics) {
+                metrics->testFinished(tr.status);
+            }
+            if (observer) {
+                observer->onTestFinished(i, tr);
+            }
+        };
+
+        // En batch el sandbox ya paralelizó; aquí solo queda leer y comparar
+        if (testPool_) {
+            testPool_->parallelFor(testCount, parallelism, runTest);
+        } else {
+            for (std::size_t i = 0; i < testCount; ++i) {
+                runTest(i);
+            }
+        }
+
+        // Un TLE puede dejar procesos colgados: reciclar el contenedor
+        if (anyTimeout && lease && pool_->config().recycleOnTimeout) {
+            lease->markDirty();
+        }
+
+        // Agregación en orden de tests (determinista)
+        for (auto& tr : testResults) {
+            maxTimeMs   = std::max(maxTimeMs, tr.timeMs);
+            maxMemoryKb = std::max(maxMemoryKb, tr.memoryKb);
             result.tests.push_back(std::move(tr));
         }
 
@@ -214,7 +775,7 @@ EvaluationResult EvaluationService::evaluate(const SubmissionRequest& request)
         result.maxMemoryKb = maxMemoryKb;
 
         // -------------------------
-        // 4. Estado global
+        // 7. Estado global
         // -------------------------
         bool allAccepted = true;
         bool anyAccepted = false;
@@ -243,7 +804,134 @@ EvaluationResult EvaluationService::evaluate(const SubmissionRequest& request)
         result.compileLog += ex.what();
     }
 
+    // Los InternalError no se guardan (VerdictCache::store los descarta)
+    if (verdictCache_ && !verdictKey.empty()) {
+        verdictCache_->store(verdictKey, result);
+    }
+    finishTiming();
     return result;
 }
 
+// ============================================================================
+// run
+// POST /run: ejecuta el código con un stdin, sin comparar nada. El binario
+// queda en la sesión; solo se recompila si cambia la fuente (o el
+// toolchain), así que volver a correr con otro input no compila ni crea
+// carpetas. Con pool, el binario se copia a la carpeta del contenedor
+// prestado en cada ejecución.
+// ============================================================================
+RunOutcome EvaluationService::run(const RunRequest& request)
+{
+    if (!runSessions_) {
+        throw std::runtime_error("Las sesiones de /run no están activas");
+    }
+
+    RunOutcome outcome;
+    std::shared_ptr<RunSession> session = runSessions_->acquire(request.sessionId);
+    outcome.sessionId = session->id;
+    outcome.run.testId = "1";
+
+    std::lock_guard<std::mutex> sessionLock(session->mutex);
+    try {
+        DockerRunner* docker = nullptr;
+        std::unique_ptr<SandboxRunner> runnerPtr = makeRunner(&docker);
+        const SandboxRunner& runner = *runnerPtr;
+
+        std::optional<ContainerPool::Lease> lease;
+        std::filesystem::path workDir = session->dir;
+        if (pool_ && docker) {
+            lease.emplace(pool_->acquire());
+            docker->useContainer(lease->containerName(), lease->hostDir());
+            workDir = SubmissionFilesystem::createSubmissionDir(lease->hostDir(), session->id);
+        }
+
+        // Compilar solo si la sesión no tiene binario para esta fuente
+        const std::string sourceKey = sha256Hex(
+            request.language + '\0' + request.sourceCode + '\0' + runner.toolchainId());
+        if (session->sourceKey != sourceKey) {
+            session->sourceKey.clear(); // si algo falla, se recompila la próxima vez
+            SubmissionFilesystem::writeSourceFile(workDir, "main.cpp", request.sourceCode);
+            PhaseTimer compileTimer(metrics_.get(), MetricsPhase::Compile);
+            CompileResult comp = compileWithCache(runner, workDir, request.sourceCode);
+            compileTimer.stop();
+            if (compileDidNotRun(comp)) {
+                throw std::runtime_error(
+                    "El sandbox no llegó a compilar (código " + std::to_string(comp.exitCode) + ")");
+            }
+
+            session->compileLog.clear();
+            std::ifstream compLog(comp.logFilePath);
+            if (compLog) {
+                session->compileLog.assign(
+                    (std::istreambuf_iterator<char>(compLog)),
+                    std::istreambuf_iterator<char>());
+            }
+            session->compileOk = comp.exitCode == 0;
+            if (session->compileOk && workDir != session->dir) {
+                std::filesystem::copy_file(workDir / "main", session->dir / "main",
+                    std::filesystem::copy_options::overwrite_existing);
+            }
+            session->sourceKey = sourceKey;
+            outcome.compiled = true;
+        } else if (session->compileOk && workDir != session->dir) {
+            std::filesystem::copy_file(session->dir / "main", workDir / "main",
+                std::filesystem::copy_options::overwrite_existing);
+        }
+
+        outcome.compileOk = session->compileOk;
+        outcome.compileLog = session->compileLog;
+        if (!outcome.compileOk) {
+            return outcome;
+        }
+
+        RunLimits limits;
+        limits.timeLimitMs = request.timeLimitMs > 0 ? request.timeLimitMs : 2000;
+        limits.memoryLimitMb = request.memoryLimitKb > 0
+            ? std::max(16, request.memoryLimitKb / 1024)
+            : 256;
+        limits.outputLimitBytes = MAX_OUTPUT_BYTES;
+
+        RunResult runRes = runner.runInMemory(workDir, request.input, MAX_OUTPUT_BYTES, limits);
+
+        TestResult& tr = outcome.run;
+        tr.wallTimeMs = std::max(0, runRes.timeMs);
+        tr.cpuTimeMs  = std::max(0, runRes.cpuTimeMs);
+        tr.timeMs     = runRes.cpuTimeMs >= 0 ? tr.cpuTimeMs : tr.wallTimeMs;
+        tr.runtimeLog = std::move(runRes.runtimeLog);
+        tr.memoryKb   = runRes.memoryKb >= 0
+            ? runRes.memoryKb
+            : extractMaxMemoryKb(tr.runtimeLog);
+
+        if (!runRes.executed) {
+            tr.status = TestStatus::InternalError;
+        } else if (runRes.outputLimitExceeded || runRes.outputTruncated) {
+            tr.status = TestStatus::OutputLimitExceeded;
+            tr.runtimeLog +=
+                "\n[Output limit exceeded: more than " +
+                std::to_string(MAX_OUTPUT_BYTES) + " bytes]\n";
+        } else if (runRes.timedOut) {
+            tr.status = TestStatus::TimeLimitExceeded;
+            if (lease && pool_->config().recycleOnTimeout) {
+                lease->markDirty();
+            }
+        } else if (runRes.exitCode != 0) {
+            tr.status = TestStatus::RuntimeError;
+        } else {
+            tr.status = TestStatus::Accepted;
+        }
+        outcome.output = std::move(runRes.output);
+
+    } catch (const std::exception& ex) {
+        outcome.run.status = TestStatus::InternalError;
+        outcome.run.runtimeLog += "\n[INTERNAL ERROR] ";
+        outcome.run.runtimeLog += ex.what();
+    }
+    return outcome;
+}
+
+bool EvaluationService::endRunSession(const std::string& sessionId)
+{
+    return runSessions_ && runSessions_->remove(sessionId);
+}
+
 } // namespace engine
@@ -0,0 +1,492 @@
+#include "JobQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <sstream>
+
+namespace {
+
+    // Id corto y no adivinable: contador + sufijo aleatorio.
+    std::string makeJobId() {
+        static std::atomic<std::uint64_t> counter{0};
+        static thread_local std::mt19937_64 rng{std::random_device{}()};
+        std::ostringstream oss;
+        oss << "job-" << ++counter << "-" << std::hex << (rng() & 0xffffffffULL);
+        return oss.str();
+    }
+
+    // Unidad del stride scheduling: el stride de un carril es kStrideUnit /
+    // peso, así que a mayor peso menos avanza su tiempo virtual por job.
+    constexpr std::uint64_t kStrideUnit = 1 << 20;
+
+    template <class Duration>
+    std::int64_t toMs(Duration d) {
+        return static_cast<std::int64_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(d).count());
+    }
+
+} // namespace
+
+namespace engine {
+
+// ============================================================================
+// Constructor: arranca los hilos de trabajo.
+// ============================================================================
+JobQueue::JobQueue(Handler handler, JobQueueConfig config)
+    : handler_(std::move(handler)),
+      config_(config)
+{
+    config_.workers = std::max<std::size_t>(1, config_.workers);
+    config_.capacity = std::max<std::size_t>(1, config_.capacity);
+    for (auto& w : config_.laneWeights) {
+        w = std::max(1u, w);
+    }
+    stats_.capacity = config_.capacity;
+    stats_.workers = config_.workers;
+    for (std::size_t i = 0; i < kLaneCount; ++i) {
+        stats_.lanes[i].weight = config_.laneWeights[i];
+    }
+
+    for (std::size_t i = 0; i < config_.workers; ++i) {
+        workers_.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+// ============================================================================
+// Destructor: los jobs en ejecución terminan; los que esperaban se descartan.
+// ============================================================================
+JobQueue::~JobQueue()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        for (auto& lane : lanes_) {
+            lane.byClient.clear();
+            lane.rotation.clear();
+            lane.depth = 0;
+        }
+        queued_ = 0;
+    }
+    workAvailable_.notify_all();
+    jobUpdated_.notify_all();
+    for (auto& t : workers_) {
+        t.join();
+    }
+}
+
+// ============================================================================
+// enqueue
+// Pone el job al final de la fila de su cliente. Un carril que estaba
+// vacío retoma desde el tiempo virtual actual más su stride: no acumula
+// crédito por el tiempo que no tuvo jobs ni se adelanta a los que esperan.
+// ============================================================================
+bool JobQueue::enqueue(const std::shared_ptr<Job>& job)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto laneIndex = static_cast<std::size_t>(job->lane);
+    LaneQueue& lane = lanes_[laneIndex];
+    LaneStats& laneStats = stats_.lanes[laneIndex];
+
+    auto client = lane.byClient.find(job->clientKey);
+    const std::size_t clientDepth = client == lane.byClient.end() ? 0 : client->second.size();
+    if (stopping_ || queued_ >= config_.capacity ||
+        (config_.maxQueuedPerClient > 0 && clientDepth >= config_.maxQueuedPerClient)) {
+        ++stats_.rejected;
+        ++laneStats.rejected;
+        return false;
+    }
+
+    job->id = makeJobId();
+    job->enqueuedAt = Clock::now();
+
+    if (lane.depth == 0) {
+        lane.pass = std::max(lane.pass, globalPass_) + stride(laneIndex);
+    }
+    if (clientDepth == 0) {
+        lane.rotation.push_back(job->clientKey);
+    }
+    lane.byClient[job->clientKey].push_back(job);
+    ++lane.depth;
+    ++queued_;
+
+    if (job->retained) {
+        jobs_[job->id] = job;
+    }
+    ++stats_.submitted;
+    ++laneStats.submitted;
+    workAvailable_.notify_one();
+    return true;
+}
+
+std::optional<std::string> JobQueue::submit(SubmissionRequest request)
+{
+    auto job = std::make_shared<Job>();
+    job->lane = request.lane;
+    job->clientKey = request.clientKey;
+    job->request = std::move(request);
+    if (!enqueue(job)) {
+        return std::nullopt;
+    }
+    return job->id;
+}
+
+std::optional<EvaluationResult> JobQueue::evaluate(SubmissionRequest request)
+{
+    auto job = std::make_shared<Job>();
+    job->lane = request.lane;
+    job->clientKey = request.clientKey;
+    job->request = std::move(request);
+    job->retained = false;
+    if (!enqueue(job) || !waitDone(job)) {
+        return std::nullopt;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::move(job->result);
+}
+
+bool JobQueue::execute(Lane lane, const std::string& clientKey, std::function<void()> task)
+{
+    auto job = std::make_shared<Job>();
+    job->lane = lane;
+    job->clientKey = clientKey;
+    job->task = std::move(task);
+    job->retained = false;
+    if (!enqueue(job) || !waitDone(job)) {
+        return false;
+    }
+    if (job->taskError) {
+        std::rethrow_exception(job->taskError);
+    }
+    return true;
+}
+
+// false = la cola se detuvo antes de que el job terminara.
+bool JobQueue::waitDone(const std::shared_ptr<Job>& job)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    jobUpdated_.wait(lock, [&]() { return job->state == JobState::Done || stopping_; });
+    return job->state == JobState::Done;
+}
+
+std::uint64_t JobQueue::stride(std::size_t lane) const
+{
+    return kStrideUnit / config_.laneWeights[lane];
+}
+
+// ============================================================================
+// popNext
+// El carril con menor tiempo virtual (a igualdad, el de mayor prioridad:
+// Interactive, Graded, Rejudge) y dentro de él el cliente al que le toca.
+// lane.pass es el tiempo virtual en que "termina" el próximo job del
+// carril; cada job lo avanza en su stride.
+// ============================================================================
+std::shared_ptr<JobQueue::Job> JobQueue::popNext()
+{
+    std::size_t best = kLaneCount;
+    for (std::size_t i = 0; i < kLaneCount; ++i) {
+        if (lanes_[i].depth > 0 && (best == kLaneCount || lanes_[i].pass < lanes_[best].pass)) {
+            best = i;
+        }
+    }
+    LaneQueue& lane = lanes_[best];
+    globalPass_ = lane.pass;
+
+    std::string clientKey = std::move(lane.rotation.front());
+    lane.rotation.pop_front();
+    auto client = lane.byClient.find(clientKey);
+    std::shared_ptr<Job> job = std::move(client->second.front());
+    client->second.pop_front();
+    if (client->second.empty()) {
+        lane.byClient.erase(client);
+    } else {
+        lane.rotation.push_back(std::move(clientKey));
+    }
+    --lane.depth;
+    --queued_;
+    if (lane.depth > 0) {
+        lane.pass += stride(best);
+    }
+    return job;
+}
+
+// ============================================================================
+// workerLoop
+// Toma el siguiente job según los carriles, lo evalúa (o corre su tarea)
+// fuera del lock y publica el resultado.
+// ============================================================================
+void JobQueue::workerLoop()
+{
+    for (;;) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            workAvailable_.wait(lock, [this]() { return stopping_ || queued_ > 0; });
+            if (stopping_) {
+                return;
+            }
+            job = popNext();
+
+            job->state = JobState::Running;
+            job->startedAt = Clock::now();
+            auto waitMs = static_cast<std::uint64_t>(toMs(job->startedAt - job->enqueuedAt));
+            stats_.totalWaitMs += waitMs;
+            stats_.maxWaitMs = std::max(stats_.maxWaitMs, waitMs);
+            ++stats_.running;
+
+            LaneStats& laneStats = stats_.lanes[static_cast<std::size_t>(job->lane)];
+            ++laneStats.started;
+            laneStats.totalWaitMs += waitMs;
+            laneStats.maxWaitMs = std::max(laneStats.maxWaitMs, waitMs);
+        }
+
+        EvaluationResult result;
+        if (job->task) {
+            try {
+                job->task();
+            } catch (...) {
+                job->taskError = std::current_exception();
+            }
+            job->task = nullptr;
+        } else {
+            try {
+                JobObserver observer(*this, *job);
+                result = handler_(job->request, job->retained ? &observer : nullptr);
+            } catch (const std::exception& ex) {
+                result.submissionId = job->request.submissionId;
+                result.overallStatus = OverallStatus::InternalError;
+                result.compileLog = std::string("[INTERNAL ERROR] ") + ex.what();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job->result = std::move(result);
+            job->state = JobState::Done;
+            job->finishedAt = Clock::now();
+            job->request = SubmissionRequest{}; // libera código e inputs
+
+            --stats_.running;
+            ++stats_.completed;
+            stats_.totalRunMs += static_cast<std::uint64_t>(toMs(job->finishedAt - job->startedAt));
+
+            if (job->retained) {
+                EvaluationEvent done;
+                done.type = EvaluationEventType::Finished;
+                done.summary.submissionId = job->result.submissionId;
+                done.summary.overallStatus = job->result.overallStatus;
+                done.summary.maxTimeMs = job->result.maxTimeMs;
+                done.summary.maxMemoryKb = job->result.maxMemoryKb;
+                done.summary.cached = job->result.cached;
+                done.testCount = job->result.tests.size();
+                done.acceptedCount = static_cast<std::size_t>(std::count_if(
+                    job->result.tests.begin(), job->result.tests.end(),
+                    [](const TestResult& t) { return t.status == TestStatus::Accepted; }));
+                pushEvent(*job, std::move(done));
+
+                finishedOrder_.push_back(job->id);
+                purgeExpired();
+            }
+        }
+        jobUpdated_.notify_all();
+    }
+}
+
+// ============================================================================
+// purgeExpired
+// Borra resultados terminados más viejos que retentionSeconds o que excedan
+// maxRetained (los más antiguos primero).
+// ============================================================================
+void JobQueue::purgeExpired()
+{
+    auto now = Clock::now();
+    while (!finishedOrder_.empty()) {
+        auto it = jobs_.find(finishedOrder_.front());
+        bool expired = it == jobs_.end() ||
+            finishedOrder_.size() > config_.maxRetained ||
+            now - it->second->finishedAt > std::chrono::seconds(config_.retentionSeconds);
+        if (!expired) {
+            break;
+        }
+        if (it != jobs_.end()) {
+            jobs_.erase(it);
+        }
+        finishedOrder_.pop_front();
+    }
+}
+
+JobSnapshot JobQueue::snapshot(const Job& job) const
+{
+    JobSnapshot snap;
+    snap.id = job.id;
+    snap.state = job.state;
+    snap.lane = job.lane;
+
+    auto now = Clock::now();
+    switch (job.state) {
+        case JobState::Queued:
+            snap.queuePosition = positionOf(job);
+            snap.queuedMs = toMs(now - job.enqueuedAt);
+            break;
+        case JobState::Running:
+            snap.queuedMs = toMs(job.startedAt - job.enqueuedAt);
+            snap.runMs = toMs(now - job.startedAt);
+            break;
+        case JobState::Done:
+            snap.queuedMs = toMs(job.startedAt - job.enqueuedAt);
+            snap.runMs = toMs(job.finishedAt - job.startedAt);
+            snap.result = job.result;
+            break;
+    }
+    return snap;
+}
+
+// ============================================================================
+// positionOf
+// Repite popNext sobre copias (punteros) de las filas hasta llegar al job.
+// Es la posición con los jobs que esperan ahora: uno que llegue después a
+// un carril con más prioridad puede adelantarse. La cola está acotada por
+// capacity, así que el costo también.
+// ============================================================================
+std::size_t JobQueue::positionOf(const Job& job) const
+{
+    using ClientQueue = std::deque<const Job*>;
+    std::array<std::deque<ClientQueue>, kLaneCount> turns; // filas en orden de turno
+    std::array<std::uint64_t, kLaneCount> pass{};
+    for (std::size_t i = 0; i < kLaneCount; ++i) {
+        pass[i] = lanes_[i].pass;
+        for (const auto& clientKey : lanes_[i].rotation) {
+            ClientQueue q;
+            for (const auto& j : lanes_[i].byClient.at(clientKey)) {
+                q.push_back(j.get());
+            }
+            turns[i].push_back(std::move(q));
+        }
+    }
+
+    for (std::size_t position = 1;; ++position) {
+        std::size_t best = kLaneCount;
+        for (std::size_t i = 0; i < kLaneCount; ++i) {
+            if (!turns[i].empty() && (best == kLaneCount || pass[i] < pass[best])) {
+                best = i;
+            }
+        }
+        if (best == kLaneCount) {
+            return 0;
+        }
+        ClientQueue q = std::move(turns[best].front());
+        turns[best].pop_front();
+        const Job* next = q.front();
+        q.pop_front();
+        if (next == &job) {
+            return position;
+        }
+        if (!q.empty()) {
+            turns[best].push_back(std::move(q));
+        }
+        if (!turns[best].empty()) {
+            pass[best] += stride(best);
+        }
+    }
+}
+
+std::optional<JobSnapshot> JobQueue::status(const std::string& id) const
+{
+    return waitFor(id, 0);
+}
+
+std::optional<JobSnapshot> JobQueue::waitFor(const std::string& id, int timeoutMs) const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = jobs_.find(id);
+    if (it == jobs_.end()) {
+        return std::nullopt;
+    }
+    std::shared_ptr<Job> job = it->second;
+
+    if (timeoutMs > 0) {
+        jobUpdated_.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+            [&]() { return job->state == JobState::Done || stopping_; });
+    }
+    return snapshot(*job);
+}
+
+std::optional<JobEvents> JobQueue::events(const std::string& id,
+                                          std::size_t cursor,
+                                          int timeoutMs) const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = jobs_.find(id);
+    if (it == jobs_.end()) {
+        return std::nullopt;
+    }
+    std::shared_ptr<Job> job = it->second;
+
+    if (timeoutMs > 0) {
+        jobUpdated_.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+            [&]() {
+                return job->events.size() > cursor ||
+                       job->state == JobState::Done || stopping_;
+            });
+    }
+
+    JobEvents out;
+    if (cursor < job->events.size()) {
+        out.events.assign(job->events.begin() + static_cast<std::ptrdiff_t>(cursor),
+                          job->events.end());
+    }
+    out.nextCursor = std::max(cursor, job->events.size());
+    out.done = job->state == JobState::Done;
+    return out;
+}
+
+// ============================================================================
+// Eventos de progreso
+// El observer se llama desde el hilo del job (compilación) y desde los
+// hilos de los tests; el mutex de la cola serializa la escritura.
+// ============================================================================
+void JobQueue::pushEvent(Job& job, EvaluationEvent event)
+{
+    event.sequence = job.events.size();
+    job.events.push_back(std::move(event));
+}
+
+void JobQueue::JobObserver::onCompiled(bool success, const std::string& compileLog)
+{
+    EvaluationEvent event;
+    event.type = EvaluationEventType::Compiled;
+    event.compileOk = success;
+    event.compileLog = compileLog;
+    {
+        std::lock_guard<std::mutex> lock(queue_.mutex_);
+        queue_.pushEvent(job_, std::move(event));
+    }
+    queue_.jobUpdated_.notify_all();
+}
+
+void JobQueue::JobObserver::onTestFinished(std::size_t index, const TestResult& test)
+{
+    EvaluationEvent event;
+    event.type = EvaluationEventType::TestFinished;
+    event.testIndex = index;
+    event.test = test;
+    {
+        std::lock_guard<std::mutex> lock(queue_.mutex_);
+        queue_.pushEvent(job_, std::move(event));
+    }
+    queue_.jobUpdated_.notify_all();
+}
+
+JobQueueStats JobQueue::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    JobQueueStats s = stats_;
+    s.depth = queued_;
+    for (std::size_t i = 0; i < kLaneCount; ++i) {
+        s.lanes[i].depth = lanes_[i].depth;
+        s.lanes[i].clients = lanes_[i].rotation.size();
+    }
+    return s;
+}
+
+} // namespace engine
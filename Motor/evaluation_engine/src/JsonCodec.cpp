@@ -0,0 +1,357 @@
+#include "JsonCodec.h"
+
+#include <stdexcept>
+
+namespace engine {
+
+// ============================================================================
+// parseSubmission
+//
+// {
+//   "submission_id": "...",
+//   "problem_id": "...",
+//   "language": "cpp",
+//   "source_code": "...",
+//   "time_limit_ms": 2000,       límite de CPU por test (ms)
+//   "wall_time_limit_ms": 5000,  (opcional) tope de tiempo real
+//   "batch": true,               (opcional) una sola invocación para todos los tests
+//   "parallelism": 4,            (opcional) tests simultáneos
+//   "in_memory_io": true,        (opcional) stdin/stdout por pipes, sin archivos
+//   "failure_policy": "run_all", (opcional) "stop_on_failure" | "stop_on_timeout":
+//                                los tests restantes se reportan como Skipped
+//   "checker": {                 (opcional) por defecto "exact"
+//     "type": "tokens",          "exact" | "tokens" | "float" | "unordered_lines" | "custom"
+//     "abs_epsilon": 1e-6,       (float) tolerancia absoluta
+//     "rel_epsilon": 1e-6,       (float) tolerancia relativa
+//     "source": "..."            (custom) código C++ del checker
+//   },
+//   "rejudge": true,             (opcional) evaluar aunque haya un veredicto
+//                                guardado en el VerdictCache
+//   "timing": true,              (opcional) desglose de tiempos por fase en
+//                                la respuesta (ver toJson(EvaluationTiming))
+//   "lane": "graded",            (opcional) "interactive" | "graded" | "rejudge";
+//                                por defecto "rejudge" si rejudge, si no "graded"
+//   "client_key": "...",         (opcional) usuario o cliente; la cola reparte
+//                                los workers por igual entre clientes del carril
+//   "test_cases": [{"id", "input", "expected_output"}, ...]
+//   "test_data_key": "..."       (en lugar de test_cases) set subido con
+//                                PUT /testdata/<problem_id>
+// }
+// ============================================================================
+SubmissionRequest JsonCodec::parseSubmission(const nlohmann::json& body)
+{
+    SubmissionRequest sr;
+    sr.submissionId = body.at("submission_id").get<std::string>();
+    sr.problemId    = body.at("problem_id").get<std::string>();
+    sr.language     = body.at("language").get<std::string>();
+    sr.sourceCode   = body.at("source_code").get<std::string>();
+    sr.timeLimitMs  = body.value("time_limit_ms", 2000);
+    sr.wallTimeLimitMs = body.value("wall_time_limit_ms", 0);
+    if (body.contains("batch")) {
+        sr.batchMode = body.at("batch").get<bool>();
+    }
+    if (body.contains("in_memory_io")) {
+        sr.inMemoryIo = body.at("in_memory_io").get<bool>();
+    }
+    if (body.contains("parallelism")) {
+        sr.parallelism = body.at("parallelism").get<int>();
+    }
+    if (body.contains("failure_policy")) {
+        sr.failurePolicy = parseFailurePolicy(body.at("failure_policy").get<std::string>());
+    }
+    if (body.contains("checker")) {
+        sr.checker = parseChecker(body.at("checker"));
+    }
+    sr.bypassVerdictCache = body.value("rejudge", false);
+    sr.collectTiming = body.value("timing", false);
+    sr.lane = sr.bypassVerdictCache ? Lane::Rejudge : Lane::Graded;
+    if (body.contains("lane")) {
+        sr.lane = parseLane(body.at("lane").get<std::string>());
+    }
+    sr.clientKey = body.value("client_key", std::string());
+
+    // test_cases (lista) o la referencia al cache de tests
+    if (body.contains("test_data_key") && !body.contains("test_cases")) {
+        sr.testDataKey = body.at("test_data_key").get<std::string>();
+    } else {
+        sr.testCases = parseTestCases(body.at("test_cases"));
+    }
+    return sr;
+}
+
+// ============================================================================
+// parseRun
+//
+// {
+//   "session_id": "run-...",     (opcional) sesión devuelta por una llamada
+//                                anterior; si venció se crea otra
+//   "language": "cpp",
+//   "source_code": "...",
+//   "input": "...",              stdin del programa
+//   "time_limit_ms": 2000,       (opcional) límite de CPU
+//   "memory_limit_kb": 262144,   (opcional)
+//   "client_key": "..."          (opcional) usuario o cliente (reparto en la cola)
+// }
+// ============================================================================
+RunRequest JsonCodec::parseRun(const nlohmann::json& body)
+{
+    RunRequest rr;
+    rr.sessionId     = body.value("session_id", std::string());
+    rr.language      = body.value("language", std::string("cpp"));
+    rr.sourceCode    = body.at("source_code").get<std::string>();
+    rr.input         = body.value("input", std::string());
+    rr.timeLimitMs   = body.value("time_limit_ms", 2000);
+    rr.memoryLimitKb = body.value("memory_limit_kb", 262144);
+    rr.clientKey     = body.value("client_key", std::string());
+    return rr;
+}
+
+std::vector<TestCase> JsonCodec::parseTestCases(const nlohmann::json& list)
+{
+    std::vector<TestCase> testCases;
+    testCases.reserve(list.size());
+    for (auto& tc : list) {
+        TestCase t;
+        t.id = tc.at("id").get<std::string>();
+        t.input = tc.at("input").get<std::string>();
+        t.expectedOutput = tc.at("expected_output").get<std::string>();
+        testCases.push_back(std::move(t));
+    }
+    return testCases;
+}
+
+nlohmann::json JsonCodec::toJson(const EvaluationResult& er)
+{
+    nlohmann::json result;
+    result["submission_id"]  = er.submissionId;
+    result["overall_status"] = toString(er.overallStatus);
+    result["compile_log"]    = er.compileLog;
+    result["max_time_ms"]    = er.maxTimeMs;
+    result["max_memory_kb"]  = er.maxMemoryKb;
+    result["cached"]         = er.cached;
+    if (er.timing) {
+        result["timing"] = toJson(*er.timing);
+    }
+
+    nlohmann::json testArray = nlohmann::json::array();
+
+    for (auto& t : er.tests) {
+        testArray.push_back(toJson(t));
+    }
+
+    result["tests"] = testArray;
+    return result;
+}
+
+// ============================================================================
+// toJson(TestResult)
+//
+//   {"id": "1", "status": "WrongAnswer", "time_ms": ..., "runtime_log": "...",
+//    "diff": {"line": 3, "column": 5, "expected": "...", "actual": "..."}}
+// "diff" solo aparece en WrongAnswer con checker "exact"; cada fragmento
+// tiene como mucho 2 * kDiffContextBytes bytes más los "..." de recorte.
+// ============================================================================
+nlohmann::json JsonCodec::toJson(const TestResult& t)
+{
+    nlohmann::json jt;
+    jt["id"] = t.testId;
+    jt["time_ms"] = t.timeMs;
+    jt["cpu_time_ms"] = t.cpuTimeMs;
+    jt["wall_time_ms"] = t.wallTimeMs;
+    jt["memory_kb"] = t.memoryKb;
+    jt["status"] = toString(t.status);
+    jt["runtime_log"] = t.runtimeLog;
+    if (t.diff) {
+        // Fragmentos ya acotados por OutputComparer (kDiffContextBytes)
+        jt["diff"] = {
+            {"line", t.diff->line},
+            {"column", t.diff->column},
+            {"expected", t.diff->expected},
+            {"actual", t.diff->actual},
+        };
+    }
+    if (t.timing) {
+        jt["timing"] = toJson(*t.timing);
+    }
+    return jt;
+}
+
+// ============================================================================
+// toJson(EvaluationTiming / TestTiming)
+//
+// Cada fase es {"start_us", "duration_us"}; start_us cuenta desde el
+// inicio de la evaluación, que en reloj del sistema es "started_at_us".
+//   {"started_at_us": ..., "total_us": ..., "lease": {...}, "create_dir": {...},
+//    "write_source": {...}, "write_tests": {...}, "compile": {...},
+//    "batch_run": {...}}
+//   {"spawn": {...}, "execution": {...}, "log_read": {...}, "compare": {...}}
+// ============================================================================
+nlohmann::json JsonCodec::toJson(const PhaseSpan& span)
+{
+    return {{"start_us", span.startUs}, {"duration_us", span.durationUs}};
+}
+
+nlohmann::json JsonCodec::toJson(const EvaluationTiming& timing)
+{
+    nlohmann::json jt;
+    jt["started_at_us"] = timing.startedAtUs;
+    jt["total_us"]      = timing.totalUs;
+    jt["lease"]         = toJson(timing.lease);
+    jt["create_dir"]    = toJson(timing.createDir);
+    jt["write_source"]  = toJson(timing.writeSource);
+    jt["write_tests"]   = toJson(timing.writeTests);
+    jt["compile"]       = toJson(timing.compile);
+    jt["batch_run"]     = toJson(timing.batchRun);
+    return jt;
+}
+
+nlohmann::json JsonCodec::toJson(const TestTiming& timing)
+{
+    nlohmann::json jt;
+    jt["spawn"]     = toJson(timing.spawn);
+    jt["execution"] = toJson(timing.execution);
+    jt["log_read"]  = toJson(timing.logRead);
+    jt["compare"]   = toJson(timing.compare);
+    return jt;
+}
+
+// ============================================================================
+// toJson(RunOutcome)
+//
+//   {"session_id": "run-...", "compiled": false, "compile_ok": true,
+//    "compile_log": "...", "status": "Accepted", "output": "...",
+//    "runtime_log": "...", "time_ms": ..., "memory_kb": ...}
+// "compiled" indica si esta llamada compiló (fuente nueva o cambiada).
+// Si no compiló no hay "status" ni "output" (salvo un error interno).
+// ============================================================================
+nlohmann::json JsonCodec::toJson(const RunOutcome& outcome)
+{
+    nlohmann::json jr;
+    jr["session_id"]  = outcome.sessionId;
+    jr["compiled"]    = outcome.compiled;
+    jr["compile_ok"]  = outcome.compileOk;
+    jr["compile_log"] = outcome.compileLog;
+    if (outcome.compileOk || !outcome.run.runtimeLog.empty()) {
+        nlohmann::json run = toJson(outcome.run);
+        run.erase("id");
+        jr.update(run);
+        jr["output"] = outcome.output;
+    }
+    return jr;
+}
+
+// ============================================================================
+// toJson(EvaluationEvent)
+//
+//   {"seq": 0, "event": "compile", "success": true, "compile_log": "..."}
+//   {"seq": 1, "event": "test", "index": 2, "test": {...}}
+//   {"seq": N, "event": "summary", "submission_id": "...", "overall_status": "...",
+//    "max_time_ms": ..., "max_memory_kb": ..., "tests": 10, "accepted": 7,
+//    "cached": false}
+// ============================================================================
+nlohmann::json JsonCodec::toJson(const EvaluationEvent& event)
+{
+    nlohmann::json je;
+    je["seq"] = event.sequence;
+
+    switch (event.type) {
+        case EvaluationEventType::Compiled:
+            je["event"] = "compile";
+            je["success"] = event.compileOk;
+            je["compile_log"] = event.compileLog;
+            break;
+        case EvaluationEventType::TestFinished:
+            je["event"] = "test";
+            je["index"] = event.testIndex;
+            je["test"] = toJson(event.test);
+            break;
+        case EvaluationEventType::Finished:
+            je["event"] = "summary";
+            je["submission_id"] = event.summary.submissionId;
+            je["overall_status"] = toString(event.summary.overallStatus);
+            je["max_time_ms"] = event.summary.maxTimeMs;
+            je["max_memory_kb"] = event.summary.maxMemoryKb;
+            je["tests"] = event.testCount;
+            je["accepted"] = event.acceptedCount;
+            je["cached"] = event.summary.cached;
+            break;
+    }
+    return je;
+}
+
+CheckerSpec JsonCodec::parseChecker(const nlohmann::json& body)
+{
+    CheckerSpec spec;
+    const std::string type = body.at("type").get<std::string>();
+    if (type == "exact")                spec.type = CheckerType::Exact;
+    else if (type == "tokens")          spec.type = CheckerType::Tokens;
+    else if (type == "float")           spec.type = CheckerType::Float;
+    else if (type == "unordered_lines") spec.type = CheckerType::UnorderedLines;
+    else if (type == "custom")          spec.type = CheckerType::Custom;
+    else throw std::invalid_argument("checker desconocido: " + type);
+
+    spec.absEpsilon = body.value("abs_epsilon", spec.absEpsilon);
+    spec.relEpsilon = body.value("rel_epsilon", spec.relEpsilon);
+    spec.source     = body.value("source", std::string{});
+
+    if (spec.absEpsilon < 0 || spec.relEpsilon < 0) {
+        throw std::invalid_argument("las tolerancias del checker no pueden ser negativas");
+    }
+    if (spec.type == CheckerType::Custom && spec.source.empty()) {
+        throw std::invalid_argument("el checker custom necesita 'source'");
+    }
+    return spec;
+}
+
+FailurePolicy JsonCodec::parseFailurePolicy(const std::string& name)
+{
+    if (name == "run_all")         return FailurePolicy::RunAll;
+    if (name == "stop_on_failure") return FailurePolicy::StopOnFailure;
+    if (name == "stop_on_timeout") return FailurePolicy::StopOnTimeout;
+    throw std::invalid_argument("failure_policy desconocida: " + name);
+}
+
+Lane JsonCodec::parseLane(const std::string& name)
+{
+    if (name == "interactive") return Lane::Interactive;
+    if (name == "graded")      return Lane::Graded;
+    if (name == "rejudge")     return Lane::Rejudge;
+    throw std::invalid_argument("lane desconocido: " + name);
+}
+
+const char* JsonCodec::toString(Lane lane)
+{
+    switch (lane) {
+        case Lane::Interactive: return "interactive";
+        case Lane::Graded:      return "graded";
+        case Lane::Rejudge:     break;
+    }
+    return "rejudge";
+}
+
+const char* JsonCodec::toString(OverallStatus status)
+{
+    switch (status) {
+        case OverallStatus::Accepted:         return "Accepted";
+        case OverallStatus::CompilationError: return "CompilationError";
+        case OverallStatus::PartialAccepted:  return "PartialAccepted";
+        case OverallStatus::InternalError:    break;
+    }
+    return "InternalError";
+}
+
+const char* JsonCodec::toString(TestStatus status)
+{
+    switch (status) {
+        case TestStatus::Accepted:                return "Accepted";
+        case TestStatus::WrongAnswer:             return "WrongAnswer";
+        case TestStatus::RuntimeError:            return "RuntimeError";
+        case TestStatus::TimeLimitExceeded:       return "TimeLimitExceeded";
+        case TestStatus::OutputLimitExceeded:     return "OutputLimitExceeded";
+        case TestStatus::Skipped:                 return "Skipped";
+        case TestStatus::InternalError:           break;
+    }
+    return "InternalError";
+}
+
+} // namespace engine
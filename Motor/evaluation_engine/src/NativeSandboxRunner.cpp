@@ -0,0 +1,1301 @@
+#include "NativeSandboxRunner.h"
+
+#include "PipePump.h"
+#include "PrecompiledHeaders.h"
+
+
+#include <stdexcept>
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <ctime>
+#include <cstddef>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include <fcntl.h>
+#include <grp.h>
+#include <pwd.h>
+#include <sched.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/mount.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/vfs.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <linux/audit.h>
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+
+namespace {
+
+#if defined(__x86_64__)
+    constexpr unsigned int kAuditArch = AUDIT_ARCH_X86_64;
+#elif defined(__aarch64__)
+    constexpr unsigned int kAuditArch = AUDIT_ARCH_AARCH64;
+#else
+    constexpr unsigned int kAuditArch = 0; // arquitectura sin filtro seccomp
+#endif
+
+    // Bits de clone() que crean namespaces nuevos.
+    constexpr unsigned int kNamespaceFlags =
+        CLONE_NEWNS | CLONE_NEWUTS | CLONE_NEWIPC | CLONE_NEWUSER |
+        CLONE_NEWPID | CLONE_NEWNET | CLONE_NEWCGROUP;
+
+    // ============================================================================
+    // buildSeccompFilter
+    // Lista negra de syscalls que un programa de concurso nunca necesita y que
+    // sirven para escapar o inspeccionar el sandbox. Devuelven EPERM, salvo
+    // clone3, que devuelve ENOSYS para que glibc use clone() (que sí se filtra
+    // por flags). Cualquier arquitectura distinta a la nativa se mata.
+    // ============================================================================
+    std::vector<sock_filter> buildSeccompFilter() {
+        std::vector<sock_filter> f;
+
+        auto deny = [&f](long nr, unsigned int err) {
+            f.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, static_cast<unsigned int>(nr), 0, 1));
+            f.push_back(BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ERRNO | (err & SECCOMP_RET_DATA)));
+        };
+
+        f.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(seccomp_data, arch)));
+        f.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, kAuditArch, 1, 0));
+        f.push_back(BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_KILL_PROCESS));
+        f.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(seccomp_data, nr)));
+
+#if defined(__x86_64__)
+        // Syscalls x32 (bit 30): no se usan, se rechazan en bloque
+        f.push_back(BPF_JUMP(BPF_JMP | BPF_JGE | BPF_K, 0x40000000u, 0, 1));
+        f.push_back(BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ERRNO | EPERM));
+#endif
+
+#define CODECOACH_DENY(name) deny(__NR_##name, EPERM)
+        CODECOACH_DENY(ptrace);
+        CODECOACH_DENY(process_vm_readv);
+        CODECOACH_DENY(process_vm_writev);
+        CODECOACH_DENY(mount);
+        CODECOACH_DENY(umount2);
+        CODECOACH_DENY(pivot_root);
+        CODECOACH_DENY(chroot);
+        CODECOACH_DENY(unshare);
+        CODECOACH_DENY(setns);
+        CODECOACH_DENY(socket);
+        CODECOACH_DENY(bpf);
+        CODECOACH_DENY(perf_event_open);
+        CODECOACH_DENY(userfaultfd);
+        CODECOACH_DENY(keyctl);
+        CODECOACH_DENY(add_key);
+        CODECOACH_DENY(request_key);
+        CODECOACH_DENY(kexec_load);
+        CODECOACH_DENY(init_module);
+        CODECOACH_DENY(finit_module);
+        CODECOACH_DENY(delete_module);
+        CODECOACH_DENY(reboot);
+        CODECOACH_DENY(swapon);
+        CODECOACH_DENY(swapoff);
+        CODECOACH_DENY(acct);
+        CODECOACH_DENY(quotactl);
+        CODECOACH_DENY(open_by_handle_at);
+        CODECOACH_DENY(name_to_handle_at);
+#undef CODECOACH_DENY
+#ifdef __NR_clone3
+        deny(__NR_clone3, ENOSYS);
+#endif
+
+        // clone(): permitido salvo que pida namespaces nuevos (args[0] = flags)
+        f.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, __NR_clone, 0, 3));
+        f.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(seccomp_data, args[0])));
+        f.push_back(BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K, kNamespaceFlags, 0, 1));
+        f.push_back(BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ERRNO | EPERM));
+
+        f.push_back(BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW));
+        return f;
+    }
+
+    // Escribe un valor en un archivo de control (cgroup, /proc/<pid>/uid_map).
+    bool writeControlFile(const std::filesystem::path& path, const std::string& value) {
+        std::ofstream out(path);
+        if (!out) {
+            return false;
+        }
+        out << value;
+        out.flush();
+        return static_cast<bool>(out);
+    }
+
+    // Borra el cgroup de una ejecución. Tras matar a pid 1 el resto del pid
+    // namespace muere de forma asíncrona: rmdir puede dar EBUSY un momento.
+    void removeCgroup(const std::filesystem::path& cgroup) {
+        for (int attempt = 0; attempt < 100; ++attempt) {
+            if (rmdir(cgroup.c_str()) == 0 || errno != EBUSY) {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::cerr << "[NativeSandbox] No se pudo borrar el cgroup " << cgroup << "\n";
+    }
+
+    constexpr long kCgroup2Magic = 0x63677270;
+
+    // Comprueba que cgroupRoot sea un cgroup v2 con memory, pids y cpu
+    // habilitados para sus hijos. Si no, deja el motivo en *reason.
+    bool checkCgroupRoot(const std::filesystem::path& root, std::string* reason) {
+        struct statfs st{};
+        if (statfs(root.c_str(), &st) != 0 || static_cast<long>(st.f_type) != kCgroup2Magic) {
+            *reason = root.string() + " no es un cgroup v2";
+            return false;
+        }
+        std::ifstream in(root / "cgroup.subtree_control");
+        std::set<std::string> enabled;
+        for (std::string c; in >> c;) {
+            enabled.insert(c);
+        }
+        for (const char* c : {"memory", "pids", "cpu"}) {
+            if (!enabled.count(c)) {
+                *reason = std::string("el controlador ") + c + " no está delegado en " +
+                          root.string();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Primer id subordinado de `id`/`name` en /etc/subuid o /etc/subgid
+    // (líneas "usuario:inicio:cantidad"); -1 si no tiene.
+    long subordinateStart(const char* file, unsigned long id, const std::string& name) {
+        std::ifstream in(file);
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream iss(line);
+            std::string owner, start, count;
+            if (!std::getline(iss, owner, ':') || !std::getline(iss, start, ':') ||
+                !std::getline(iss, count)) {
+                continue;
+            }
+            if (owner != name && owner != std::to_string(id)) {
+                continue;
+            }
+            try {
+                if (std::stol(count) >= 1) {
+                    return std::stol(start);
+                }
+            } catch (...) {
+            }
+        }
+        return -1;
+    }
+
+    std::string currentUserName() {
+        passwd pw{};
+        passwd* found = nullptr;
+        std::vector<char> buf(4096);
+        if (getpwuid_r(geteuid(), &pw, buf.data(), buf.size(), &found) == 0 && found) {
+            return found->pw_name;
+        }
+        return {};
+    }
+
+    // newuidmap/newgidmap <pid> 0 <propio> 1 1 <subordinado> 1: dentro del
+    // user namespace 0 es el motor (arma los montajes) y 1 el programa.
+    bool runIdMapper(const std::string& tool, pid_t pid, unsigned long own, long sub) {
+        std::vector<std::string> args = {
+            tool, std::to_string(pid), "0", std::to_string(own), "1",
+            "1", std::to_string(sub), "1"};
+        std::vector<char*> argv;
+        for (auto& a : args) {
+            argv.push_back(a.data());
+        }
+        argv.push_back(nullptr);
+
+        pid_t child = -1;
+        if (posix_spawn(&child, tool.c_str(), nullptr, nullptr, argv.data(), environ) != 0) {
+            return false;
+        }
+        int status = 0;
+        while (waitpid(child, &status, 0) < 0) {
+            if (errno != EINTR) {
+                return false;
+            }
+        }
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    // usage_usec de cpu.stat del cgroup (-1 si no se puede leer).
+    long long readCgroupCpuUs(const std::filesystem::path& cgroup) {
+        std::ifstream in(cgroup / "cpu.stat");
+        std::string key;
+        long long value = 0;
+        while (in >> key >> value) {
+            if (key == "usage_usec") {
+                return value;
+            }
+        }
+        return -1;
+    }
+
+    int toMs(const timeval& tv) {
+        return static_cast<int>(tv.tv_sec * 1000 + tv.tv_usec / 1000);
+    }
+
+    // Punto donde pid 1 monta el tmpfs que pasa a ser la raíz. Es /tmp de
+    // su mount namespace privado: lo que hay debajo en el host no se ve.
+    constexpr const char* kNewRoot = "/tmp";
+
+    struct RootBind {
+        const char* source{nullptr};
+        const char* target{nullptr};
+        unsigned long remountFlags{0};  // 0 = queda como el original (rw)
+        bool isFile{false};
+    };
+
+    struct RootLink {
+        const char* target{nullptr};    // contenido del symlink
+        const char* path{nullptr};
+    };
+
+    // ============================================================================
+    // RootfsPlan
+    // Raíz mínima del sandbox, calculada en el padre: pid 1 solo recorre
+    // estas listas (rutas ya prefijadas con kNewRoot).
+    // ============================================================================
+    class RootfsPlan {
+    public:
+        std::vector<const char*> dirs;  // en orden: cada padre antes que sus hijos
+        std::vector<const char*> workDirs; // ruta de la submission, creada después
+                                           // de montar /tmp (puede vivir bajo /tmp)
+        std::vector<RootLink> links;
+        std::vector<RootBind> binds;
+        const char* procDir{nullptr};
+        const char* tmpDir{nullptr};
+        const char* workTarget{nullptr}; // donde se vuelve a montar la submission
+
+        const char* keep(std::string value) {
+            storage_.push_back(std::move(value));
+            return storage_.back().c_str();
+        }
+
+        // Crea (en el plan) `path` y sus padres dentro de la nueva raíz.
+        const char* addDirs(const std::filesystem::path& path) {
+            return addDirsTo(path, dirs);
+        }
+
+        const char* addDirsTo(const std::filesystem::path& path, std::vector<const char*>& into) {
+            std::filesystem::path cur = kNewRoot;
+            for (const auto& part : path.relative_path()) {
+                cur /= part;
+                if (created_.insert(cur.string()).second) {
+                    into.push_back(keep(cur.string()));
+                }
+            }
+            return keep(cur.string());
+        }
+
+    private:
+        std::deque<std::string> storage_;  // deque: c_str() estables al crecer
+        std::set<std::string> created_;
+    };
+
+    // Flags con los que se vuelve a montar de solo lectura un bind del host.
+    // En un user namespace los flags del montaje original (noexec, atime...)
+    // están bloqueados: hay que repetirlos o el remount falla.
+    unsigned long readOnlyRemountFlags(const std::string& path) {
+        unsigned long flags = MS_RDONLY | MS_NOSUID | MS_NODEV;
+        struct statvfs st{};
+        if (statvfs(path.c_str(), &st) == 0) {
+            if (st.f_flag & ST_NOEXEC)     flags |= MS_NOEXEC;
+            if (st.f_flag & ST_NOATIME)    flags |= MS_NOATIME;
+            if (st.f_flag & ST_NODIRATIME) flags |= MS_NODIRATIME;
+            if (st.f_flag & ST_RELATIME)   flags |= MS_RELATIME;
+        }
+        return flags;
+    }
+
+    void planRootfs(const engine::NativeSandboxConfig& config, const std::string& workDir,
+                    RootfsPlan& plan) {
+        std::vector<std::string> readOnly = config.readOnlyPaths;
+        readOnly.push_back(config.pchDir.string());
+
+        for (const auto& path : readOnly) {
+            struct stat st{};
+            if (path.empty() || path[0] != '/' || lstat(path.c_str(), &st) != 0) {
+                continue;
+            }
+            std::filesystem::path p(path);
+            if (S_ISLNK(st.st_mode)) {
+                char target[4096];
+                ssize_t n = readlink(path.c_str(), target, sizeof(target) - 1);
+                if (n <= 0) {
+                    continue;
+                }
+                target[n] = '\0';
+                plan.addDirs(p.parent_path());
+                plan.links.push_back({plan.keep(target), plan.keep(std::string(kNewRoot) + path)});
+            } else if (S_ISDIR(st.st_mode) || S_ISREG(st.st_mode)) {
+                RootBind bind;
+                bind.source = plan.keep(path);
+                bind.isFile = S_ISREG(st.st_mode);
+                if (bind.isFile) {
+                    plan.addDirs(p.parent_path());
+                    bind.target = plan.keep(std::string(kNewRoot) + path);
+                } else {
+                    bind.target = plan.addDirs(p);
+                }
+                bind.remountFlags = readOnlyRemountFlags(path);
+                plan.binds.push_back(bind);
+            }
+        }
+
+        for (const char* dev : {"/dev/null", "/dev/zero", "/dev/full", "/dev/random", "/dev/urandom"}) {
+            if (access(dev, F_OK) == 0) {
+                plan.addDirs("/dev");
+                RootBind bind;
+                bind.source = dev;
+                bind.target = plan.keep(std::string(kNewRoot) + dev);
+                bind.isFile = true;
+                plan.binds.push_back(bind);
+            }
+        }
+
+        plan.procDir = plan.addDirs("/proc");
+        plan.tmpDir = plan.addDirs("/tmp");
+        plan.workTarget = plan.addDirsTo(workDir, plan.workDirs);
+    }
+
+    // ============================================================================
+    // ChildContext
+    // Todo lo que necesita el proceso hijo, preparado ANTES de clone():
+    // entre clone() y exec() solo se usan syscalls (el motor es multihilo).
+    // ============================================================================
+    struct ChildContext {
+        int syncFd{-1};                    // espera a que el padre configure cgroup/uid_map
+        int reportFd{-1};                  // mediciones del programa hacia el padre
+        const char* workDir{nullptr};
+        const char* stdinPath{nullptr};
+        const char* stdoutPath{nullptr};
+        const char* stderrPath{nullptr};
+        int stdinFd{-1};                   // pipes del modo en memoria (-1 = usar *Path)
+        int stdoutFd{-1};
+        int stderrFd{-1};
+        const RootfsPlan* rootfs{nullptr};
+        char* const* argv{nullptr};
+        rlim_t memoryBytes{0};
+        rlim_t cpuSeconds{0};
+        rlim_t maxProcesses{64};           // RLIMIT_NPROC (respaldo de pids.max)
+        rlim_t fileSizeBytes{RLIM_INFINITY}; // tope por archivo escrito (salida)
+        long cpuLimitMs{0};                // límite de CPU del programa (lo aplica pid 1)
+        bool dropPrivileges{false};
+        uid_t uid{0};
+        gid_t gid{0};
+        const sock_fprog* seccomp{nullptr};
+    };
+
+    // Lo que pid 1 mide del programa y envía al padre por reportFd.
+    struct ProgramUsage {
+        long long wallUs{0};
+        long long cpuUs{0};
+        long long maxRssKb{0};
+    };
+
+    // CPU consumida por un proceso vivo, en ms. Solo syscalls (se llama
+    // desde pid 1); si el reloj no está disponible queda el RLIMIT_CPU.
+    long cpuMsOf(pid_t pid) {
+        clockid_t clock;
+        timespec ts{};
+        if (clock_getcpuclockid(pid, &clock) != 0 || clock_gettime(clock, &ts) != 0) {
+            return 0;
+        }
+        return static_cast<long>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+    }
+
+    // fork() sin glibc: el fork() de la biblioteca corre los handlers de
+    // pthread_atfork y toma los locks de malloc, que en la copia de un
+    // proceso multihilo pueden haber quedado tomados por otro hilo del motor
+    // (el hijo se colgaría para siempre). Con todos los argumentos en 0 el
+    // orden de los parámetros de clone, que cambia según la arquitectura,
+    // no importa. El hijo solo hace syscalls hasta el exec.
+    pid_t rawFork() {
+        return static_cast<pid_t>(syscall(SYS_clone, SIGCHLD, 0, 0, 0, 0));
+    }
+
+    // fd fijo del pipe de mediciones dentro de pid 1.
+    constexpr int kReportFd = 3;
+
+    // Cierra todos los fds >= first (close_range si el kernel lo tiene).
+    void closeFrom(int first) {
+#ifdef __NR_close_range
+        if (syscall(__NR_close_range, static_cast<unsigned>(first), ~0U, 0) == 0) {
+            return;
+        }
+#endif
+        rlimit rl{};
+        int maxFd = getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY
+            ? static_cast<int>(rl.rlim_cur) : 4096;
+        for (int fd = first; fd < maxFd; ++fd) {
+            close(fd);
+        }
+    }
+
+    int openOrNull(const char* path, int flags) {
+        return open(path ? path : "/dev/null", flags | O_CLOEXEC, 0644);
+    }
+
+    // Nieto: rlimits, baja de privilegios, seccomp y exec del programa.
+    [[noreturn]] void execTarget(const ChildContext& ctx) {
+        rlimit rlMem{ctx.memoryBytes, ctx.memoryBytes};
+        setrlimit(RLIMIT_AS, &rlMem);
+
+        rlimit rlCpu{ctx.cpuSeconds, ctx.cpuSeconds};
+        setrlimit(RLIMIT_CPU, &rlCpu);
+
+        rlimit rlCore{0, 0};
+        setrlimit(RLIMIT_CORE, &rlCore);
+
+        // Salida: escribir más allá del tope manda SIGXFSZ
+        if (ctx.fileSizeBytes != RLIM_INFINITY) {
+            rlimit rlFsize{ctx.fileSizeBytes, ctx.fileSizeBytes};
+            setrlimit(RLIMIT_FSIZE, &rlFsize);
+        }
+
+        rlimit rlFiles{64, 64};
+        setrlimit(RLIMIT_NOFILE, &rlFiles);
+
+        // Respaldo del pids.max del cgroup contra fork bombs
+        rlimit rlProcs{ctx.maxProcesses, ctx.maxProcesses};
+        setrlimit(RLIMIT_NPROC, &rlProcs);
+
+        // Syscalls directas: los wrappers de glibc creen que el proceso sigue
+        // siendo multihilo y esperan a que los otros hilos (que no existen
+        // en esta copia) también cambien de uid
+        if (ctx.dropPrivileges) {
+            if (syscall(SYS_setgroups, 0, nullptr) != 0 ||
+                syscall(SYS_setresgid, ctx.gid, ctx.gid, ctx.gid) != 0 ||
+                syscall(SYS_setresuid, ctx.uid, ctx.uid, ctx.uid) != 0) {
+                _exit(126);
+            }
+        }
+
+        prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0);
+        if (ctx.seccomp && prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, ctx.seccomp) != 0) {
+            _exit(126);
+        }
+
+        execv(ctx.argv[0], ctx.argv);
+        _exit(127);
+    }
+
+    // ============================================================================
+    // sandboxInit
+    // Primer proceso del nuevo pid namespace (pid 1). Prepara el mount
+    // namespace, lanza el programa como hijo y propaga su estado de salida.
+    // No ejecuta el programa directamente porque pid 1 ignora las señales sin
+    // handler (abort() no terminaría el proceso como se espera).
+    // ============================================================================
+    int sandboxInit(void* arg) {
+        const ChildContext& ctx = *static_cast<const ChildContext*>(arg);
+
+        char go = 0;
+        if (read(ctx.syncFd, &go, 1) != 1) {
+            _exit(125);
+        }
+        close(ctx.syncFd);
+
+        // Redirecciones antes de ocultar las carpetas del host
+        int fdIn  = ctx.stdinFd  >= 0 ? ctx.stdinFd  : openOrNull(ctx.stdinPath, O_RDONLY);
+        int fdOut = ctx.stdoutFd >= 0 ? ctx.stdoutFd : openOrNull(ctx.stdoutPath, O_WRONLY | O_CREAT | O_TRUNC);
+        int fdErr = ctx.stderrFd >= 0 ? ctx.stderrFd : openOrNull(ctx.stderrPath, O_WRONLY | O_CREAT | O_TRUNC);
+        if (fdIn < 0 || fdOut < 0 || fdErr < 0) {
+            _exit(125);
+        }
+
+        // Solo quedan abiertos 0-2 (programa) y kReportFd: el resto son fds
+        // heredados del motor multihilo, incluidos los pipes de OTROS
+        // sandboxes, que no deben quedar retenidos por este proceso.
+        if (dup2(fdIn, STDIN_FILENO) < 0 || dup2(fdOut, STDOUT_FILENO) < 0 ||
+            dup2(fdErr, STDERR_FILENO) < 0 || dup2(ctx.reportFd, kReportFd) < 0) {
+            _exit(125);
+        }
+        closeFrom(kReportFd + 1);
+
+        int workFd = open(ctx.workDir, O_PATH | O_DIRECTORY | O_CLOEXEC);
+        if (workFd < 0) {
+            _exit(125);
+        }
+
+        // Montajes privados: nada de lo que sigue se ve en el host
+        if (mount(nullptr, "/", nullptr, MS_REC | MS_PRIVATE, nullptr) != 0) {
+            _exit(125);
+        }
+
+        if (fchdir(workFd) != 0) {
+            _exit(125);
+        }
+
+        // Raíz nueva: un tmpfs con solo lo que arma planRootfs
+        const RootfsPlan& fs = *ctx.rootfs;
+        if (mount("tmpfs", kNewRoot, "tmpfs", MS_NOSUID | MS_NODEV, "size=1m,mode=755") != 0) {
+            _exit(125);
+        }
+        for (const char* dir : fs.dirs) {
+            if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+                _exit(125);
+            }
+        }
+        for (const RootLink& link : fs.links) {
+            if (symlink(link.target, link.path) != 0) {
+                _exit(125);
+            }
+        }
+        for (const RootBind& bind : fs.binds) {
+            if (bind.isFile) {
+                int fd = open(bind.target, O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+                if (fd < 0) {
+                    _exit(125);
+                }
+                close(fd);
+            }
+            if (mount(bind.source, bind.target, nullptr, MS_BIND | MS_REC, nullptr) != 0) {
+                _exit(125);
+            }
+            if (bind.remountFlags != 0 &&
+                mount(nullptr, bind.target, nullptr, MS_BIND | MS_REMOUNT | bind.remountFlags,
+                      nullptr) != 0) {
+                _exit(125);
+            }
+        }
+
+        // /proc del nuevo pid namespace (best effort: si el /proc del host
+        // tiene rutas tapadas el kernel no lo permite en un user namespace)
+        // y /tmp privado
+        mount("proc", fs.procDir, "proc", MS_NOSUID | MS_NODEV | MS_NOEXEC, nullptr);
+        if (mount("tmpfs", fs.tmpDir, "tmpfs", MS_NOSUID | MS_NODEV, "size=64m,mode=1777") != 0) {
+            _exit(125);
+        }
+        for (const char* dir : fs.workDirs) {
+            if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+                _exit(125);
+            }
+        }
+
+        // La submission, en su misma ruta ("." sigue apuntando a la carpeta
+        // original aunque su ruta haya quedado tapada por el tmpfs)
+        if (mount(".", fs.workTarget, nullptr, MS_BIND | MS_REC, nullptr) != 0) {
+            _exit(125);
+        }
+        close(workFd);
+
+        // pivot_root(".", "."): la raíz vieja queda encima de la nueva y se
+        // desmonta; desde acá el host no es alcanzable
+        if (chdir(kNewRoot) != 0 ||
+            syscall(SYS_pivot_root, ".", ".") != 0 ||
+            umount2(".", MNT_DETACH) != 0 ||
+            chdir("/") != 0) {
+            _exit(125);
+        }
+        if (mount(nullptr, "/", nullptr, MS_BIND | MS_REMOUNT | MS_RDONLY | MS_NOSUID | MS_NODEV,
+                  nullptr) != 0) {
+            _exit(125);
+        }
+        if (chdir(ctx.workDir) != 0) {
+            _exit(125);
+        }
+
+        timespec begin{};
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+
+        pid_t pid = rawFork();
+        if (pid < 0) {
+            _exit(125);
+        }
+        if (pid == 0) {
+            close(kReportFd);
+            execTarget(ctx);
+        }
+        // Sin copias propias: el motor ve EOF cuando el programa cierra
+        close(STDIN_FILENO);
+        close(STDOUT_FILENO);
+        close(STDERR_FILENO);
+
+        // Espera al programa; con límite de CPU revisa cada 1 ms y lo mata
+        // apenas lo excede (el padre solo controla el tiempo real)
+        int status = 0;
+        rusage ru{};
+        const int waitFlags = ctx.cpuLimitMs > 0 ? WNOHANG : 0;
+        for (;;) {
+            pid_t r = wait4(pid, &status, waitFlags, &ru);
+            if (r == pid) {
+                break;
+            }
+            if (r < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                _exit(125);
+            }
+            if (cpuMsOf(pid) > ctx.cpuLimitMs) {
+                kill(pid, SIGKILL);
+            }
+            timespec tick{0, 1000000};
+            nanosleep(&tick, nullptr);
+        }
+
+        // Tiempo del programa en sí, sin el armado del sandbox
+        timespec end{};
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        ProgramUsage usage;
+        usage.wallUs = (end.tv_sec - begin.tv_sec) * 1000000LL +
+                       (end.tv_nsec - begin.tv_nsec) / 1000;
+        usage.cpuUs = (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000LL +
+                      ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+        usage.maxRssKb = ru.ru_maxrss;
+        if (write(kReportFd, &usage, sizeof(usage)) != static_cast<ssize_t>(sizeof(usage))) {
+            _exit(125);
+        }
+
+        if (WIFSIGNALED(status)) {
+            _exit(128 + WTERMSIG(status)); // misma convención que bash
+        }
+        _exit(WIFEXITED(status) ? WEXITSTATUS(status) : 125);
+    }
+
+    // ============================================================================
+    // PrivateCompileDir
+    // Carpeta donde compila el sandbox: <padre>/.tmp-compile-XXXXXX, del
+    // motor y 0700, con una subcarpeta abierta al usuario del sandbox. Ese
+    // usuario la alcanza por el bind de su propia raíz; en el host nadie más
+    // puede atravesar la de afuera (la carpeta de la submission nunca queda
+    // abierta). El prefijo ".tmp-" lo limpian los barridos al arrancar.
+    // ============================================================================
+    class PrivateCompileDir {
+    public:
+        explicit PrivateCompileDir(const std::filesystem::path& parent) {
+            std::string pattern = (parent / ".tmp-compile-XXXXXX").string();
+            if (!mkdtemp(pattern.data())) {
+                throw std::runtime_error(
+                    "No se pudo crear la carpeta de compilación en " + parent.string());
+            }
+            outer_ = pattern;
+            work_ = outer_ / "src";
+            // chmod aparte: mkdir aplica la umask
+            if (mkdir(work_.c_str(), 0700) != 0 || chmod(work_.c_str(), 0777) != 0) {
+                std::error_code ec;
+                std::filesystem::remove_all(outer_, ec);
+                throw std::runtime_error(
+                    "No se pudo preparar la carpeta de compilación " + work_.string());
+            }
+        }
+        ~PrivateCompileDir() {
+            std::error_code ec;
+            std::filesystem::remove_all(outer_, ec);
+        }
+        PrivateCompileDir(const PrivateCompileDir&) = delete;
+        PrivateCompileDir& operator=(const PrivateCompileDir&) = delete;
+
+        const std::filesystem::path& work() const { return work_; }
+
+    private:
+        std::filesystem::path outer_;
+        std::filesystem::path work_;
+    };
+
+    // Copia lo que produjo el sandbox a la submission: la copia es del motor,
+    // así el programa no puede modificar el binario que van a ejecutar los
+    // tests. false si no existe o no se pudo copiar.
+    bool reclaimFile(const std::filesystem::path& from, const std::filesystem::path& to) {
+        std::error_code ec;
+        std::filesystem::copy_file(from, to, std::filesystem::copy_options::overwrite_existing, ec);
+        return !ec;
+    }
+
+} // namespace
+
+namespace engine {
+
+// ============================================================================
+// Constructor: prepara (si se puede) la raíz de cgroups delegada al motor y
+// busca los ids subordinados del usuario (si no es root).
+// ============================================================================
+NativeSandboxRunner::NativeSandboxRunner(NativeSandboxConfig config)
+    : config_(std::move(config))
+{
+    std::error_code ec;
+    std::filesystem::create_directories(config_.cgroupRoot, ec);
+    if (!ec) {
+        // Habilitar controladores para los cgroups hijos (isSupported
+        // comprueba que haya quedado así)
+        writeControlFile(config_.cgroupRoot / "cgroup.subtree_control", "+memory +pids +cpu");
+    }
+
+    if (geteuid() != 0) {
+        const std::string user = currentUserName();
+        subUid_ = subordinateStart("/etc/subuid", geteuid(), user);
+        subGid_ = subordinateStart("/etc/subgid", getegid(), user);
+    }
+}
+
+// ============================================================================
+// isSupported
+// No alcanza con que existan los namespaces: se prueba todo lo que spawn
+// necesita, terminando con una ejecución real del compilador en el sandbox.
+// ============================================================================
+bool NativeSandboxRunner::isSupported(const NativeSandboxConfig& config, std::string* reason)
+{
+    std::string ignored;
+    std::string& why = reason ? *reason : ignored;
+
+    NativeSandboxRunner runner(config);
+    if (geteuid() != 0) {
+        if (runner.subUid_ < 0 || runner.subGid_ < 0) {
+            why = "el motor no corre como root y su usuario no tiene ids en /etc/subuid y /etc/subgid";
+            return false;
+        }
+        if (access(config.newuidmapPath.c_str(), X_OK) != 0 ||
+            access(config.newgidmapPath.c_str(), X_OK) != 0) {
+            why = "no se encontraron " + config.newuidmapPath + " / " + config.newgidmapPath;
+            return false;
+        }
+    }
+    if (!checkCgroupRoot(config.cgroupRoot, &why)) {
+        return false;
+    }
+
+    std::error_code ec;
+    auto probeDir = std::filesystem::temp_directory_path(ec) /
+        ("codecoach-native-probe-" + std::to_string(getpid()));
+    std::filesystem::create_directories(probeDir, ec);
+    if (ec) {
+        why = "no se pudo crear " + probeDir.string();
+        return false;
+    }
+
+    SpawnSpec spec;
+    spec.workDir = probeDir;
+    spec.argv = {config.compilerPath, "--version"};
+    spec.timeLimitMs = 10000;
+    SpawnResult sr = runner.spawn(spec);
+    std::filesystem::remove_all(probeDir, ec);
+
+    if (!sr.started || sr.timedOut || sr.exitCode != 0) {
+        why = "el spawn de prueba (" + config.compilerPath + " --version) falló" +
+              (sr.started ? " con código " + std::to_string(sr.exitCode) : "");
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// spawn
+// 1) prepara contexto, raíz del sandbox, filtro seccomp y cgroup propio
+// 2) clone() con namespaces nuevos (el hijo espera en un pipe)
+// 3) el padre mete al hijo en el cgroup / mapea los uid y lo libera
+// 4) espera con límite de tiempo real; si se pasa, SIGKILL al pid 1
+//    (lo que mata a todo el pid namespace)
+// Si falta el cgroup o el mapeo de ids no se ejecuta nada (started = false).
+// ============================================================================
+NativeSandboxRunner::SpawnResult NativeSandboxRunner::spawn(const SpawnSpec& spec) const
+{
+    SpawnResult result;
+    const bool isRoot = geteuid() == 0;
+    if (!isRoot && (subUid_ < 0 || subGid_ < 0)) {
+        std::cerr << "[NativeSandbox] Sin root ni ids subordinados: no se ejecuta\n";
+        return result;
+    }
+
+    // --- argv y rutas (memoria estable antes de clone) ---
+    std::vector<std::string> argvStorage = spec.argv;
+    std::vector<char*> argv;
+    for (auto& a : argvStorage) {
+        argv.push_back(a.data());
+    }
+    argv.push_back(nullptr);
+
+    const std::string workDir    = std::filesystem::absolute(spec.workDir).string();
+    const std::string stdinPath  = spec.stdinPath.empty()  ? "" : (spec.workDir / spec.stdinPath).string();
+    const std::string stdoutPath = spec.stdoutPath.empty() ? "" : (spec.workDir / spec.stdoutPath).string();
+    const std::string stderrPath = spec.stderrPath.empty() ? "" : (spec.workDir / spec.stderrPath).string();
+    // El tamaño de stdout se vigila mientras corre: que no cuente lo de una
+    // ejecución anterior antes de que el hijo lo trunque
+    if (!stdoutPath.empty() && spec.limits.outputLimitBytes > 0) {
+        std::error_code truncEc;
+        std::filesystem::resize_file(stdoutPath, 0, truncEc);
+    }
+
+    RootfsPlan rootfs;
+    planRootfs(config_, workDir, rootfs);
+
+    std::vector<sock_filter> filter;
+    sock_fprog prog{};
+    if (config_.useSeccomp && kAuditArch != 0) {
+        filter = buildSeccompFilter();
+        prog.len = static_cast<unsigned short>(filter.size());
+        prog.filter = filter.data();
+    }
+
+    ChildContext ctx;
+    ctx.workDir    = workDir.c_str();
+    ctx.stdinPath  = stdinPath.empty()  ? nullptr : stdinPath.c_str();
+    ctx.stdoutPath = stdoutPath.empty() ? nullptr : stdoutPath.c_str();
+    ctx.stderrPath = stderrPath.empty() ? nullptr : stderrPath.c_str();
+    ctx.rootfs     = &rootfs;
+    ctx.argv        = argv.data();
+    ctx.memoryBytes = static_cast<rlim_t>(spec.limits.memoryLimitMb) * 1024 * 1024;
+    const int cpuBudgetMs = spec.cpuLimitMs > 0 ? spec.cpuLimitMs : spec.timeLimitMs;
+    ctx.cpuSeconds  = static_cast<rlim_t>((cpuBudgetMs + 999) / 1000 + 1); // respaldo
+    ctx.cpuLimitMs  = spec.cpuLimitMs;
+    // N + 1: un programa que ignora SIGXFSZ igual deja más de N bytes
+    if (spec.limits.outputLimitBytes > 0) {
+        ctx.fileSizeBytes = static_cast<rlim_t>(spec.limits.outputLimitBytes) + 1;
+    }
+    ctx.maxProcesses = static_cast<rlim_t>(std::max(1, spec.limits.pidsLimit));
+    // Nunca con el uid del motor: root baja a sandboxUid; sin root, el uid 1
+    // del user namespace es el id subordinado (ver runIdMapper)
+    ctx.dropPrivileges = true;
+    ctx.uid = isRoot ? static_cast<uid_t>(config_.sandboxUid) : 1;
+    ctx.gid = isRoot ? static_cast<gid_t>(config_.sandboxGid) : 1;
+    ctx.seccomp = filter.empty() ? nullptr : &prog;
+
+    // --- cgroup propio para esta ejecución (obligatorio) ---
+    static std::atomic<unsigned long> counter{0};
+    std::filesystem::path cgroup = config_.cgroupRoot /
+        ("run-" + std::to_string(getpid()) + "-" + std::to_string(counter++));
+    std::error_code ec;
+    if (!std::filesystem::create_directory(cgroup, ec) || ec) {
+        std::cerr << "[NativeSandbox] No se pudo crear el cgroup " << cgroup
+                  << (ec ? " - " + ec.message() : "") << "\n";
+        return result;
+    }
+    long long quota = static_cast<long long>(spec.limits.cpuLimit * 100000);
+    bool limited =
+        writeControlFile(cgroup / "memory.max",
+                         std::to_string(static_cast<long long>(spec.limits.memoryLimitMb) * 1024 * 1024)) &&
+        writeControlFile(cgroup / "pids.max", std::to_string(spec.limits.pidsLimit)) &&
+        writeControlFile(cgroup / "cpu.max", std::to_string(quota) + " 100000");
+    if (!limited) {
+        std::cerr << "[NativeSandbox] No se pudieron fijar los límites de " << cgroup << "\n";
+        removeCgroup(cgroup);
+        return result;
+    }
+    writeControlFile(cgroup / "memory.swap.max", "0"); // no existe sin swap accounting
+
+    int syncPipe[2];
+    if (pipe2(syncPipe, O_CLOEXEC) != 0) {
+        removeCgroup(cgroup);
+        return result;
+    }
+    int reportPipe[2];
+    if (pipe2(reportPipe, O_CLOEXEC | O_NONBLOCK) != 0) {
+        close(syncPipe[0]);
+        close(syncPipe[1]);
+        removeCgroup(cgroup);
+        return result;
+    }
+    ctx.syncFd = syncPipe[0];
+    ctx.reportFd = reportPipe[1];
+
+    // Modo en memoria: un pipe por cada stream estándar ([0] lectura, [1] escritura)
+    const bool inMemory = spec.stdinData != nullptr;
+    int ioPipes[3][2] = {{-1, -1}, {-1, -1}, {-1, -1}};
+    if (inMemory) {
+        for (auto& p : ioPipes) {
+            if (pipe2(p, O_CLOEXEC) != 0) {
+                for (auto& q : ioPipes) {
+                    if (q[0] >= 0) { close(q[0]); close(q[1]); }
+                }
+                close(syncPipe[0]);
+                close(syncPipe[1]);
+                close(reportPipe[0]);
+                close(reportPipe[1]);
+                removeCgroup(cgroup);
+                return result;
+            }
+        }
+        ctx.stdinFd  = ioPipes[0][0];
+        ctx.stdoutFd = ioPipes[1][1];
+        ctx.stderrFd = ioPipes[2][1];
+    }
+
+    int flags = CLONE_NEWPID | CLONE_NEWNS | CLONE_NEWNET | CLONE_NEWIPC | CLONE_NEWUTS | SIGCHLD;
+    if (!isRoot) {
+        flags |= CLONE_NEWUSER;
+    }
+
+    std::vector<char> stack(256 * 1024);
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = clone(sandboxInit, stack.data() + stack.size(), flags, &ctx);
+    close(syncPipe[0]);
+    close(reportPipe[1]);
+    if (inMemory) {
+        close(ioPipes[0][0]);
+        close(ioPipes[1][1]);
+        close(ioPipes[2][1]);
+    }
+    // Extremos del motor (el pump los cierra al destruirse)
+    static const std::string kNoInput;
+    PipePump pump(inMemory ? *spec.stdinData : kNoInput, spec.maxOutputBytes, 64 * 1024);
+    if (inMemory) {
+        pump.attach(ioPipes[0][1], ioPipes[1][0], ioPipes[2][0]);
+    }
+
+    if (pid < 0) {
+        close(syncPipe[1]);
+        close(reportPipe[0]);
+        removeCgroup(cgroup);
+        return result;
+    }
+
+    // Sin cgroup o sin ids mapeados el hijo no se libera: muere al ver EOF
+    bool ready = writeControlFile(cgroup / "cgroup.procs", std::to_string(pid));
+    if (ready && !isRoot) {
+        ready = runIdMapper(config_.newuidmapPath, pid, geteuid(), subUid_) &&
+                runIdMapper(config_.newgidmapPath, pid, getegid(), subGid_);
+    }
+    char go = 1;
+    if (ready && write(syncPipe[1], &go, 1) != 1) {
+        ready = false;
+    }
+    close(syncPipe[1]);
+    if (!ready) {
+        std::cerr << "[NativeSandbox] No se pudo preparar el sandbox (cgroup o mapeo de ids)\n";
+        kill(pid, SIGKILL);
+        while (waitpid(pid, nullptr, __WALL) < 0 && errno == EINTR) {
+        }
+        close(reportPipe[0]);
+        removeCgroup(cgroup);
+        return result;
+    }
+    result.started = true;
+
+    // --- espera con tope de tiempo real (la CPU la controla pid 1) ---
+    int status = 0;
+    rusage usage{};
+    long long nextSizeCheckMs = 0;
+    for (;;) {
+        pid_t r = wait4(pid, &status, WNOHANG | __WALL, &usage);
+        if (r == pid) {
+            break;
+        }
+        if (r < 0 && errno != EINTR) {
+            break;
+        }
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        if (!result.timedOut && elapsed > spec.timeLimitMs) {
+            result.timedOut = true;
+            kill(pid, SIGKILL);
+        }
+        // Salida por encima del límite: se detiene al programa en lugar de
+        // esperar al timeout (pipe lleno, o archivo en el tope de
+        // RLIMIT_FSIZE cuando el programa ignora SIGXFSZ)
+        if (!result.outputLimitExceeded && spec.limits.outputLimitBytes > 0) {
+            bool exceeded = inMemory && pump.outputTruncated();
+            if (!inMemory && !stdoutPath.empty() && elapsed >= nextSizeCheckMs) {
+                std::error_code sizeEc;
+                auto size = std::filesystem::file_size(stdoutPath, sizeEc);
+                exceeded = !sizeEc && size > spec.limits.outputLimitBytes;
+                nextSizeCheckMs = elapsed + 10;
+            }
+            if (exceeded) {
+                result.outputLimitExceeded = true;
+                kill(pid, SIGKILL);
+            }
+        }
+        if (!inMemory || !pump.pump(1)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    if (inMemory) {
+        pump.finish();
+        result.output = std::move(pump.output());
+        result.errors = std::move(pump.errors());
+        result.outputTruncated = pump.outputTruncated();
+    }
+
+    // Preferir lo que midió pid 1 sobre el programa; si no llegó (p. ej. se
+    // mató al sandbox por timeout) se usa lo medido desde afuera.
+    ProgramUsage programUsage;
+    if (read(reportPipe[0], &programUsage, sizeof(programUsage)) ==
+        static_cast<ssize_t>(sizeof(programUsage))) {
+        result.wallMs   = static_cast<int>(programUsage.wallUs / 1000);
+        result.cpuMs    = static_cast<int>(programUsage.cpuUs / 1000);
+        result.memoryKb = static_cast<int>(programUsage.maxRssKb);
+    } else {
+        result.wallMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        result.cpuMs    = toMs(usage.ru_utime) + toMs(usage.ru_stime);
+        result.memoryKb = static_cast<int>(usage.ru_maxrss);
+
+        // Un programa muerto por SIGKILL no llega al rusage de pid 1;
+        // el cgroup sí contabiliza su CPU.
+        long long cgroupCpuUs = readCgroupCpuUs(cgroup);
+        if (cgroupCpuUs >= 0) {
+            result.cpuMs = static_cast<int>(cgroupCpuUs / 1000);
+        }
+    }
+    close(reportPipe[0]);
+
+    if (WIFEXITED(status)) {
+        result.exitCode = WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+        result.exitCode = 128 + WTERMSIG(status);
+    }
+    if (result.exitCode == 128 + SIGXCPU ||
+        (spec.cpuLimitMs > 0 && result.cpuMs > spec.cpuLimitMs)) {
+        result.timedOut = true;
+    }
+    if (spec.limits.outputLimitBytes > 0) {
+        std::error_code sizeEc;
+        std::uintmax_t size = (inMemory || stdoutPath.empty())
+            ? 0 : std::filesystem::file_size(stdoutPath, sizeEc);
+        if (result.exitCode == 128 + SIGXFSZ ||
+            (!sizeEc && size > spec.limits.outputLimitBytes)) {
+            result.outputLimitExceeded = true;
+        }
+    }
+
+    removeCgroup(cgroup);
+    return result;
+}
+
+// ============================================================================
+// toolchainId
+// Si se actualiza el g++ del host cambia su tamaño/fecha y con ello la clave.
+// ============================================================================
+std::string NativeSandboxRunner::toolchainId() const
+{
+    std::error_code ec;
+    auto real = std::filesystem::canonical(config_.compilerPath, ec);
+    if (ec) {
+        return config_.compilerPath;
+    }
+    auto size  = std::filesystem::file_size(real, ec);
+    auto mtime = std::filesystem::last_write_time(real, ec).time_since_epoch().count();
+    return "native:" + real.string() + ":" + std::to_string(size) + ":" + std::to_string(mtime);
+}
+
+// ============================================================================
+// compile
+// g++ del host dentro del sandbox, con límites más holgados que los tests.
+// ============================================================================
+CompileResult NativeSandboxRunner::compile(
+    const std::filesystem::path& submissionDir,
+    const std::string& sourceFileName) const
+{
+    CompileResult result;
+    result.logFilePath = (submissionDir / "compile.log").string();
+
+    // El usuario del sandbox tiene que poder escribir `main`: compila en una
+    // carpeta privada y main/compile.log vuelven copiados a la submission
+    PrivateCompileDir staging(submissionDir.parent_path());
+    std::filesystem::copy_file(submissionDir / sourceFileName, staging.work() / sourceFileName);
+    std::error_code staleEc;
+    std::filesystem::remove(submissionDir / "compile.log", staleEc);
+
+    SpawnSpec spec;
+    spec.workDir    = staging.work();
+    spec.argv       = {config_.compilerPath};
+
+    // Encabezado precompilado del host, si existe para este conjunto
+    auto pch = PrecompiledHeaders::selectForFile(submissionDir / sourceFileName);
+    if (pch) {
+        std::error_code ec;
+        auto header = config_.pchDir / *pch;
+        if (std::filesystem::exists(header.string() + ".gch", ec)) {
+            spec.argv.insert(spec.argv.end(), {"-include", header.string()});
+        }
+    }
+
+    spec.argv.push_back(sourceFileName);
+    std::istringstream flags(kCompileFlags);
+    for (std::string flag; flags >> flag;) {
+        spec.argv.push_back(flag);
+    }
+    spec.argv.insert(spec.argv.end(), {"-o", "main"});
+    spec.stderrPath = "compile.log";
+    spec.timeLimitMs = config_.compileTimeLimitSeconds * 1000;
+    spec.limits.memoryLimitMb = config_.compileMemoryLimitMb;
+    spec.limits.pidsLimit = 64;
+
+    SpawnResult sr = spawn(spec);
+    result.exitCode = sr.started ? (sr.timedOut ? 124 : sr.exitCode) : -1;
+
+    // Sin compile.log un código != 0 se toma como que el sandbox no compiló
+    // (compileDidNotRun)
+    reclaimFile(staging.work() / "compile.log", submissionDir / "compile.log");
+    if (result.exitCode == 0 && !reclaimFile(staging.work() / "main", submissionDir / "main")) {
+        throw std::runtime_error("No se pudo recuperar el binario compilado en " + submissionDir.string());
+    }
+    return result;
+}
+
+// ============================================================================
+// runSingleTest
+// Ejecuta ./main con stdin/stdout/stderr redirigidos a archivos del host.
+// ============================================================================
+RunResult NativeSandboxRunner::runSingleTest(
+    const std::filesystem::path& submissionDir,
+    const std::string& inputFileName,
+    const std::string& outputFileName,
+    const std::string& runtimeLogName,
+    const RunLimits& limits) const
+{
+    RunResult result;
+    result.outputPath     = (submissionDir / outputFileName).string();
+    result.runtimeLogPath = (submissionDir / runtimeLogName).string();
+
+    SpawnSpec spec;
+    spec.workDir     = submissionDir;
+    spec.argv        = {(std::filesystem::absolute(submissionDir) / "main").string()};
+    spec.stdinPath   = inputFileName;
+    spec.stdoutPath  = outputFileName;
+    spec.stderrPath  = runtimeLogName;
+    spec.timeLimitMs = limits.effectiveWallLimitMs();
+    spec.cpuLimitMs  = limits.timeLimitMs;
+    spec.limits      = limits;
+
+    SpawnResult sr = spawn(spec);
+    result.executed  = sr.started;
+    result.exitCode  = sr.exitCode;
+    result.timedOut  = sr.timedOut;
+    result.timeMs    = sr.wallMs;
+    result.cpuTimeMs = sr.cpuMs;
+    result.memoryKb  = sr.memoryKb;
+    result.outputLimitExceeded = sr.outputLimitExceeded;
+    return result;
+}
+
+// ============================================================================
+// runInMemory
+// Igual que runSingleTest, pero stdin/stdout/stderr son pipes al motor.
+// ============================================================================
+RunResult NativeSandboxRunner::runInMemory(
+    const std::filesystem::path& submissionDir,
+    const std::string& input,
+    std::size_t maxOutputBytes,
+    const RunLimits& limits) const
+{
+    SpawnSpec spec;
+    spec.workDir        = submissionDir;
+    spec.argv           = {(std::filesystem::absolute(submissionDir) / "main").string()};
+    spec.stdinData      = &input;
+    spec.maxOutputBytes = maxOutputBytes;
+    spec.timeLimitMs    = limits.effectiveWallLimitMs();
+    spec.cpuLimitMs     = limits.timeLimitMs;
+    spec.limits         = limits;
+
+    SpawnResult sr = spawn(spec);
+
+    RunResult result;
+    result.executed        = sr.started;
+    result.exitCode        = sr.exitCode;
+    result.timedOut        = sr.timedOut;
+    result.timeMs          = sr.wallMs;
+    result.cpuTimeMs       = sr.cpuMs;
+    result.memoryKb        = sr.memoryKb;
+    result.output          = std::move(sr.output);
+    result.runtimeLog      = std::move(sr.errors);
+    result.outputTruncated = sr.outputTruncated;
+    result.outputLimitExceeded = sr.outputLimitExceeded;
+    return result;
+}
+
+std::vector<RunResult> NativeSandboxRunner::runBatch(
+    const std::filesystem::path& submissionDir,
+    const std::vector<std::string>& testIds,
+    const RunLimits& limits,
+    int jobs,
+    FailurePolicy stopOn) const
+{
+    std::vector<RunResult> results(testIds.size());
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool> stopped{false};
+
+    auto worker = [&]() {
+        for (std::size_t i = next++; i < testIds.size(); i = next++) {
+            if (stopped) {
+                results[i].executed = false; // no se lanzó (fail-fast)
+                continue;
+            }
+            const auto& id = testIds[i];
+            results[i] = runSingleTest(
+                submissionDir,
+                "input_" + id + ".txt",
+                "output_" + id + ".txt",
+                "runtime_" + id + ".log",
+                limits);
+            if (stopsBatch(results[i], stopOn)) {
+                stopped = true;
+            }
+        }
+    };
+
+    std::size_t threads = std::min<std::size_t>(
+        static_cast<std::size_t>(std::max(1, jobs)), testIds.size());
+    std::vector<std::thread> pool;
+    for (std::size_t t = 1; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker(); // el hilo actual también trabaja
+    for (auto& th : pool) {
+        th.join();
+    }
+    return results;
+}
+
+} // namespace engine
+
+#else // !__linux__
+
+namespace engine {
+
+// En otras plataformas el backend nativo no existe: se debe usar Docker.
+NativeSandboxRunner::NativeSandboxRunner(NativeSandboxConfig config)
+    : config_(std::move(config))
+{
+    throw std::runtime_error("El sandbox nativo solo está disponible en Linux");
+}
+
+bool NativeSandboxRunner::isSupported(const NativeSandboxConfig&, std::string* reason)
+{
+    if (reason) {
+        *reason = "solo está disponible en Linux";
+    }
+    return false;
+}
+
+std::string NativeSandboxRunner::toolchainId() const { return {}; }
+
+NativeSandboxRunner::SpawnResult NativeSandboxRunner::spawn(const SpawnSpec&) const { return {}; }
+
+CompileResult NativeSandboxRunner::compile(
+    const std::filesystem::path&, const std::string&) const { return {}; }
+
+RunResult NativeSandboxRunner::runSingleTest(
+    const std::filesystem::path&, const std::string&, const std::string&,
+    const std::string&, const RunLimits&) const { return {}; }
+
+RunResult NativeSandboxRunner::runInMemory(
+    const std::filesystem::path&, const std::string&, std::size_t,
+    const RunLimits&) const { return {}; }
+
+std::vector<RunResult> NativeSandboxRunner::runBatch(
+    const std::filesystem::path&, const std::vector<std::string>&,
+    const RunLimits&, int, FailurePolicy) const { return {}; }
+
+} // namespace engine
+
+#endif
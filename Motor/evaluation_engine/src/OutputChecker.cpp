@@ -0,0 +1,168 @@
+#include "OutputChecker.h"
+
+#include "ByteSource.h"
+#include "OutputComparer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace engine {
+
+    namespace {
+
+        bool isBlank(int c) {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n' ||
+                   c == '\f' || c == '\v';
+        }
+
+        // ====================================================================
+        // TokenReader
+        // Devuelve los tokens (secuencias sin blancos) de un ByteSource.
+        // ====================================================================
+        class TokenReader {
+        public:
+            explicit TokenReader(ByteSource source) : source_(std::move(source)) {}
+
+            // false al llegar al final sin más tokens.
+            bool next(std::string& token) {
+                token.clear();
+                int c = source_.get();
+                while (c >= 0 && isBlank(c)) {
+                    c = source_.get();
+                }
+                while (c >= 0 && !isBlank(c)) {
+                    token.push_back(static_cast<char>(c));
+                    c = source_.get();
+                }
+                return !token.empty();
+            }
+
+        private:
+            ByteSource source_;
+        };
+
+        // Token completo como double (strtod acepta "1e-3", "-0.5", "inf"...).
+        bool parseNumber(const std::string& token, double& value) {
+            const char* begin = token.c_str();
+            char* end = nullptr;
+            value = std::strtod(begin, &end);
+            return end != begin && *end == '\0';
+        }
+
+        bool sameNumber(const std::string& out, const std::string& exp,
+                        const CheckerSpec& spec) {
+            double a = 0;
+            double b = 0;
+            if (!parseNumber(out, a) || !parseNumber(exp, b)) {
+                return false;
+            }
+            if (!std::isfinite(a) || !std::isfinite(b)) {
+                // inf/nan solo coinciden consigo mismos
+                return (std::isnan(a) && std::isnan(b)) || a == b;
+            }
+            double diff = std::fabs(a - b);
+            return diff <= spec.absEpsilon || diff <= spec.relEpsilon * std::fabs(b);
+        }
+
+        // Tokens y Float: recorre ambas salidas a la par.
+        bool sameTokens(ByteSource output, ByteSource expected, const CheckerSpec& spec) {
+            TokenReader out(std::move(output));
+            TokenReader exp(std::move(expected));
+            std::string a;
+            std::string b;
+            for (;;) {
+                bool hasA = out.next(a);
+                bool hasB = exp.next(b);
+                if (hasA != hasB) {
+                    return false;
+                }
+                if (!hasA) {
+                    return true;
+                }
+                if (a != b && !(spec.type == CheckerType::Float && sameNumber(a, b, spec))) {
+                    return false;
+                }
+            }
+        }
+
+        // Líneas sin \r ni blancos finales, sin las líneas vacías del final
+        // (la misma normalización que OutputComparer).
+        std::vector<std::string> normalizedLines(ByteSource source) {
+            std::vector<std::string> lines(1);
+            for (int c = source.get(); c >= 0; c = source.get()) {
+                if (c == '\n') {
+                    lines.emplace_back();
+                } else {
+                    lines.back().push_back(static_cast<char>(c));
+                }
+            }
+            for (auto& line : lines) {
+                auto last = line.find_last_not_of(" \t\r");
+                line.erase(last == std::string::npos ? 0 : last + 1);
+            }
+            while (!lines.empty() && lines.back().empty()) {
+                lines.pop_back();
+            }
+            return lines;
+        }
+
+        bool sameLinesUnordered(ByteSource output, ByteSource expected) {
+            auto a = normalizedLines(std::move(output));
+            auto b = normalizedLines(std::move(expected));
+            if (a.size() != b.size()) {
+                return false;
+            }
+            std::sort(a.begin(), a.end());
+            std::sort(b.begin(), b.end());
+            return a == b;
+        }
+
+        bool acceptsSources(const CheckerSpec& spec, ByteSource output, ByteSource expected) {
+            switch (spec.type) {
+                case CheckerType::Tokens:
+                case CheckerType::Float:
+                    return sameTokens(std::move(output), std::move(expected), spec);
+                case CheckerType::UnorderedLines:
+                    return sameLinesUnordered(std::move(output), std::move(expected));
+                case CheckerType::Exact:
+                case CheckerType::Custom:
+                    break;
+            }
+            throw std::invalid_argument("checker no soportado por OutputChecker");
+        }
+    } // namespace
+
+    bool OutputChecker::accepts(const CheckerSpec& spec,
+                                std::string_view output,
+                                std::string_view expected,
+                                OutputDiff* diff)
+    {
+        if (spec.type == CheckerType::Exact) {
+            return OutputComparer::areEqualText(output, expected, diff);
+        }
+        return acceptsSources(spec, ByteSource(output), ByteSource(expected));
+    }
+
+    bool OutputChecker::acceptsFiles(const CheckerSpec& spec,
+                                     const std::filesystem::path& outputFile,
+                                     const std::filesystem::path& expectedFile,
+                                     OutputDiff* diff)
+    {
+        if (spec.type == CheckerType::Exact) {
+            return OutputComparer::areEqual(outputFile, expectedFile, diff);
+        }
+        std::ifstream out(outputFile, std::ios::binary);
+        std::ifstream exp(expectedFile, std::ios::binary);
+        if (!out || !exp) {
+            return false;
+        }
+        return acceptsSources(spec, ByteSource(out), ByteSource(exp));
+    }
+
+} // namespace engine
@@ -1,71 +1,202 @@
 #include "OutputComparer.h"
 
+#include "ByteSource.h"
+
 #include <fstream>
-#include <algorithm>
-#include <vector>
+#include <string>
+#include <utility>
 
 namespace engine {
 
     namespace {
 
-        // Quita espacios, tabs, \r y \n al final de la línea.
-        inline void trimRight(std::string& s) {
-            while (!s.empty() &&
-                   (s.back() == ' ' || s.back() == '\t' ||
-                    s.back() == '\r' || s.back() == '\n')) {
-                s.pop_back();
+        // ====================================================================
+        // NormalizedReader
+        // Aplica la normalización al vuelo, sin guardar líneas:
+        //  - quita espacios, tabs y \r al final de cada línea
+        //  - quita las líneas vacías del final
+        // Los blancos y saltos de línea se retienen hasta saber si les sigue
+        // algo visible; si no, se descartan. Devuelve un byte, kNewline o kEnd.
+        // ====================================================================
+        class NormalizedReader {
+        public:
+            static constexpr int kEnd = -1;
+            static constexpr int kNewline = -2;
+
+            explicit NormalizedReader(ByteSource source) : source_(std::move(source)) {}
+
+            int next() {
+                for (;;) {
+                    // Primero se entrega lo retenido antes del byte visible
+                    if (held_ >= 0) {
+                        if (pendingNewlines_ > 0) {
+                            --pendingNewlines_;
+                            return kNewline;
+                        }
+                        if (wsPos_ < pendingWs_.size()) {
+                            return static_cast<unsigned char>(pendingWs_[wsPos_++]);
+                        }
+                        pendingWs_.clear();
+                        wsPos_ = 0;
+                        int c = held_;
+                        held_ = -1;
+                        return c;
+                    }
+
+                    int c = source_.get();
+                    if (c < 0) {
+                        return kEnd; // blancos y líneas vacías finales se descartan
+                    }
+                    if (c == '\n') {
+                        pendingWs_.clear(); // blancos al final de la línea
+                        ++pendingNewlines_;
+                    } else if (c == ' ' || c == '\t' || c == '\r') {
+                        pendingWs_.push_back(static_cast<char>(c));
+                    } else {
+                        held_ = c;
+                    }
+                }
             }
+
+        private:
+            ByteSource source_;
+            std::size_t pendingNewlines_{0};
+            std::string pendingWs_;     // blancos desde el último byte visible
+            std::size_t wsPos_{0};
+            int held_{-1};              // byte visible que espera a lo retenido
+        };
+
+        constexpr std::size_t kContext = OutputComparer::kDiffContextBytes;
+
+        // Largo de la secuencia UTF-8 que empieza con `lead` (0 = inválido).
+        std::size_t utf8Length(unsigned char lead) {
+            if (lead < 0x80) return 1;
+            if ((lead & 0xE0) == 0xC0) return lead >= 0xC2 ? 2 : 0;
+            if ((lead & 0xF0) == 0xE0) return 3;
+            if ((lead & 0xF8) == 0xF0) return lead <= 0xF4 ? 4 : 0;
+            return 0;
         }
 
-        // Lee un archivo línea por línea, normalizando:
-        // - elimina \r
-        // - elimina espacios al final
-        // - elimina líneas vacías finales
-        std::vector<std::string> readNormalizedLines(const std::filesystem::path& path) {
-            std::ifstream in(path);
-            std::vector<std::string> lines;
+        // Los fragmentos se cortan por bytes y van a un JSON: se descartan
+        // los caracteres partidos en los bordes y los bytes inválidos o de
+        // control se reemplazan por '?'.
+        std::string sanitizeExcerpt(const std::string& text) {
+            auto isContinuation = [&](std::size_t i) {
+                return (static_cast<unsigned char>(text[i]) & 0xC0) == 0x80;
+            };
 
-            if (!in) {
-                return lines; // si no existe, se consideran no iguales
+            std::string out;
+            std::size_t i = 0;
+            while (i < text.size() && isContinuation(i)) {
+                ++i; // caracter partido al inicio
             }
-
-            std::string line;
-            while (std::getline(in, line)) {
-                trimRight(line);
-                lines.push_back(std::move(line));
+            while (i < text.size()) {
+                auto c = static_cast<unsigned char>(text[i]);
+                std::size_t len = utf8Length(c);
+                if (len > 1 && i + len > text.size()) {
+                    break; // caracter partido al final
+                }
+                bool valid = len > 0;
+                for (std::size_t k = 1; valid && k < len; ++k) {
+                    valid = isContinuation(i + k);
+                }
+                if (valid && (len > 1 || ((c >= 0x20 || c == '\t') && c != 0x7F))) {
+                    out.append(text, i, len);
+                    i += len;
+                } else {
+                    out.push_back('?');
+                    ++i;
+                }
             }
+            return out;
+        }
 
-            // Eliminar líneas vacías al final
-            while (!lines.empty() && lines.back().empty()) {
-                lines.pop_back();
+        // Fragmento de un lado: contexto común + hasta kContext bytes desde
+        // `first` hasta el fin de la línea, con "..." donde se recortó.
+        std::string excerpt(bool cutBefore, const std::string& before,
+                            int first, NormalizedReader& reader) {
+            std::string text = before;
+            std::size_t taken = 0;
+            int c = first;
+            while (c >= 0 && taken < kContext) {
+                text.push_back(static_cast<char>(c));
+                ++taken;
+                c = reader.next();
             }
+            return (cutBefore ? "..." : "") + sanitizeExcerpt(text) + (c >= 0 ? "..." : "");
+        }
 
-            return lines;
+        // Recorre ambas entradas a la par y corta en la primera diferencia.
+        // Con `diff`, se lleva la posición y los últimos bytes de la línea
+        // actual (iguales en ambos lados hasta la diferencia).
+        bool sameNormalized(ByteSource output, ByteSource expected, OutputDiff* diff) {
+            NormalizedReader out(std::move(output));
+            NormalizedReader exp(std::move(expected));
+            std::size_t line = 1;
+            std::size_t column = 1;
+            std::string context;
+            for (;;) {
+                int a = out.next();
+                int b = exp.next();
+                if (a != b) {
+                    if (diff) {
+                        bool cut = column - 1 > kContext;
+                        std::string before = cut
+                            ? context.substr(context.size() - kContext)
+                            : context;
+                        diff->line = line;
+                        diff->column = column;
+                        diff->expected = excerpt(cut, before, b, exp);
+                        diff->actual = excerpt(cut, before, a, out);
+                    }
+                    return false;
+                }
+                if (a == NormalizedReader::kEnd) {
+                    return true;
+                }
+                if (!diff) {
+                    continue;
+                }
+                if (a == NormalizedReader::kNewline) {
+                    ++line;
+                    column = 1;
+                    context.clear();
+                } else {
+                    ++column;
+                    context.push_back(static_cast<char>(a));
+                    if (context.size() > 2 * kContext) {
+                        context.erase(0, context.size() - kContext);
+                    }
+                }
+            }
         }
     } // namespace interno
 
     // ========================================================================
     // areEqual
-    // Compara línea por línea dos archivos normalizados.
+    // Compara dos archivos normalizados en streaming: memoria constante
+    // (un bloque por archivo) y salida en la primera diferencia. Si alguno
+    // de los archivos no existe, se consideran distintos.
     // ========================================================================
     bool OutputComparer::areEqual(
         const std::filesystem::path& outputFile,
-        const std::filesystem::path& expectedFile)
+        const std::filesystem::path& expectedFile,
+        OutputDiff* diff)
     {
-        auto outLines = readNormalizedLines(outputFile);
-        auto expLines = readNormalizedLines(expectedFile);
-
-        if (outLines.size() != expLines.size()) {
+        std::ifstream out(outputFile, std::ios::binary);
+        std::ifstream exp(expectedFile, std::ios::binary);
+        if (!out || !exp) {
             return false;
         }
+        return sameNormalized(ByteSource(out), ByteSource(exp), diff);
+    }
 
-        for (std::size_t i = 0; i < outLines.size(); ++i) {
-            if (outLines[i] != expLines[i]) {
-                return false;
-            }
-        }
-
-        return true;
+    bool OutputComparer::areEqualText(
+        std::string_view output,
+        std::string_view expected,
+        OutputDiff* diff)
+    {
+        return sameNormalized(ByteSource(output), ByteSource(expected), diff);
     }
 
 } // namespace engine
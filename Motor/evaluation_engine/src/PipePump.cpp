@@ -0,0 +1,192 @@
+#include "PipePump.h"
+
+#ifndef _WIN32
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+
+namespace {
+
+    // write() sin que un EPIPE mate al motor: SIGPIPE se bloquea en este hilo
+    // y, si quedó pendiente por esta escritura, se consume.
+    ssize_t writeNoSigpipe(int fd, const char* data, std::size_t len) {
+        sigset_t pipeSet, oldSet, pending;
+        sigemptyset(&pipeSet);
+        sigaddset(&pipeSet, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &pipeSet, &oldSet);
+
+        sigpending(&pending);
+        bool wasPending = sigismember(&pending, SIGPIPE) == 1;
+
+        ssize_t n = write(fd, data, len);
+        int savedErrno = errno;
+
+        if (n < 0 && savedErrno == EPIPE && !wasPending) {
+            timespec zero{0, 0};
+            sigtimedwait(&pipeSet, nullptr, &zero);
+        }
+        pthread_sigmask(SIG_SETMASK, &oldSet, nullptr);
+        errno = savedErrno;
+        return n;
+    }
+
+    void setNonBlocking(int fd) {
+        int flags = fcntl(fd, F_GETFL);
+        if (flags >= 0) {
+            fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        }
+    }
+
+} // namespace
+
+namespace engine {
+
+PipePump::PipePump(const std::string& input,
+                   std::size_t maxOutputBytes,
+                   std::size_t maxErrorBytes)
+    : input_(input),
+      maxOutputBytes_(maxOutputBytes),
+      maxErrorBytes_(maxErrorBytes)
+{}
+
+PipePump::~PipePump()
+{
+    closeFd(stdinFd_);
+    closeFd(stdoutFd_);
+    closeFd(stderrFd_);
+
+    if (errorsTruncated_) {
+        errors_ += "\n[...]\n";
+        errors_ += errorsTail_;
+        errorsTail_.clear();
+    }
+}
+
+void PipePump::closeFd(int& fd)
+{
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+void PipePump::attach(int stdinFd, int stdoutFd, int stderrFd)
+{
+    stdinFd_  = stdinFd;
+    stdoutFd_ = stdoutFd;
+    stderrFd_ = stderrFd;
+    for (int fd : {stdinFd_, stdoutFd_, stderrFd_}) {
+        if (fd >= 0) {
+            setNonBlocking(fd);
+#ifdef F_SETPIPE_SZ
+            fcntl(fd, F_SETPIPE_SZ, 1 << 20); // menos rondas para inputs grandes
+#endif
+        }
+    }
+    if (stdinFd_ >= 0 && input_.empty()) {
+        closeFd(stdinFd_);
+    }
+}
+
+// Escribe todo lo que el pipe acepte sin bloquear; EOF al terminar.
+void PipePump::writeInput()
+{
+    while (stdinFd_ >= 0 && inputPos_ < input_.size()) {
+        ssize_t n = writeNoSigpipe(stdinFd_, input_.data() + inputPos_,
+                                   input_.size() - inputPos_);
+        if (n > 0) {
+            inputPos_ += static_cast<std::size_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        } else {
+            closeFd(stdinFd_); // el programa cerró stdin (o terminó)
+            return;
+        }
+    }
+    if (inputPos_ >= input_.size()) {
+        closeFd(stdinFd_);
+    }
+}
+
+void PipePump::readInto(int& fd, std::string& buffer, std::size_t limit, bool& truncated)
+{
+    char chunk[65536];
+    while (fd >= 0) {
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n > 0) {
+            std::size_t room = limit > buffer.size() ? limit - buffer.size() : 0;
+            std::size_t take = std::min(room, static_cast<std::size_t>(n));
+            buffer.append(chunk, take);
+            if (take < static_cast<std::size_t>(n)) {
+                truncated = true;
+                if (&buffer == &errors_) {
+                    // De stderr se conserva además el final (ahí puede venir
+                    // un trailer del proceso intermedio, p. ej. judge-driver)
+                    errorsTail_.append(chunk + take, static_cast<std::size_t>(n) - take);
+                    if (errorsTail_.size() > kErrorsTailBytes) {
+                        errorsTail_.erase(0, errorsTail_.size() - kErrorsTailBytes);
+                    }
+                }
+            }
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        } else {
+            closeFd(fd); // EOF o error
+        }
+    }
+}
+
+bool PipePump::pump(int timeoutMs)
+{
+    pollfd fds[3];
+    nfds_t count = 0;
+    if (stdinFd_ >= 0)  fds[count++] = {stdinFd_, POLLOUT, 0};
+    if (stdoutFd_ >= 0) fds[count++] = {stdoutFd_, POLLIN, 0};
+    if (stderrFd_ >= 0) fds[count++] = {stderrFd_, POLLIN, 0};
+    if (count == 0) {
+        return false;
+    }
+
+    if (poll(fds, count, timeoutMs) > 0) {
+        for (nfds_t i = 0; i < count; ++i) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            if (fds[i].fd == stdinFd_) {
+                writeInput();
+            } else if (fds[i].fd == stdoutFd_) {
+                readInto(stdoutFd_, output_, maxOutputBytes_, outputTruncated_);
+            } else if (fds[i].fd == stderrFd_) {
+                readInto(stderrFd_, errors_, maxErrorBytes_, errorsTruncated_);
+            }
+        }
+    }
+    return stdinFd_ >= 0 || stdoutFd_ >= 0 || stderrFd_ >= 0;
+}
+
+// El proceso ya terminó: todo lo que escribió está en los pipes. No se
+// espera EOF porque otro sandbox lanzado en paralelo puede haber heredado
+// una copia de los extremos de escritura.
+void PipePump::finish()
+{
+    closeFd(stdinFd_);
+    readInto(stdoutFd_, output_, maxOutputBytes_, outputTruncated_);
+    readInto(stderrFd_, errors_, maxErrorBytes_, errorsTruncated_);
+    closeFd(stdoutFd_);
+    closeFd(stderrFd_);
+}
+
+} // namespace engine
+
+#endif // !_WIN32
@@ -0,0 +1,148 @@
+#include "PrecompiledHeaders.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace {
+
+    // ============================================================================
+    // stripComments
+    // Reemplaza los comentarios `//` y `/* */` por un espacio (los de bloque
+    // conservan sus saltos de línea), respetando literales de texto y de
+    // carácter. Los raw strings no se reconocen: solo importa el comienzo del
+    // archivo, y un raw string corta el bloque de includes de todos modos.
+    // ============================================================================
+    std::string stripComments(const std::string& code)
+    {
+        std::string out;
+        out.reserve(code.size());
+        std::size_t i = 0;
+        const std::size_t n = code.size();
+        while (i < n) {
+            char c = code[i];
+            if (c == '/' && i + 1 < n && code[i + 1] == '/') {
+                while (i < n && code[i] != '\n') {
+                    // una `\` al final de línea continúa el comentario
+                    i += (code[i] == '\\' && i + 1 < n) ? 2 : 1;
+                }
+                out += ' ';
+            } else if (c == '/' && i + 1 < n && code[i + 1] == '*') {
+                std::size_t end = code.find("*/", i + 2);
+                std::size_t stop = end == std::string::npos ? n : end + 2;
+                out += ' ';
+                out.append(static_cast<std::size_t>(
+                    std::count(code.begin() + i, code.begin() + stop, '\n')), '\n');
+                i = stop;
+            } else if (c == '"' || c == '\'') {
+                out += code[i++];
+                while (i < n && code[i] != c && code[i] != '\n') {
+                    if (code[i] == '\\' && i + 1 < n) {
+                        out += code[i++];
+                    }
+                    out += code[i++];
+                }
+                if (i < n && code[i] == c) {
+                    out += code[i++];
+                }
+            } else {
+                out += code[i++];
+            }
+        }
+        return out;
+    }
+
+} // namespace
+
+namespace engine {
+
+const std::vector<PrecompiledHeader>& PrecompiledHeaders::available()
+{
+    static const std::vector<PrecompiledHeader> sets = {
+        {"stdcxx.h", {"bits/stdc++.h"}},
+        {"algorithm-iostream-string-vector.h", {"algorithm", "iostream", "string", "vector"}},
+        {"iostream-string-vector.h", {"iostream", "string", "vector"}},
+        {"iostream-vector.h", {"iostream", "vector"}},
+        {"iostream-string.h", {"iostream", "string"}},
+        {"iostream.h", {"iostream"}},
+    };
+    return sets;
+}
+
+// ============================================================================
+// leadingIncludes
+// Recorre las líneas del código sin comentarios hasta la primera que no sea
+// vacía ni directiva. Todas las directivas de ese tramo tienen que ser
+// `#include <...>`; cualquier otra (o una línea continuada con `\`) anula
+// el PCH.
+// ============================================================================
+std::optional<std::set<std::string>> PrecompiledHeaders::leadingIncludes(const std::string& sourceCode)
+{
+    std::set<std::string> includes;
+    std::istringstream iss(stripComments(sourceCode));
+    std::string line;
+
+    auto skipSpaces = [&line](std::size_t pos) {
+        while (pos < line.size() && std::isspace(static_cast<unsigned char>(line[pos]))) {
+            ++pos;
+        }
+        return pos;
+    };
+
+    while (std::getline(iss, line)) {
+        std::size_t pos = skipSpaces(0);
+        if (pos >= line.size()) {
+            continue;
+        }
+        if (line[pos] != '#') {
+            break; // empieza el código
+        }
+        std::size_t last = line.find_last_not_of(" \t\r");
+        if (line[last] == '\\') {
+            return std::nullopt;
+        }
+        pos = skipSpaces(pos + 1);
+        if (line.compare(pos, 7, "include") != 0) {
+            return std::nullopt;
+        }
+        pos = skipSpaces(pos + 7);
+        std::size_t end = line.find('>', pos + 1);
+        if (pos >= line.size() || line[pos] != '<' || end == std::string::npos ||
+            skipSpaces(end + 1) != line.size()) {
+            return std::nullopt; // include local o con macros
+        }
+        includes.insert(line.substr(pos + 1, end - pos - 1));
+    }
+    return includes;
+}
+
+std::optional<std::string> PrecompiledHeaders::select(const std::string& sourceCode)
+{
+    std::optional<std::set<std::string>> includes = leadingIncludes(sourceCode);
+    if (!includes) {
+        return std::nullopt;
+    }
+
+    for (const auto& pch : available()) {
+        bool covered = std::all_of(pch.headers.begin(), pch.headers.end(),
+            [&includes](const std::string& h) { return includes->count(h) > 0; });
+        if (covered) {
+            return pch.name;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> PrecompiledHeaders::selectForFile(const std::filesystem::path& sourcePath)
+{
+    std::ifstream in(sourcePath);
+    if (!in) {
+        return std::nullopt;
+    }
+    std::string code((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return select(code);
+}
+
+} // namespace engine
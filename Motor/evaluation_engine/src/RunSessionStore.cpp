@@ -0,0 +1,121 @@
+#include "RunSessionStore.h"
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <sstream>
+#include <system_error>
+
+namespace {
+
+    // Id corto y no adivinable: contador + sufijo aleatorio.
+    std::string makeSessionId() {
+        static std::atomic<std::uint64_t> counter{0};
+        static thread_local std::mt19937_64 rng{std::random_device{}()};
+        std::ostringstream oss;
+        oss << "run-" << ++counter << "-" << std::hex << (rng() & 0xffffffffULL);
+        return oss.str();
+    }
+
+} // namespace
+
+namespace engine {
+
+RunSession::~RunSession()
+{
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
+
+// ============================================================================
+// Constructor: las sesiones no sobreviven un reinicio, así que se borra lo
+// que haya quedado en root.
+// ============================================================================
+RunSessionStore::RunSessionStore(std::filesystem::path root,
+                                 std::size_t maxSessions,
+                                 std::chrono::seconds idleTtl)
+    : root_(std::move(root)),
+      maxSessions_(std::max<std::size_t>(1, maxSessions)),
+      idleTtl_(idleTtl)
+{
+    std::error_code ec;
+    std::filesystem::remove_all(root_, ec);
+    std::filesystem::create_directories(root_);
+}
+
+std::shared_ptr<RunSession> RunSessionStore::acquire(const std::string& id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto now = Clock::now();
+    purgeExpired(now);
+
+    auto it = id.empty() ? sessions_.end() : sessions_.find(id);
+    if (it != sessions_.end()) {
+        it->second.lastUsed = now;
+        lru_.erase(it->second.lruPos);
+        lru_.push_front(id);
+        it->second.lruPos = lru_.begin();
+        ++stats_.reused;
+        return it->second.session;
+    }
+
+    // Lugar para la nueva: fuera las usadas hace más tiempo
+    while (sessions_.size() >= maxSessions_ && !lru_.empty()) {
+        sessions_.erase(lru_.back());
+        lru_.pop_back();
+        ++stats_.evicted;
+    }
+
+    auto session = std::make_shared<RunSession>();
+    session->id = makeSessionId();
+    session->dir = root_ / session->id;
+    std::filesystem::create_directories(session->dir);
+
+    lru_.push_front(session->id);
+    sessions_[session->id] = Entry{session, now, lru_.begin()};
+    ++stats_.created;
+    stats_.active = sessions_.size();
+    return session;
+}
+
+bool RunSessionStore::remove(const std::string& id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sessions_.find(id);
+    if (it == sessions_.end()) {
+        return false;
+    }
+    lru_.erase(it->second.lruPos);
+    sessions_.erase(it);
+    stats_.active = sessions_.size();
+    return true;
+}
+
+// ============================================================================
+// purgeExpired
+// La lista LRU está ordenada por último uso: se recorre desde el final
+// hasta la primera sesión vigente. Se llama con mutex_ tomado.
+// ============================================================================
+void RunSessionStore::purgeExpired(Clock::time_point now)
+{
+    while (!lru_.empty()) {
+        auto it = sessions_.find(lru_.back());
+        if (it != sessions_.end() && now - it->second.lastUsed < idleTtl_) {
+            break;
+        }
+        if (it != sessions_.end()) {
+            sessions_.erase(it);
+            ++stats_.expired;
+        }
+        lru_.pop_back();
+    }
+    stats_.active = sessions_.size();
+}
+
+RunSessionStats RunSessionStore::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace engine
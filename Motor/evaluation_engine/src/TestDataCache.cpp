@@ -0,0 +1,303 @@
+#include "TestDataCache.h"
+
+#include "Hashing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+
+    // Los ids terminan en nombres de archivo: solo [A-Za-z0-9_-].
+    bool isSafeId(const std::string& id) {
+        return !id.empty() && id.size() <= 64 &&
+            std::all_of(id.begin(), id.end(), [](unsigned char c) {
+                return std::isalnum(c) || c == '_' || c == '-';
+            });
+    }
+
+    bool readFile(const std::filesystem::path& path, std::string& out) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            return false;
+        }
+        out.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    bool writeReadOnlyFile(const std::filesystem::path& path, const std::string& data) {
+        {
+            std::ofstream out(path, std::ios::binary);
+            out << data;
+            if (!out) {
+                return false;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::permissions(path,
+            std::filesystem::perms::owner_read | std::filesystem::perms::group_read |
+            std::filesystem::perms::others_read,
+            std::filesystem::perm_options::replace, ec);
+        return !ec;
+    }
+
+} // namespace
+
+namespace engine {
+
+// ============================================================================
+// Constructor: crea la carpeta y recarga los sets guardados.
+// ============================================================================
+TestDataCache::TestDataCache(std::filesystem::path cacheDir, std::uintmax_t maxBytes)
+    : cacheDir_(std::move(cacheDir)),
+      maxBytes_(maxBytes)
+{
+    std::filesystem::create_directories(cacheDir_);
+    loadIndex();
+}
+
+std::string TestDataCache::makeKey(const std::string& problemId,
+                                   const std::vector<TestCase>& testCases)
+{
+    Sha256 h;
+    h.updateField(problemId);
+    for (const auto& tc : testCases) {
+        h.updateField(tc.id).updateField(tc.input).updateField(tc.expectedOutput);
+    }
+    return h.hexDigest();
+}
+
+// ============================================================================
+// loadSet
+// Lee manifest + archivos de una carpeta del cache. nullptr si está incompleta.
+// ============================================================================
+std::shared_ptr<TestDataSet> TestDataCache::loadSet(const std::filesystem::path& dir) const
+{
+    std::ifstream manifest(dir / "manifest");
+    auto set = std::make_shared<TestDataSet>();
+    if (!manifest || !std::getline(manifest, set->problemId)) {
+        return nullptr;
+    }
+    set->key = dir.filename().string();
+    set->dir = dir;
+
+    std::string id;
+    while (std::getline(manifest, id)) {
+        TestCase tc;
+        tc.id = id;
+        if (!isSafeId(id) ||
+            !readFile(dir / ("input_" + id + ".txt"), tc.input) ||
+            !readFile(dir / ("expected_" + id + ".txt"), tc.expectedOutput)) {
+            return nullptr;
+        }
+        set->bytes += tc.input.size() + tc.expectedOutput.size();
+        set->testCases.push_back(std::move(tc));
+    }
+    return set;
+}
+
+// ============================================================================
+// loadIndex
+// Igual que CompileCache: sets completos ordenados por fecha del manifest,
+// restos de escrituras a medio terminar (.tmp-*) o dañados se borran.
+// ============================================================================
+void TestDataCache::loadIndex()
+{
+    struct Found {
+        std::shared_ptr<TestDataSet> set;
+        std::filesystem::file_time_type mtime;
+    };
+    std::vector<Found> found;
+
+    std::error_code ec;
+    for (const auto& d : std::filesystem::directory_iterator(cacheDir_, ec)) {
+        if (!d.is_directory(ec)) {
+            continue;
+        }
+        std::string name = d.path().filename().string();
+        auto set = name.rfind(".tmp-", 0) == 0 ? nullptr : loadSet(d.path());
+        if (!set) {
+            std::filesystem::remove_all(d.path(), ec);
+            continue;
+        }
+        found.push_back({std::move(set),
+                         std::filesystem::last_write_time(d.path() / "manifest", ec)});
+    }
+
+    std::sort(found.begin(), found.end(),
+              [](const Found& a, const Found& b) { return a.mtime > b.mtime; });
+
+    for (auto& f : found) {
+        std::string key = f.set->key;
+        stats_.bytes += f.set->bytes;
+        lru_.push_back(key);
+        index_[key] = Entry{std::move(f.set), std::prev(lru_.end())};
+    }
+    stats_.entries = index_.size();
+    evictIfNeeded();
+}
+
+void TestDataCache::touch(Entry& entry, const std::string& key)
+{
+    lru_.erase(entry.lruPos);
+    lru_.push_front(key);
+    entry.lruPos = lru_.begin();
+}
+
+// Se llama con mutex_ tomado. Nunca expulsa el único set (aunque exceda).
+void TestDataCache::evictIfNeeded()
+{
+    while (stats_.bytes > maxBytes_ && lru_.size() > 1) {
+        std::string victim = lru_.back();
+        lru_.pop_back();
+
+        auto it = index_.find(victim);
+        if (it != index_.end()) {
+            stats_.bytes -= std::min(stats_.bytes, it->second.set->bytes);
+            index_.erase(it);
+        }
+
+        std::error_code ec;
+        std::filesystem::remove_all(cacheDir_ / victim, ec);
+        ++stats_.evictions;
+    }
+    stats_.entries = index_.size();
+}
+
+std::shared_ptr<const TestDataSet> TestDataCache::find(const std::string& key)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        ++stats_.misses;
+        return nullptr;
+    }
+    touch(it->second, key);
+    ++stats_.hits;
+    return it->second.set;
+}
+
+// ============================================================================
+// put
+// Escribe en una carpeta temporal y la renombra (nunca se ve un set a
+// medias). Subir dos veces los mismos tests devuelve el set existente.
+// ============================================================================
+std::shared_ptr<const TestDataSet> TestDataCache::put(const std::string& problemId,
+                                                      std::vector<TestCase> testCases)
+{
+    if (problemId.find('\n') != std::string::npos) {
+        throw std::invalid_argument("problem_id inválido");
+    }
+    for (const auto& tc : testCases) {
+        if (!isSafeId(tc.id)) {
+            throw std::invalid_argument("id de test inválido: " + tc.id);
+        }
+    }
+
+    std::string key = makeKey(problemId, testCases);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            touch(it->second, key);
+            return it->second.set;
+        }
+    }
+
+    auto set = std::make_shared<TestDataSet>();
+    set->key = key;
+    set->problemId = problemId;
+    set->dir = cacheDir_ / key;
+
+    static std::atomic<unsigned long> counter{0};
+    std::filesystem::path tmp = cacheDir_ / (".tmp-" + key + "-" + std::to_string(counter++));
+    std::error_code ec;
+    std::filesystem::create_directories(tmp, ec);
+    if (ec) {
+        throw std::runtime_error("No se pudo crear " + tmp.string() + ": " + ec.message());
+    }
+
+    bool ok = true;
+    std::string manifest = problemId + "\n";
+    for (const auto& tc : testCases) {
+        ok = ok &&
+             writeReadOnlyFile(tmp / ("input_" + tc.id + ".txt"), tc.input) &&
+             writeReadOnlyFile(tmp / ("expected_" + tc.id + ".txt"), tc.expectedOutput);
+        manifest += tc.id + "\n";
+        set->bytes += tc.input.size() + tc.expectedOutput.size();
+    }
+    ok = ok && writeReadOnlyFile(tmp / "manifest", manifest);
+    if (!ok) {
+        std::filesystem::remove_all(tmp, ec);
+        throw std::runtime_error("No se pudieron escribir los tests en " + tmp.string());
+    }
+    set->testCases = std::move(testCases);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        std::filesystem::remove_all(tmp, ec); // otra subida idéntica ganó
+        touch(it->second, key);
+        return it->second.set;
+    }
+
+    std::filesystem::rename(tmp, set->dir, ec);
+    if (ec) {
+        std::filesystem::remove_all(tmp, ec);
+        throw std::runtime_error("No se pudo guardar el set " + key + ": " + ec.message());
+    }
+
+    lru_.push_front(key);
+    index_[key] = Entry{set, lru_.begin()};
+    stats_.bytes += set->bytes;
+    ++stats_.uploads;
+    evictIfNeeded();
+    return set;
+}
+
+// ============================================================================
+// linkInputs
+// Si el set fue expulsado mientras la submission lo usaba, los archivos ya
+// no existen: se escriben desde la copia en memoria.
+// ============================================================================
+void TestDataCache::linkInputs(const TestDataSet& set,
+                               const std::filesystem::path& submissionDir,
+                               bool hardlink)
+{
+    const auto overwrite = std::filesystem::copy_options::overwrite_existing;
+    for (const auto& tc : set.testCases) {
+        std::string name = "input_" + tc.id + ".txt";
+        std::filesystem::path src = set.dir / name;
+        std::filesystem::path dst = submissionDir / name;
+
+        std::error_code ec;
+        std::filesystem::remove(dst, ec);
+        ec.clear();
+        if (hardlink) {
+            std::filesystem::create_hard_link(src, dst, ec);
+        }
+        if (!hardlink || ec) {
+            ec.clear();
+            std::filesystem::copy_file(src, dst, overwrite, ec);
+        }
+        if (ec) {
+            std::ofstream out(dst, std::ios::binary);
+            out << tc.input;
+            if (!out) {
+                throw std::runtime_error(
+                    "No se pudo crear archivo de input: " + dst.string());
+            }
+        }
+    }
+}
+
+TestDataCacheStats TestDataCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace engine
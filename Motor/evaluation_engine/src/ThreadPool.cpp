@@ -0,0 +1,124 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace engine {
+
+// ============================================================================
+// Constructor: crea los hilos trabajadores.
+// ============================================================================
+ThreadPool::ThreadPool(std::size_t threads)
+{
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+// ============================================================================
+// Destructor: termina las tareas pendientes y une los hilos.
+// ============================================================================
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& w : workers_) {
+        w.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push(std::move(task));
+    }
+    cv_.notify_one();
+}
+
+void ThreadPool::workerLoop()
+{
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+            if (stopping_ && tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+
+        try {
+            task();
+        } catch (...) {
+            // Las tareas reportan sus errores por su cuenta (ver parallelFor)
+        }
+    }
+}
+
+// ============================================================================
+// parallelFor
+// Lanza min(parallelism, count) tareas; cada una toma el siguiente índice
+// libre de un contador atómico. Con parallelism <= 1 corre en el hilo actual.
+// ============================================================================
+void ThreadPool::parallelFor(std::size_t count,
+                             std::size_t parallelism,
+                             const std::function<void(std::size_t)>& fn)
+{
+    if (count == 0) {
+        return;
+    }
+
+    if (parallelism <= 1 || count == 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    std::size_t tasks = std::min(parallelism, count);
+
+    std::atomic<std::size_t> next{0};
+    std::mutex doneMutex;
+    std::condition_variable doneCv;
+    std::size_t finished = 0;
+    std::exception_ptr firstError;
+
+    for (std::size_t t = 0; t < tasks; ++t) {
+        submit([&]() {
+            for (std::size_t i = next++; i < count; i = next++) {
+                try {
+                    fn(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(doneMutex);
+                    if (!firstError) {
+                        firstError = std::current_exception();
+                    }
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(doneMutex);
+            ++finished;
+            doneCv.notify_one();
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(doneMutex);
+    doneCv.wait(lock, [&]() { return finished == tasks; });
+
+    if (firstError) {
+        std::rethrow_exception(firstError);
+    }
+}
+
+} // namespace engine
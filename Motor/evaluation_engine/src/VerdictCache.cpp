@@ -0,0 +1,185 @@
+#include "VerdictCache.h"
+
+#include "Hashing.h"
+#include "TestDataCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+
+namespace {
+
+    // Representación exacta de un double para la clave ("%a": sin redondeo).
+    std::string exactDouble(double value) {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%a", value);
+        return buf;
+    }
+
+    // Tamaño aproximado de un resultado en memoria (lo dominan los logs).
+    std::uintmax_t approximateBytes(const engine::EvaluationResult& result) {
+        std::uintmax_t bytes = sizeof(result) + result.submissionId.size() +
+                               result.compileLog.size();
+        for (const auto& t : result.tests) {
+            bytes += sizeof(t) + t.testId.size() + t.runtimeLog.size();
+            if (t.diff) {
+                bytes += t.diff->expected.size() + t.diff->actual.size();
+            }
+        }
+        return bytes;
+    }
+
+} // namespace
+
+namespace engine {
+
+VerdictCache::VerdictCache(std::uintmax_t maxBytes, std::chrono::seconds ttl)
+    : maxBytes_(maxBytes),
+      ttl_(ttl)
+{}
+
+// ============================================================================
+// makeKey
+// Todo lo que puede cambiar el veredicto. Los tests entran por su hash: el
+// del TestDataCache si la submission lo referencia, si no se calcula igual.
+// ============================================================================
+std::string VerdictCache::makeKey(const SubmissionRequest& request,
+                                  const std::string& toolchainId)
+{
+    const std::string testsKey = request.testData
+        ? request.testData->key
+        : TestDataCache::makeKey(request.problemId, request.testCases);
+
+    Sha256 h;
+    h.updateField(request.language)
+     .updateField(request.sourceCode)
+     .updateField(testsKey)
+     .updateField(std::to_string(request.timeLimitMs))
+     .updateField(std::to_string(request.wallTimeLimitMs))
+     .updateField(std::to_string(request.memoryLimitKb))
+     .updateField(std::to_string(static_cast<int>(request.failurePolicy)))
+     .updateField(std::to_string(static_cast<int>(request.checker.type)))
+     .updateField(exactDouble(request.checker.absEpsilon))
+     .updateField(exactDouble(request.checker.relEpsilon))
+     .updateField(request.checker.source)
+     .updateField(toolchainId);
+    return h.hexDigest();
+}
+
+// ============================================================================
+// find
+// Las entradas vencidas se descartan al encontrarlas.
+// ============================================================================
+std::optional<EvaluationResult> VerdictCache::find(const std::string& key)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        ++stats_.misses;
+        return std::nullopt;
+    }
+    if (Clock::now() >= it->second.expiresAt) {
+        erase(it);
+        ++stats_.expirations;
+        ++stats_.misses;
+        return std::nullopt;
+    }
+
+    lru_.erase(it->second.lruPos);
+    lru_.push_front(key);
+    it->second.lruPos = lru_.begin();
+    ++stats_.hits;
+
+    EvaluationResult result = it->second.result;
+    result.cached = true;
+    return result;
+}
+
+// ============================================================================
+// store
+// Un rejudge reemplaza la entrada anterior (y renueva el TTL). Un hit con
+// timing pedido solo trae el total de la respuesta desde el cache.
+// Basta un test InternalError (p. ej. un checker que falló) para no
+// guardarlo: el reenvío tiene que volver a evaluarse.
+// ============================================================================
+void VerdictCache::store(const std::string& key, const EvaluationResult& result)
+{
+    if (result.overallStatus == OverallStatus::InternalError ||
+        std::any_of(result.tests.begin(), result.tests.end(), [](const TestResult& t) {
+            return t.status == TestStatus::InternalError;
+        })) {
+        return;
+    }
+
+    Entry entry;
+    entry.result = result;
+    entry.result.cached = false;
+    // El desglose de tiempos es de esa ejecución, no del veredicto
+    entry.result.timing.reset();
+    for (auto& t : entry.result.tests) {
+        t.timing.reset();
+    }
+    entry.bytes = approximateBytes(result);
+    entry.expiresAt = Clock::now() + ttl_;
+    if (entry.bytes > maxBytes_) {
+        return; // no entraría ni con el cache vacío
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto old = index_.find(key);
+    if (old != index_.end()) {
+        erase(old);
+    }
+    lru_.push_front(key);
+    entry.lruPos = lru_.begin();
+    stats_.bytes += entry.bytes;
+    index_.emplace(key, std::move(entry));
+    ++stats_.stores;
+    evictIfNeeded();
+}
+
+void VerdictCache::countBypass()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.bypasses;
+}
+
+// Se llama con mutex_ tomado.
+void VerdictCache::erase(std::unordered_map<std::string, Entry>::iterator it)
+{
+    stats_.bytes -= std::min(stats_.bytes, it->second.bytes);
+    lru_.erase(it->second.lruPos);
+    index_.erase(it);
+    stats_.entries = index_.size();
+}
+
+// ============================================================================
+// evictIfNeeded
+// Primero las vencidas, después desde el final de la lista LRU hasta quedar
+// bajo el presupuesto. Se llama con mutex_ tomado.
+// ============================================================================
+void VerdictCache::evictIfNeeded()
+{
+    const auto now = Clock::now();
+    for (auto it = index_.begin(); stats_.bytes > maxBytes_ && it != index_.end();) {
+        auto next = std::next(it);
+        if (now >= it->second.expiresAt) {
+            erase(it);
+            ++stats_.expirations;
+        }
+        it = next;
+    }
+    while (stats_.bytes > maxBytes_ && !lru_.empty()) {
+        erase(index_.find(lru_.back()));
+        ++stats_.evictions;
+    }
+    stats_.entries = index_.size();
+}
+
+VerdictCacheStats VerdictCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace engine
@@ -0,0 +1,189 @@
+#include "WorkdirManager.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mount.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    constexpr const char* kRetainedDirName = ".retained";
+
+    // El id viene del cliente: solo [A-Za-z0-9_-] y acotado, para que nunca
+    // pueda salir de la carpeta padre.
+    std::string sanitizeId(const std::string& id) {
+        std::string out;
+        for (unsigned char c : id) {
+            if (out.size() >= 48) {
+                break;
+            }
+            out += (std::isalnum(c) || c == '_' || c == '-') ? static_cast<char>(c) : '_';
+        }
+        return out.empty() ? "sub" : out;
+    }
+
+    std::string uniqueSuffix() {
+        static std::atomic<std::uint64_t> counter{0};
+        static thread_local std::mt19937_64 rng{std::random_device{}()};
+        std::ostringstream oss;
+        oss << ++counter << "-" << std::hex << (rng() & 0xffffffULL);
+        return oss.str();
+    }
+
+#ifdef __linux__
+    constexpr long kTmpfsMagic = 0x01021994;
+
+    bool isTmpfs(const std::filesystem::path& dir) {
+        struct statfs st{};
+        return statfs(dir.c_str(), &st) == 0 && static_cast<long>(st.f_type) == kTmpfsMagic;
+    }
+#endif
+
+} // namespace
+
+namespace engine {
+
+// ============================================================================
+// Constructor: prepara la raíz (tmpfs opcional) y limpia restos anteriores.
+// ============================================================================
+WorkdirManager::WorkdirManager(std::filesystem::path root, WorkdirConfig config)
+    : root_(std::filesystem::absolute(std::move(root))),
+      retainedDir_(root_ / kRetainedDirName),
+      config_(config)
+{
+    std::filesystem::create_directories(root_);
+    mountTmpfsIfRequested();
+    sweepOrphans();
+    std::filesystem::create_directories(retainedDir_);
+}
+
+// ============================================================================
+// mountTmpfsIfRequested
+// Si la raíz ya es un tmpfs (montado desde fuera) se usa tal cual.
+// ============================================================================
+void WorkdirManager::mountTmpfsIfRequested()
+{
+#ifdef __linux__
+    onTmpfs_ = isTmpfs(root_);
+    if (onTmpfs_ || config_.tmpfsSizeMb == 0) {
+        return;
+    }
+    if (geteuid() != 0) {
+        std::cerr << "No se puede montar el tmpfs en " << root_
+                  << " sin root; las submissions usarán el disco\n";
+        return;
+    }
+
+    std::string options = "size=" + std::to_string(config_.tmpfsSizeMb) + "m,mode=0755";
+    if (mount("codecoach-work", root_.c_str(), "tmpfs",
+              MS_NOSUID | MS_NODEV, options.c_str()) != 0) {
+        std::cerr << "No se pudo montar el tmpfs en " << root_ << "\n";
+        return;
+    }
+    onTmpfs_ = true;
+#endif
+}
+
+// ============================================================================
+// sweepOrphans
+// Al arrancar ninguna submission está en curso: todo lo que haya en la raíz
+// es de una ejecución anterior. Solo se respetan las carpetas conservadas
+// que siguen dentro de la ventana de retención.
+// ============================================================================
+void WorkdirManager::sweepOrphans()
+{
+    std::error_code ec;
+    for (const auto& d : std::filesystem::directory_iterator(root_, ec)) {
+        if (d.path().filename() == kRetainedDirName) {
+            continue;
+        }
+        std::filesystem::remove_all(d.path(), ec);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    purgeRetained();
+}
+
+std::filesystem::path WorkdirManager::create(const std::filesystem::path& parent,
+                                             const std::string& submissionId)
+{
+    std::filesystem::path dir = parent / (sanitizeId(submissionId) + "-" + uniqueSuffix());
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        throw std::runtime_error(
+            "No se pudo crear el directorio de la submission: " +
+            dir.string() + " - " + ec.message());
+    }
+    return dir;
+}
+
+// ============================================================================
+// release
+// Conservar es un rename dentro de la misma raíz (no copia nada). Si falla,
+// la carpeta se borra igual: nunca se deja basura fuera de .retained.
+// ============================================================================
+void WorkdirManager::release(const std::filesystem::path& dir, bool failed)
+{
+    std::error_code ec;
+    bool keep = config_.retentionSeconds > 0 && (failed || !config_.retainOnlyFailures);
+    if (keep) {
+        std::filesystem::path target = retainedDir_ / dir.filename();
+        std::filesystem::rename(dir, target, ec);
+        if (!ec) {
+            // La fecha de la carpeta marca el inicio de la retención
+            std::filesystem::last_write_time(target, std::filesystem::file_time_type::clock::now(), ec);
+            std::lock_guard<std::mutex> lock(mutex_);
+            purgeRetained();
+            return;
+        }
+    }
+    std::filesystem::remove_all(dir, ec);
+}
+
+// ============================================================================
+// purgeRetained
+// Borra las conservadas más viejas que retentionSeconds y, si aun así hay
+// más de maxRetained, las más antiguas.
+// ============================================================================
+void WorkdirManager::purgeRetained()
+{
+    struct Found {
+        std::filesystem::path path;
+        std::filesystem::file_time_type mtime;
+    };
+    std::vector<Found> found;
+
+    std::error_code ec;
+    auto now = std::filesystem::file_time_type::clock::now();
+    auto retention = std::chrono::seconds(std::max(0, config_.retentionSeconds));
+    for (const auto& d : std::filesystem::directory_iterator(retainedDir_, ec)) {
+        auto mtime = std::filesystem::last_write_time(d.path(), ec);
+        if (ec || now - mtime > retention) {
+            std::filesystem::remove_all(d.path(), ec);
+            continue;
+        }
+        found.push_back({d.path(), mtime});
+    }
+
+    if (found.size() > config_.maxRetained) {
+        std::sort(found.begin(), found.end(),
+                  [](const Found& a, const Found& b) { return a.mtime < b.mtime; });
+        for (std::size_t i = 0; i < found.size() - config_.maxRetained; ++i) {
+            std::filesystem::remove_all(found[i].path, ec);
+        }
+    }
+}
+
+} // namespace engine
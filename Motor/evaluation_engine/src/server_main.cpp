@@ -1,111 +1,787 @@
+#include "EngineMetrics.h"
 #include "EvaluationService.h"
+#include "JobQueue.h"
+#include "JsonCodec.h"
 #include "Models.h"
+#include "RunSessionStore.h"
+#include "TestDataCache.h"
+#include "VerdictCache.h"
+#include "WorkdirManager.h"
 
 #include <crow.h>
 #include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <filesystem>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 
 using json = nlohmann::json;
 using namespace engine;
 
+// Lee una variable de entorno entera; si no existe o es inválida usa el default.
+static int envInt(const char* name, int defaultValue) {
+    const char* value = std::getenv(name);
+    if (!value || !*value) {
+        return defaultValue;
+    }
+    try {
+        return std::stoi(value);
+    } catch (...) {
+        return defaultValue;
+    }
+}
+
+// Nombre del estado de un job en la API ("queued" | "running" | "done").
+static const char* toString(JobState state) {
+    switch (state) {
+        case JobState::Queued:  return "queued";
+        case JobState::Running: return "running";
+        case JobState::Done:    break;
+    }
+    return "done";
+}
+
+// ============================================================================
+// Formato de los bodies
+// application/json (por defecto) o application/msgpack: el mismo documento
+// en MessagePack, donde los strings (inputs, expected, código) viajan con
+// prefijo de longitud y sin escapar. El request se decodifica según su
+// Content-Type y la respuesta sale en MessagePack si Accept lo pide.
+// ============================================================================
+static bool isMsgpack(const std::string& mediaType) {
+    return mediaType.find("application/msgpack") != std::string::npos ||
+           mediaType.find("application/x-msgpack") != std::string::npos;
+}
+
+// Lanza nlohmann::json::exception si el body no es válido.
+static json parseBody(const crow::request& req) {
+    if (isMsgpack(req.get_header_value("Content-Type"))) {
+        return json::from_msgpack(req.body);
+    }
+    return json::parse(req.body);
+}
+
+static crow::response encodedResponse(const crow::request& req, int code, const json& body) {
+    if (isMsgpack(req.get_header_value("Accept"))) {
+        std::string bytes;
+        json::to_msgpack(body, bytes);
+        crow::response res(code, std::move(bytes));
+        res.set_header("Content-Type", "application/msgpack");
+        return res;
+    }
+    crow::response res(code, body.dump());
+    res.set_header("Content-Type", "application/json");
+    return res;
+}
+
+// Resuelve SubmissionRequest::testDataKey contra el cache de tests.
+// false = el motor no tiene ese set (el Gestor debe subirlo y reintentar).
+static bool resolveTestData(SubmissionRequest& sr, TestDataCache* cache) {
+    if (sr.testDataKey.empty()) {
+        return true;
+    }
+    sr.testData = cache ? cache->find(sr.testDataKey) : nullptr;
+    return sr.testData && sr.testData->problemId == sr.problemId;
+}
+
+// 409 con la clave desconocida, en JSON para que el Gestor lo reconozca.
+static crow::response unknownTestDataResponse(const std::string& key) {
+    json body;
+    body["error"] = "unknown_test_data";
+    body["test_data_key"] = key;
+    crow::response res(409, body.dump());
+    res.set_header("Content-Type", "application/json");
+    return res;
+}
+
 // ============================================================================
 // Servidor REST del motor de evaluación
 //
-// Expone POST /evaluate
-// y delega tod0 el procesamiento en EvaluationService
+// Expone POST /evaluate (síncrono), POST /jobs + GET /jobs/<id> (asíncrono)
+// y GET /jobs/<id>/events (veredictos a medida que se conocen)
+// y delega tod0 el procesamiento en EvaluationService a través de JobQueue
 // ============================================================================
 int main() {
     crow::SimpleApp app;
 
-    // Carpeta donde se crearán las submissions
+    // Puerto y carpeta de trabajo. Varios motores en la misma máquina (el
+    // Gestor los reparte con CODECOACH_ENGINES) necesitan puertos y
+    // carpetas distintas: fuera del puerto por defecto, la carpeta lleva
+    // el puerto en el nombre.
+    //   CODECOACH_PORT      puerto HTTP del motor
+    //   CODECOACH_WORKDIR   carpeta donde se crearán las submissions
+    const int port = envInt("CODECOACH_PORT", 8090);
     std::filesystem::path baseDir =
-        std::filesystem::current_path() / "eval_workdir";
+        std::filesystem::current_path() /
+        (port == 8090 ? std::string("eval_workdir") : "eval_workdir_" + std::to_string(port));
+    if (const char* workdirEnv = std::getenv("CODECOACH_WORKDIR"); workdirEnv && *workdirEnv) {
+        baseDir = workdirEnv;
+    }
 
     // Servicio principal del motor
     EvaluationService service(baseDir, "codecoach-cpp:latest");
 
+    // Carpetas de trabajo de las submissions (baseDir/submissions)
+    //   CODECOACH_WORKDIR_TMPFS_MB       montar un tmpfs de ese tamaño (requiere root)
+    //   CODECOACH_WORKDIR_RETENTION_S    conservar las fallidas N segundos (0 = borrar)
+    //   CODECOACH_WORKDIR_MAX_RETAINED   carpetas conservadas como máximo
+    //   CODECOACH_WORKDIR_RETAIN_ALL     1 = conservar también las Accepted
+    WorkdirConfig workdirConfig;
+    workdirConfig.tmpfsSizeMb = static_cast<std::uintmax_t>(
+        std::max(0, envInt("CODECOACH_WORKDIR_TMPFS_MB", 0)));
+    workdirConfig.retentionSeconds = std::max(0, envInt("CODECOACH_WORKDIR_RETENTION_S", 0));
+    workdirConfig.maxRetained = static_cast<std::size_t>(
+        std::max(0, envInt("CODECOACH_WORKDIR_MAX_RETAINED", 100)));
+    workdirConfig.retainOnlyFailures = envInt("CODECOACH_WORKDIR_RETAIN_ALL", 0) == 0;
+    auto workdirs = std::make_shared<WorkdirManager>(baseDir / "submissions", workdirConfig);
+    service.setWorkdirManager(workdirs);
+    if (workdirs->onTmpfs()) {
+        std::cout << "Carpetas de trabajo en tmpfs: " << workdirs->root() << "\n";
+    }
+
+    // Backend de sandbox: CODECOACH_BACKEND=docker (default) | native
+    const char* backendEnv = std::getenv("CODECOACH_BACKEND");
+    if (backendEnv && std::string(backendEnv) == "native") {
+        std::string reason;
+        if (!NativeSandboxRunner::isSupported(NativeSandboxConfig{}, &reason)) {
+            std::cerr << "El sandbox nativo no está disponible en este sistema: "
+                      << reason << "\n";
+            return 1;
+        }
+        service.setBackend(SandboxBackend::Native);
+        std::cout << "Backend de sandbox: nativo (namespaces + cgroup v2 + seccomp)\n";
+    }
+
+    // Modo batch por defecto (CODECOACH_BATCH=1): todos los tests en una
+    // sola invocación del contenedor mediante judge-driver.
+    service.setBatchMode(envInt("CODECOACH_BATCH", 0) != 0);
+
+    // I/O en memoria por defecto (CODECOACH_INMEMORY_IO=1): input por pipe y
+    // salida comparada en memoria, sin archivos de test en disco.
+    service.setInMemoryIo(envInt("CODECOACH_INMEMORY_IO", 0) != 0);
+
+    // Tests en paralelo: pool de hilos del tamaño de los núcleos disponibles
+    //   CODECOACH_TEST_THREADS   hilos del pool (0 = núcleos)
+    //   CODECOACH_PARALLELISM    tests simultáneos por submission (default;
+    //                            con pool, acotado a lo que entra en un contenedor)
+    auto testPool = std::make_shared<ThreadPool>(
+        static_cast<std::size_t>(std::max(0, envInt("CODECOACH_TEST_THREADS", 0))));
+    service.setTestParallelism(
+        testPool, envInt("CODECOACH_PARALLELISM", static_cast<int>(testPool->size())));
+
+    // Pool de contenedores calientes (CODECOACH_POOL_SIZE=0 lo desactiva)
+    //   CODECOACH_POOL_SIZE          contenedores pre-iniciados
+    //   CODECOACH_POOL_MEMORY_MB     memoria por contenedor
+    //   CODECOACH_POOL_PIDS          límite de procesos por contenedor
+    //   CODECOACH_POOL_MAX_LEASES    usos antes de reciclar (0 = nunca)
+    //   CODECOACH_POOL_RECYCLE_TLE   1 = reciclar tras un TLE
+    std::shared_ptr<ContainerPool> pool;
+    int poolSize = envInt("CODECOACH_POOL_SIZE", 0);
+    if (poolSize > 0 && !(backendEnv && std::string(backendEnv) == "native")) {
+        ContainerPoolConfig poolConfig;
+        poolConfig.size = static_cast<std::size_t>(poolSize);
+        poolConfig.memoryLimitMb = envInt("CODECOACH_POOL_MEMORY_MB", poolConfig.memoryLimitMb);
+        poolConfig.pidsLimit = envInt("CODECOACH_POOL_PIDS", poolConfig.pidsLimit);
+        poolConfig.maxLeasesPerContainer =
+            envInt("CODECOACH_POOL_MAX_LEASES", poolConfig.maxLeasesPerContainer);
+        poolConfig.recycleOnTimeout = envInt("CODECOACH_POOL_RECYCLE_TLE", 1) != 0;
+
+        // Dentro de la raíz de trabajo: misma RAM/tmpfs y release() puede
+        // conservar una carpeta con un rename
+        pool = std::make_shared<ContainerPool>(
+            "codecoach-cpp:latest", workdirs->root() / "pool", poolConfig);
+        pool->start();
+        service.setContainerPool(pool);
+
+        std::cout << "Pool de contenedores listo (" << poolSize << " contenedores)\n";
+    }
+
+    // Cache de compilación compartido entre submissions
+    //   CODECOACH_COMPILE_CACHE_MB   tamaño máximo en disco (0 = desactivado)
+    std::shared_ptr<CompileCache> compileCache;
+    int compileCacheMb = envInt("CODECOACH_COMPILE_CACHE_MB", 512);
+    if (compileCacheMb > 0) {
+        compileCache = std::make_shared<CompileCache>(
+            baseDir / "compile_cache",
+            static_cast<std::uintmax_t>(compileCacheMb) * 1024 * 1024);
+        service.setCompileCache(compileCache);
+    }
+
+    // Cache de tests por problema (el Gestor sube cada set una vez y después
+    // solo manda test_data_key)
+    //   CODECOACH_TESTDATA_CACHE_MB  tamaño máximo (0 = desactivado)
+    std::shared_ptr<TestDataCache> testDataCache;
+    int testDataCacheMb = envInt("CODECOACH_TESTDATA_CACHE_MB", 256);
+    if (testDataCacheMb > 0) {
+        testDataCache = std::make_shared<TestDataCache>(
+            baseDir / "testdata",
+            static_cast<std::uintmax_t>(testDataCacheMb) * 1024 * 1024);
+    }
+
+    // Cache de veredictos: la misma submission (fuente, tests, límites)
+    // devuelve el resultado guardado; "rejudge": true lo evita
+    //   CODECOACH_VERDICT_CACHE_MB     tamaño máximo en memoria (0 = desactivado)
+    //   CODECOACH_VERDICT_CACHE_TTL_S  vigencia de cada veredicto
+    std::shared_ptr<VerdictCache> verdictCache;
+    int verdictCacheMb = envInt("CODECOACH_VERDICT_CACHE_MB", 64);
+    if (verdictCacheMb > 0) {
+        verdictCache = std::make_shared<VerdictCache>(
+            static_cast<std::uintmax_t>(verdictCacheMb) * 1024 * 1024,
+            std::chrono::seconds(std::max(1, envInt("CODECOACH_VERDICT_CACHE_TTL_S", 600))));
+        service.setVerdictCache(verdictCache);
+    }
+
+    // Sesiones de POST /run: el binario compilado se reutiliza entre
+    // ejecuciones con distinto stdin mientras la fuente no cambie
+    //   CODECOACH_RUN_SESSIONS         sesiones vivas como máximo (0 = /run desactivado)
+    //   CODECOACH_RUN_SESSION_TTL_S    inactividad antes de descartar una sesión
+    std::shared_ptr<RunSessionStore> runSessions;
+    int runSessionsMax = envInt("CODECOACH_RUN_SESSIONS", 256);
+    if (runSessionsMax > 0) {
+        runSessions = std::make_shared<RunSessionStore>(
+            workdirs->root() / "run_sessions",
+            static_cast<std::size_t>(runSessionsMax),
+            std::chrono::seconds(std::max(1, envInt("CODECOACH_RUN_SESSION_TTL_S", 900))));
+        service.setRunSessions(runSessions);
+    }
+
+    // Métricas para GET /metrics (contadores atómicos, siempre activas)
+    auto metrics = std::make_shared<EngineMetrics>();
+    service.setMetrics(metrics);
+
+    // Cola de evaluaciones: los hilos de Crow solo encolan y consultan
+    //   CODECOACH_JOB_WORKERS            evaluaciones simultáneas
+    //   CODECOACH_JOB_QUEUE              jobs en espera como máximo (más → 503)
+    //   CODECOACH_JOB_QUEUE_PER_CLIENT   jobs en espera de un cliente por carril (0 = sin tope)
+    //   CODECOACH_LANE_WEIGHT_INTERACTIVE / _GRADED / _REJUDGE
+    //                                    reparto de workers entre carriles
+    JobQueueConfig queueConfig;
+    queueConfig.workers = static_cast<std::size_t>(
+        std::max(1, envInt("CODECOACH_JOB_WORKERS", static_cast<int>(queueConfig.workers))));
+    queueConfig.capacity = static_cast<std::size_t>(
+        std::max(1, envInt("CODECOACH_JOB_QUEUE", static_cast<int>(queueConfig.capacity))));
+    queueConfig.maxQueuedPerClient = static_cast<std::size_t>(std::max(0,
+        envInt("CODECOACH_JOB_QUEUE_PER_CLIENT", static_cast<int>(queueConfig.maxQueuedPerClient))));
+    const char* laneWeightVars[kLaneCount] = {
+        "CODECOACH_LANE_WEIGHT_INTERACTIVE",
+        "CODECOACH_LANE_WEIGHT_GRADED",
+        "CODECOACH_LANE_WEIGHT_REJUDGE",
+    };
+    for (std::size_t i = 0; i < kLaneCount; ++i) {
+        queueConfig.laneWeights[i] = static_cast<unsigned>(std::max(1,
+            envInt(laneWeightVars[i], static_cast<int>(queueConfig.laneWeights[i]))));
+    }
+    JobQueue jobQueue(
+        [&service](const SubmissionRequest& sr, EvaluationObserver* observer) {
+            return service.evaluate(sr, observer);
+        },
+        queueConfig);
+
     // ------------------------------------------------------------------------
-    // POST /evaluate
+    // GET /health
     //
-    // Recibe:
-    // {
-    //   "submission_id": "...",
-    //   "problem_id": "...",
-    //   "language": "cpp",
-    //   "source_code": "...",
-    //   "time_limit_ms": 2000,
-    //   "test_cases": [...]
-    // }
+    // Health check del EngineRouter del Gestor: 200 mientras el motor
+    // atiende, con la carga actual para diagnóstico.
+    // ------------------------------------------------------------------------
+    CROW_ROUTE(app, "/health")
+    ([&jobQueue]() {
+        JobQueueStats st = jobQueue.stats();
+        json body;
+        body["status"]   = "OK";
+        body["depth"]    = st.depth;
+        body["running"]  = st.running;
+        body["workers"]  = st.workers;
+        body["capacity"] = st.capacity;
+
+        crow::response res(200, body.dump());
+        res.set_header("Content-Type", "application/json");
+        return res;
+    });
+
+    // ------------------------------------------------------------------------
+    // POST /evaluate
     //
-    // Y devuelve el JSON con los resultados detallados.
+    // Recibe el JSON de la submission (formato en JsonCodec::parseSubmission;
+    // también en MessagePack, ver parseBody) y devuelve el JSON con los
+    // resultados detallados. La evaluación pasa
+    // por la cola de jobs; si la cola está llena responde 503. Si el request
+    // trae un test_data_key que el motor no tiene, responde 409.
     // ------------------------------------------------------------------------
     CROW_ROUTE(app, "/evaluate").methods(crow::HTTPMethod::Post)
-    ([&service](const crow::request& req){
+    ([&jobQueue, &testDataCache](const crow::request& req){
+        try {
+            json body = parseBody(req);
+            SubmissionRequest sr = JsonCodec::parseSubmission(body);
+            if (!resolveTestData(sr, testDataCache.get())) {
+                return unknownTestDataResponse(sr.testDataKey);
+            }
+
+            std::optional<EvaluationResult> er = jobQueue.evaluate(std::move(sr));
+            if (!er) {
+                crow::response res(503, "La cola de evaluaciones está llena");
+                res.set_header("Retry-After", "1");
+                return res;
+            }
+
+            return encodedResponse(req, 200, JsonCodec::toJson(*er));
+
+        } catch (const std::exception& ex) {
+            return crow::response(500, std::string("Error: ") + ex.what());
+        }
+    });
+
+    // ------------------------------------------------------------------------
+    // POST /run
+    //
+    // Ejecuta el código con un stdin, sin juez (formato en
+    // JsonCodec::parseRun). La primera llamada compila y devuelve un
+    // session_id; las siguientes con ese id y la misma fuente reutilizan el
+    // binario. Pasa por la cola en el carril interactivo (503 si está llena).
+    // ------------------------------------------------------------------------
+    CROW_ROUTE(app, "/run").methods(crow::HTTPMethod::Post)
+    ([&service, &jobQueue](const crow::request& req){
+        RunRequest rr;
         try {
-            json body = json::parse(req.body);
-
-            // Parsear SubmissionRequest
-            SubmissionRequest sr;
-            sr.submissionId = body.at("submission_id").get<std::string>();
-            sr.problemId    = body.at("problem_id").get<std::string>();
-            sr.language     = body.at("language").get<std::string>();
-            sr.sourceCode   = body.at("source_code").get<std::string>();
-            sr.timeLimitMs  = body.value("time_limit_ms", 2000);
-
-            // test_cases (lista)
-            for (auto& tc : body.at("test_cases")) {
-                TestCase t;
-                t.id = tc.at("id").get<std::string>();
-                t.input = tc.at("input").get<std::string>();
-                t.expectedOutput = tc.at("expected_output").get<std::string>();
-                sr.testCases.push_back(t);
+            rr = JsonCodec::parseRun(parseBody(req));
+        } catch (const std::exception& ex) {
+            return crow::response(400, std::string("Error: ") + ex.what());
+        }
+
+        try {
+            RunOutcome outcome;
+            if (!jobQueue.execute(Lane::Interactive, rr.clientKey,
+                                  [&]() { outcome = service.run(rr); })) {
+                crow::response res(503, "La cola de evaluaciones está llena");
+                res.set_header("Retry-After", "1");
+                return res;
+            }
+            return encodedResponse(req, 200, JsonCodec::toJson(outcome));
+        } catch (const std::exception& ex) {
+            return crow::response(503, std::string("Error: ") + ex.what());
+        }
+    });
+
+    // ------------------------------------------------------------------------
+    // DELETE /run/<session_id>
+    //
+    // Descarta la sesión y su binario antes de que venza.
+    // ------------------------------------------------------------------------
+    CROW_ROUTE(app, "/run/<string>").methods(crow::HTTPMethod::Delete)
+    ([&service](const std::string& sessionId){
+        if (!service.endRunSession(sessionId)) {
+            return crow::response(404, "Sesión desconocida o vencida");
+        }
+        return crow::response(204);
+    });
+
+    // ------------------------------------------------------------------------
+    // POST /jobs
+    //
+    // Mismo body que /evaluate, pero responde de inmediato:
+    //   202 {"job_id": "...", "status": "queued", "queue_position": N}
+    //   503 si la cola está llena
+    //   409 si test_data_key no está en el cache
+    // El progreso se sigue con GET /jobs/<id>/events.
+    // ------------------------------------------------------------------------
+    CROW_ROUTE(app, "/jobs").methods(crow::HTTPMethod::Post)
+    ([&jobQueue, &testDataCache](const crow::request& req){
+        SubmissionRequest sr;
+        try {
+            sr = JsonCodec::parseSubmission(parseBody(req));
+        } catch (const std::exception& ex) {
+            return crow::response(400, std::string("Error: ") + ex.what());
+        }
+        if (!resolveTestData(sr, testDataCache.get())) {
+            return unknownTestDataResponse(sr.testDataKey);
+        }
+
+        std::optional<std::string> id = jobQueue.submit(std::move(sr));
+        if (!id) {
+            crow::response res(503, "La cola de evaluaciones está llena");
+            res.set_header("Retry-After", "1");
+            return res;
+        }
+
+        json body;
+        body["job_id"] = *id;
+        body["status"] = "queued";
+        if (auto snap = jobQueue.status(*id)) {
+            body["status"] = toString(snap->state);
+            body["queue_position"] = snap->queuePosition;
+        }
+
+        crow::response res(202, body.dump());
+        res.set_header("Content-Type", "application/json");
+        res.set_header("Location", "/jobs/" + *id);
+        return res;
+    });
+
+    // ------------------------------------------------------------------------
+    // GET /jobs/<id>[?wait_ms=N]
+    //
+    // Estado del job: "queued" (con queue_position), "running" o "done" (con
+    // el resultado completo en "result"). Con wait_ms espera hasta N ms
+    // (máximo 30 s) a que termine antes de responder (long-polling).
+    // ------------------------------------------------------------------------
+    CROW_ROUTE(app, "/jobs/<string>")
+    ([&jobQueue](const crow::request& req, const std::string& id){
+        int waitMs = 0;
+        if (const char* w = req.url_params.get("wait_ms")) {
+            try {
+                waitMs = std::clamp(std::stoi(w), 0, 30000);
+            } catch (...) {
+                return crow::response(400, "wait_ms inválido");
             }
+        }
 
-            // Ejecutar evaluación
-            EvaluationResult er = service.evaluate(sr);
-
-            // Convertir a JSON
-            json result;
-            result["submission_id"] = er.submissionId;
-            result["overall_status"] =
-                (er.overallStatus == OverallStatus::Accepted) ? "Accepted" :
-                (er.overallStatus == OverallStatus::CompilationError) ? "CompilationError" :
-                (er.overallStatus == OverallStatus::PartialAccepted) ? "PartialAccepted" :
-                "InternalError";
-
-            result["compile_log"]  = er.compileLog;
-            result["max_time_ms"]  = er.maxTimeMs;
-            result["max_memory_kb"] = er.maxMemoryKb;
-
-            json testArray = json::array();
-
-            for (auto& t : er.tests){
-                json jt;
-                jt["id"] = t.testId;
-                jt["time_ms"] = t.timeMs;
-                jt["memory_kb"] = t.memoryKb;
-
-                jt["status"] =
-                    (t.status == TestStatus::Accepted) ? "Accepted" :
-                    (t.status == TestStatus::WrongAnswer) ? "WrongAnswer" :
-                    (t.status == TestStatus::RuntimeError) ? "RuntimeError" :
-                    (t.status == TestStatus::TimeLimitExceeded) ? "TimeLimitExceeded" :
-                    "InternalError";
-
-                jt["runtime_log"] = t.runtimeLog;
-                testArray.push_back(jt);
+        std::optional<JobSnapshot> snap = jobQueue.waitFor(id, waitMs);
+        if (!snap) {
+            return crow::response(404, "Job desconocido o expirado");
+        }
+
+        json body;
+        body["job_id"]    = snap->id;
+        body["status"]    = toString(snap->state);
+        body["lane"]      = JsonCodec::toString(snap->lane);
+        body["queued_ms"] = snap->queuedMs;
+        body["run_ms"]    = snap->runMs;
+        if (snap->state == JobState::Queued) {
+            body["queue_position"] = snap->queuePosition;
+        }
+        if (snap->result) {
+            body["result"] = JsonCodec::toJson(*snap->result);
+        }
+
+        return encodedResponse(req, 200, body);
+    });
+
+    // ------------------------------------------------------------------------
+    // GET /jobs/<id>/events[?cursor=N&wait_ms=M]
+    //
+    // Progreso del job en NDJSON (application/x-ndjson), una línea por evento:
+    // "compile", luego un "test" por cada veredicto en cuanto se conoce y al
+    // final "summary". Devuelve los eventos desde `cursor`; si no hay ninguno
+    // nuevo espera hasta wait_ms (máximo 30 s). Cabeceras:
+    //   X-Next-Cursor   cursor para la siguiente consulta
+    //   X-Job-Done      "1" cuando ya se emitió el resumen
+    // ------------------------------------------------------------------------
+    CROW_ROUTE(app, "/jobs/<string>/events")
+    ([&jobQueue](const crow::request& req, const std::string& id){
+        std::size_t cursor = 0;
+        int waitMs = 0;
+        try {
+            if (const char* c = req.url_params.get("cursor")) {
+                cursor = static_cast<std::size_t>(std::stoul(c));
             }
+            if (const char* w = req.url_params.get("wait_ms")) {
+                waitMs = std::clamp(std::stoi(w), 0, 30000);
+            }
+        } catch (...) {
+            return crow::response(400, "cursor o wait_ms inválido");
+        }
+
+        std::optional<JobEvents> ev = jobQueue.events(id, cursor, waitMs);
+        if (!ev) {
+            return crow::response(404, "Job desconocido o expirado");
+        }
+
+        std::string body;
+        for (const auto& e : ev->events) {
+            body += JsonCodec::toJson(e).dump();
+            body += '\n';
+        }
+
+        crow::response res(200, body);
+        res.set_header("Content-Type", "application/x-ndjson");
+        res.set_header("X-Next-Cursor", std::to_string(ev->nextCursor));
+        res.set_header("X-Job-Done", ev->done ? "1" : "0");
+        return res;
+    });
+
+    // ------------------------------------------------------------------------
+    // GET /metrics
+    //
+    // Formato de texto de Prometheus: latencia por fase (compile, lease,
+    // spawn, run, compare, file_write, evaluation), evaluaciones en curso,
+    // veredictos por estado, y los contadores de la cola, el pool y los
+    // caches activos (la tasa de aciertos se calcula con hits / (hits + misses)).
+    // ------------------------------------------------------------------------
+    CROW_ROUTE(app, "/metrics")
+    ([&metrics, &jobQueue, &compileCache, &verdictCache, &testDataCache, &pool, &runSessions]() {
+        std::string out = metrics->render();
+
+        JobQueueStats qs = jobQueue.stats();
+        EngineMetrics::appendGauge(out, "codecoach_queue_depth",
+                                   "Jobs esperando en la cola", static_cast<double>(qs.depth));
+        EngineMetrics::appendGauge(out, "codecoach_queue_running",
+                                   "Jobs en ejecución", static_cast<double>(qs.running));
+        EngineMetrics::appendCounter(out, "codecoach_queue_rejected_total",
+                                     "Jobs rechazados por cola llena", static_cast<double>(qs.rejected));
+        EngineMetrics::appendCounter(out, "codecoach_queue_wait_seconds_total",
+                                     "Suma de esperas en la cola",
+                                     static_cast<double>(qs.totalWaitMs) / 1000.0);
+
+        std::vector<std::pair<std::string, double>> laneDepth, laneStarted, laneWait, laneRejected;
+        for (std::size_t i = 0; i < kLaneCount; ++i) {
+            const LaneStats& ls = qs.lanes[i];
+            std::string label = std::string("lane=\"") + JsonCodec::toString(static_cast<Lane>(i)) + "\"";
+            laneDepth.emplace_back(label, static_cast<double>(ls.depth));
+            laneStarted.emplace_back(label, static_cast<double>(ls.started));
+            laneWait.emplace_back(label, static_cast<double>(ls.totalWaitMs) / 1000.0);
+            laneRejected.emplace_back(label, static_cast<double>(ls.rejected));
+        }
+        EngineMetrics::appendFamily(out, "codecoach_lane_depth", "gauge",
+                                    "Jobs esperando por carril", laneDepth);
+        EngineMetrics::appendFamily(out, "codecoach_lane_started_total", "counter",
+                                    "Jobs iniciados por carril", laneStarted);
+        EngineMetrics::appendFamily(out, "codecoach_lane_wait_seconds_total", "counter",
+                                    "Suma de esperas en la cola por carril", laneWait);
+        EngineMetrics::appendFamily(out, "codecoach_lane_rejected_total", "counter",
+                                    "Jobs rechazados por carril (cola llena o tope del cliente)",
+                                    laneRejected);
+
+        if (compileCache) {
+            CompileCacheStats st = compileCache->stats();
+            EngineMetrics::appendCounter(out, "codecoach_compile_cache_hits_total",
+                                         "Aciertos del cache de compilación", static_cast<double>(st.hits));
+            EngineMetrics::appendCounter(out, "codecoach_compile_cache_misses_total",
+                                         "Fallos del cache de compilación", static_cast<double>(st.misses));
+            EngineMetrics::appendGauge(out, "codecoach_compile_cache_bytes",
+                                       "Tamaño del cache de compilación", static_cast<double>(st.bytes));
+        }
+        if (verdictCache) {
+            VerdictCacheStats st = verdictCache->stats();
+            EngineMetrics::appendCounter(out, "codecoach_verdict_cache_hits_total",
+                                         "Aciertos del cache de veredictos", static_cast<double>(st.hits));
+            EngineMetrics::appendCounter(out, "codecoach_verdict_cache_misses_total",
+                                         "Fallos del cache de veredictos", static_cast<double>(st.misses));
+            EngineMetrics::appendGauge(out, "codecoach_verdict_cache_entries",
+                                       "Veredictos guardados", static_cast<double>(st.entries));
+        }
+        if (testDataCache) {
+            TestDataCacheStats st = testDataCache->stats();
+            EngineMetrics::appendCounter(out, "codecoach_testdata_cache_hits_total",
+                                         "Aciertos del cache de tests", static_cast<double>(st.hits));
+            EngineMetrics::appendCounter(out, "codecoach_testdata_cache_misses_total",
+                                         "Fallos del cache de tests", static_cast<double>(st.misses));
+        }
+        if (pool) {
+            ContainerPoolStats st = pool->stats();
+            EngineMetrics::appendGauge(out, "codecoach_pool_idle",
+                                       "Contenedores libres", static_cast<double>(st.idle));
+            EngineMetrics::appendGauge(out, "codecoach_pool_busy",
+                                       "Contenedores prestados", static_cast<double>(st.busy));
+            EngineMetrics::appendGauge(out, "codecoach_pool_broken",
+                                       "Slots sin contenedor (no se pudo recrear)",
+                                       static_cast<double>(st.broken));
+        }
+        if (runSessions) {
+            RunSessionStats st = runSessions->stats();
+            EngineMetrics::appendGauge(out, "codecoach_run_sessions_active",
+                                       "Sesiones de /run vivas", static_cast<double>(st.active));
+            EngineMetrics::appendCounter(out, "codecoach_run_sessions_reused_total",
+                                         "Llamadas a /run que reutilizaron una sesión",
+                                         static_cast<double>(st.reused));
+        }
+
+        crow::response res(200, out);
+        res.set_header("Content-Type", "text/plain; version=0.0.4");
+        return res;
+    });
+
+    // ------------------------------------------------------------------------
+    // GET /queue/stats
+    //
+    // Profundidad de la cola, jobs en ejecución y tiempos de espera, en
+    // total y por carril ("lanes": {"interactive": {...}, ...}).
+    // ------------------------------------------------------------------------
+    CROW_ROUTE(app, "/queue/stats")
+    ([&jobQueue]() {
+        JobQueueStats st = jobQueue.stats();
+        std::uint64_t started = st.completed + st.running;
+        json body;
+        body["depth"]         = st.depth;
+        body["running"]       = st.running;
+        body["capacity"]      = st.capacity;
+        body["workers"]       = st.workers;
+        body["submitted"]     = st.submitted;
+        body["rejected"]      = st.rejected;
+        body["completed"]     = st.completed;
+        body["total_wait_ms"] = st.totalWaitMs;
+        body["max_wait_ms"]   = st.maxWaitMs;
+        body["avg_wait_ms"]   = started > 0 ? st.totalWaitMs / started : 0;
+        body["total_run_ms"]  = st.totalRunMs;
+        for (std::size_t i = 0; i < kLaneCount; ++i) {
+            const LaneStats& ls = st.lanes[i];
+            json lane;
+            lane["weight"]        = ls.weight;
+            lane["depth"]         = ls.depth;
+            lane["clients"]       = ls.clients;
+            lane["submitted"]     = ls.submitted;
+            lane["rejected"]      = ls.rejected;
+            lane["started"]       = ls.started;
+            lane["total_wait_ms"] = ls.totalWaitMs;
+            lane["max_wait_ms"]   = ls.maxWaitMs;
+            lane["avg_wait_ms"]   = ls.started > 0 ? ls.totalWaitMs / ls.started : 0;
+            body["lanes"][JsonCodec::toString(static_cast<Lane>(i))] = lane;
+        }
 
-            result["tests"] = testArray;
+        crow::response res(200, body.dump());
+        res.set_header("Content-Type", "application/json");
+        return res;
+    });
 
-            return crow::response(200, result.dump());
+    // ------------------------------------------------------------------------
+    // GET /pool/stats
+    //
+    // Contadores del pool de contenedores (préstamos, esperas, reciclajes)
+    // y slots rotos: sin contenedor porque no se pudo recrear.
+    // ------------------------------------------------------------------------
+    CROW_ROUTE(app, "/pool/stats")
+    ([&pool]() {
+        if (!pool) {
+            return crow::response(404, "El pool de contenedores no está activo");
+        }
 
+        ContainerPoolStats st = pool->stats();
+        json body;
+        body["size"]          = pool->config().size;
+        body["idle"]          = st.idle;
+        body["busy"]          = st.busy;
+        body["broken"]        = st.broken;
+        body["leases"]        = st.leases;
+        body["waits"]         = st.waits;
+        body["total_wait_ms"] = st.totalWaitMs;
+        body["resets"]        = st.resets;
+        body["recycles"]      = st.recycles;
+        body["repairs"]       = st.repairs;
+        body["repair_failures"] = st.repairFailures;
+
+        crow::response res(200, body.dump());
+        res.set_header("Content-Type", "application/json");
+        return res;
+    });
+
+    // ------------------------------------------------------------------------
+    // GET /cache/stats
+    //
+    // Contadores del cache de compilación (aciertos, fallos, expulsiones).
+    // ------------------------------------------------------------------------
+    CROW_ROUTE(app, "/cache/stats")
+    ([&compileCache]() {
+        if (!compileCache) {
+            return crow::response(404, "El cache de compilación no está activo");
+        }
+
+        CompileCacheStats st = compileCache->stats();
+        json body;
+        body["hits"]      = st.hits;
+        body["misses"]    = st.misses;
+        body["stores"]    = st.stores;
+        body["evictions"] = st.evictions;
+        body["entries"]   = st.entries;
+        body["bytes"]     = st.bytes;
+
+        crow::response res(200, body.dump());
+        res.set_header("Content-Type", "application/json");
+        return res;
+    });
+
+    // ------------------------------------------------------------------------
+    // GET /verdicts/stats
+    //
+    // Contadores del cache de veredictos (aciertos, vencidos, rejudges).
+    // ------------------------------------------------------------------------
+    CROW_ROUTE(app, "/verdicts/stats")
+    ([&verdictCache]() {
+        if (!verdictCache) {
+            return crow::response(404, "El cache de veredictos no está activo");
+        }
+
+        VerdictCacheStats st = verdictCache->stats();
+        json body;
+        body["hits"]        = st.hits;
+        body["misses"]      = st.misses;
+        body["stores"]      = st.stores;
+        body["evictions"]   = st.evictions;
+        body["expirations"] = st.expirations;
+        body["bypasses"]    = st.bypasses;
+        body["entries"]     = st.entries;
+        body["bytes"]       = st.bytes;
+
+        crow::response res(200, body.dump());
+        res.set_header("Content-Type", "application/json");
+        return res;
+    });
+
+    // ------------------------------------------------------------------------
+    // PUT /testdata/<problem_id>
+    //
+    // Sube los tests de un problema al cache:
+    //   {"test_cases": [{"id", "input", "expected_output"}, ...]}
+    // Devuelve {"test_data_key": "...", "tests": N, "bytes": B}. La clave
+    // depende solo del contenido: subir lo mismo otra vez no escribe nada.
+    // ------------------------------------------------------------------------
+    CROW_ROUTE(app, "/testdata/<string>").methods(crow::HTTPMethod::Put)
+    ([&testDataCache](const crow::request& req, const std::string& problemId){
+        if (!testDataCache) {
+            return crow::response(404, "El cache de tests no está activo");
+        }
+
+        std::shared_ptr<const TestDataSet> set;
+        try {
+            json body = parseBody(req);
+            set = testDataCache->put(problemId, JsonCodec::parseTestCases(body.at("test_cases")));
+        } catch (const std::invalid_argument& ex) {
+            return crow::response(400, std::string("Error: ") + ex.what());
+        } catch (const nlohmann::json::exception& ex) {
+            return crow::response(400, std::string("Error: ") + ex.what());
         } catch (const std::exception& ex) {
             return crow::response(500, std::string("Error: ") + ex.what());
         }
+
+        json body;
+        body["test_data_key"] = set->key;
+        body["problem_id"]    = set->problemId;
+        body["tests"]         = set->testCases.size();
+        body["bytes"]         = set->bytes;
+
+        crow::response res(200, body.dump());
+        res.set_header("Content-Type", "application/json");
+        return res;
+    });
+
+    // ------------------------------------------------------------------------
+    // GET /testdata/stats
+    //
+    // Contadores del cache de tests (aciertos, fallos, subidas, expulsiones).
+    // ------------------------------------------------------------------------
+    CROW_ROUTE(app, "/testdata/stats")
+    ([&testDataCache]() {
+        if (!testDataCache) {
+            return crow::response(404, "El cache de tests no está activo");
+        }
+
+        TestDataCacheStats st = testDataCache->stats();
+        json body;
+        body["hits"]      = st.hits;
+        body["misses"]    = st.misses;
+        body["uploads"]   = st.uploads;
+        body["evictions"] = st.evictions;
+        body["entries"]   = st.entries;
+        body["bytes"]     = st.bytes;
+
+        crow::response res(200, body.dump());
+        res.set_header("Content-Type", "application/json");
+        return res;
     });
 
-    std::cout << "Evaluation Engine escuchando en http://localhost:8090 ...\n";
-    app.port(8090).multithreaded().run();
+    std::cout << "Evaluation Engine escuchando en http://localhost:" << port << " ...\n";
+    app.port(static_cast<std::uint16_t>(port)).multithreaded().run();
 }
@@ -38,6 +38,12 @@ public class TestResultDto
     [JsonPropertyName("time_ms")]
     public int TimeMs { get; set; } // Tiempo por test individual
 
+    [JsonPropertyName("cpu_time_ms")]
+    public int CpuTimeMs { get; set; } // CPU user+sys del programa
+
+    [JsonPropertyName("wall_time_ms")]
+    public int WallTimeMs { get; set; } // Tiempo real del programa
+
     [JsonPropertyName("memory_kb")]
     public int MemoryKb { get; set; } // Memoria por test individual
 
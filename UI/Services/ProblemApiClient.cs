@@ -23,7 +23,9 @@ namespace UI.Services
             // Aseguramos que no haya doble slash en las rutas
             gestorBaseUrl = gestorBaseUrl.TrimEnd('/');
 
-            _httpClient = new HttpClient
+            // El Gestor identifica a cada cliente con la cookie cc_client (reparto
+            // justo en la cola del motor); el handler la guarda y la reenvía.
+            _httpClient = new HttpClient(new HttpClientHandler { UseCookies = true })
             {
                 BaseAddress = new Uri(gestorBaseUrl),
                 Timeout = TimeSpan.FromSeconds(30)